@@ -0,0 +1,106 @@
+#!/usr/bin/env python
+#
+# Generate src/WebStaticData_gz.h with gzip compressed copies of the
+# static web data in src/WebStaticData.h, served with "Content-Encoding: gzip".
+#
+# Runs before each PlatformIO build (extra_scripts in platformio.ini), it can
+# also be run by hand:
+#   python gzip_static_data.py
+#
+# The FNV-1a hash of the source is stored with each copy. The firmware only
+# serves the gzip copy when the hash matches the array it was made from.
+#
+import gzip
+import io
+import os
+import re
+import sys
+
+try:
+    # Run by PlatformIO, where __file__ is not set.
+    Import("env")
+    PROJECT_DIR = env["PROJECT_DIR"]
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+SRC_DIR = os.path.join(PROJECT_DIR, "src")
+INPUT_FILE = os.path.join(SRC_DIR, "WebStaticData.h")
+OUTPUT_FILE = os.path.join(SRC_DIR, "WebStaticData_gz.h")
+
+# Arrays of concatenated string literals to compress.
+ARRAYS = ["pgDefaultCSS"]
+
+STRING_LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+
+
+def get_array_content(source, name):
+    start = source.find("static const char " + name + "[] PROGMEM = {")
+    if start == -1:
+        sys.exit("Array " + name + " not found in " + INPUT_FILE)
+    end = re.compile(r"^\s*\};", re.MULTILINE).search(source, start).start()
+    content = ""
+    for line in source[start:end].splitlines()[1:]:
+        line = line.strip()
+        if line.startswith("//"):
+            continue
+        for literal in STRING_LITERAL.findall(line):
+            content += literal.encode("latin-1").decode("unicode_escape")
+    # Like strlen(), the content ends at an embedded "\0"
+    return content.split("\0")[0].encode("latin-1")
+
+
+# Same as contentHash() in WebServer.ino
+def fnv1a_hash(data):
+    hash = 2166136261
+    for b in bytearray(data):
+        hash ^= b
+        hash = (hash * 16777619) & 0xffffffff
+    return hash
+
+
+def gzip_bytes(data):
+    out = io.BytesIO()
+    # Fixed mtime, so the output only changes when the content changes.
+    with gzip.GzipFile(fileobj=out, mode="wb", compresslevel=9, mtime=0) as f:
+        f.write(data)
+    return out.getvalue()
+
+
+def main():
+    with open(INPUT_FILE, "r") as f:
+        source = f.read()
+
+    lines = [
+        "#ifndef WEBSTATICDATA_GZ_h",
+        "#define WEBSTATICDATA_GZ_h",
+        "",
+        "// Generated using gzip_static_data.py from WebStaticData.h, do not edit.",
+        "",
+    ]
+    for name in ARRAYS:
+        data = get_array_content(source, name)
+        compressed = bytearray(gzip_bytes(data))
+        lines.append("// %s: %d bytes, gzip %d bytes" % (name, len(data), len(compressed)))
+        lines.append("#define %s_gz_source_len %d" % (name, len(data)))
+        lines.append("#define %s_gz_source_hash 0x%08xUL" % (name, fnv1a_hash(data)))
+        lines.append("static const char %s_gz[] PROGMEM = {" % name)
+        for i in range(0, len(compressed), 12):
+            chunk = compressed[i:i + 12]
+            lines.append("  " + ", ".join("0x%02x" % b for b in chunk) + ",")
+        lines.append("};")
+        lines.append("const unsigned int %s_gz_len = %d;" % (name, len(compressed)))
+        lines.append("")
+    lines.append("#endif // WEBSTATICDATA_GZ_h")
+
+    output = "\n".join(lines) + "\n"
+    # Only write when changed, so the build does not recompile the web server every time.
+    if os.path.exists(OUTPUT_FILE):
+        with open(OUTPUT_FILE, "r") as f:
+            if f.read() == output:
+                return
+    with open(OUTPUT_FILE, "w") as f:
+        f.write(output)
+    print("Written " + OUTPUT_FILE)
+
+
+main()
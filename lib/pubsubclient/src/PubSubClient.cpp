@@ -430,6 +430,48 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
     return rc == tlen + 3 + llen + plength;
 }
 
+boolean PubSubClient::beginPublish(const char* topic, boolean retained) {
+    _publishLength = 0;
+    if (!connected() || MQTT_MAX_PACKET_SIZE < 5 + 2 + strlen(topic)) {
+        return false;
+    }
+    // Leave room in the buffer for header and variable length field
+    _publishLength = writeString(topic,buffer,5);
+    _publishRetained = retained;
+    return true;
+}
+
+boolean PubSubClient::endPublish() {
+    const uint16_t length = _publishLength;
+    _publishLength = 0;
+    if (length == 0 || !connected()) {
+        return false;
+    }
+    uint8_t header = MQTTPUBLISH;
+    if (_publishRetained) {
+        header |= 1;
+    }
+    return write(header,buffer,length-5);
+}
+
+size_t PubSubClient::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+size_t PubSubClient::write(const uint8_t *data, size_t size) {
+    if (_publishLength == 0) {
+        return 0;
+    }
+    if (_publishLength + size > MQTT_MAX_PACKET_SIZE) {
+        // Too long, endPublish() will fail
+        _publishLength = 0;
+        return 0;
+    }
+    memcpy(buffer + _publishLength, data, size);
+    _publishLength += size;
+    return size;
+}
+
 boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
     uint8_t lenBuf[4];
     uint8_t llen = 0;
@@ -81,10 +81,13 @@
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
 #endif
 
-class PubSubClient {
+class PubSubClient : public Print {
 private:
    Client* _client;
    uint8_t buffer[MQTT_MAX_PACKET_SIZE];
+   // Length of the message composed in buffer by beginPublish(), 0 when none
+   uint16_t _publishLength = 0;
+   boolean _publishRetained = false;
    uint16_t nextMsgId;
    unsigned long lastOutActivity;
    unsigned long lastInActivity;
@@ -134,6 +137,17 @@ public:
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
    boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   // Compose a publish message in the packet buffer, without a copy of the payload:
+   //   beginPublish(topic, retained), print() or write() the payload, endPublish()
+   // The buffer is shared, so call no other functions of the client before endPublish().
+   // Returns false when not connected or the topic does not fit in MQTT_MAX_PACKET_SIZE.
+   boolean beginPublish(const char* topic, boolean retained);
+   // Sends the message, false when the payload did not fit or the send failed.
+   boolean endPublish();
+   // Append to the payload of the message started with beginPublish()
+   virtual size_t write(uint8_t data);
+   virtual size_t write(const uint8_t *data, size_t size);
+   using Print::write;
    boolean subscribe(const char* topic);
    boolean subscribe(const char* topic, uint8_t qos);
    boolean unsubscribe(const char* topic);
@@ -21,6 +21,7 @@ String Command_Settings_Unit(struct EventStruct *event, const char* Line)
 	char TmpStr1[INPUT_COMMAND_SIZE];
 	if (GetArgv(Line, TmpStr1, 2)) {
 		Settings.Unit = event->Par1;
+		invalidateMQTTTopicCache();
 	}else  {
 		Serial.println();
 		String result = F("Unit:");
@@ -32,11 +33,14 @@ String Command_Settings_Unit(struct EventStruct *event, const char* Line)
 
 String Command_Settings_Name(struct EventStruct *event, const char* Line)
 {
-	return Command_GetORSetString(event, F("Name:"),
+	const String result = Command_GetORSetString(event, F("Name:"),
 				      Line,
 				      Settings.Name,
 				      sizeof(Settings.Name),
 				      1);
+	// Cached MQTT topics may hold the old name.
+	invalidateMQTTTopicCache();
+	return result;
 }
 
 String Command_Settings_Password(struct EventStruct *event, const char* Line)
@@ -5,7 +5,7 @@ void sendData(struct EventStruct *event)
 {
   START_TIMER;
   checkRAM(F("sendData"));
- LoadTaskSettings(event->TaskIndex);
+  LoadTaskSettings(event->TaskIndex);
   if (Settings.UseRules)
     createRuleEvents(event->TaskIndex);
 
@@ -15,59 +15,308 @@ void sendData(struct EventStruct *event)
 //  if (!Settings.TaskDeviceSendData[event->TaskIndex])
 //    return false;
 
-  if (Settings.MessageDelay != 0)
-  {
-    const long dif = timePassedSince(lastSend);
-    if (dif > 0 && dif < static_cast<long>(Settings.MessageDelay))
-    {
-      uint16_t delayms = Settings.MessageDelay - dif;
-      //this is logged nowhere else, so might as well disable it here also:
-      // addLog(LOG_LEVEL_DEBUG_MORE, String(F("CTRL : Message delay (ms): "))+delayms);
+  // The controllers are called from the scheduler, see processSendDataQueue()
+  queueSendData(event);
+  eventStreamTaskValues(event->TaskIndex);
 
-     delayBackground(delayms);
+  PluginCall(PLUGIN_EVENT_OUT, event, dummyString);
+  STOP_TIMER(SEND_DATA_STATS);
+}
 
-      // unsigned long timer = millis() + delayms;
-      // while (!timeOutReached(timer))
-      //   backgroundtasks();
+/*********************************************************************************************\
+ * Queue of task values to be sent to the controllers.
+ * The values are stored with the entry, so a quick sequence of (switch) events is not lost.
+ * Controllers using batch send get all entries collected within SEND_DATA_BATCH_WINDOW_MSEC
+ * in one request, others one entry per call.
+ * Per controller Settings.MessageDelay is kept between calls by scheduling, instead of blocking.
+ * A failed send is retried with exponential backoff, after CONTROLLER_SEND_MAX_RETRIES
+ * the failing entry is dropped for that controller.
+ * The controllers get the values of the entry through EventStruct::Values, UserVar is not changed.
+\*********************************************************************************************/
+SendDataEntryStruct sendDataQueue[SEND_DATA_QUEUE_MAX];
+byte sendDataQueueLength = 0;
+
+// A controller may call delayBackground() and with it queueSendData(), e.g. from rules.
+// The entries being sent must not move meanwhile, so new entries wait here until done.
+SendDataEntryStruct sendDataDeferred[SEND_DATA_DEFERRED_MAX];
+byte sendDataDeferredLength = 0;
+bool sendDataQueueBusy = false;
+
+#define SEND_SKIPPED  0
+#define SEND_OK       1
+#define SEND_FAILED   2
+
+void queueSendData(struct EventStruct *event)
+{
+  byte controllers = 0;
+  for (byte x = 0; x < CONTROLLER_MAX; x++) {
+    if (Settings.TaskDeviceSendData[x][event->TaskIndex] &&
+        Settings.ControllerEnabled[x] && Settings.Protocol[x])
+      controllers |= (1 << x);
+  }
+  if (controllers == 0) return;
+  SendDataEntryStruct entry;
+  entry.received = millis();
+  entry.TaskIndex = event->TaskIndex;
+  entry.sensorType = event->sensorType;
+  entry.controllers = controllers;
+  for (byte i = 0; i < VARS_PER_TASK; ++i) {
+    entry.values[i] = UserVar[event->TaskIndex * VARS_PER_TASK + i];
+  }
+  if (sendDataQueueBusy) {
+    if (sendDataDeferredLength >= SEND_DATA_DEFERRED_MAX) {
+      countDroppedSendDataEntry(sendDataDeferred[0]);
+      for (byte i = 1; i < sendDataDeferredLength; ++i)
+        sendDataDeferred[i - 1] = sendDataDeferred[i];
+      --sendDataDeferredLength;
     }
+    sendDataDeferred[sendDataDeferredLength++] = entry;
+    return;
   }
+  addSendDataEntry(entry);
+  scheduleSendDataQueue();
+}
 
-  LoadTaskSettings(event->TaskIndex); // could have changed during background tasks.
+void addSendDataEntry(const SendDataEntryStruct& entry)
+{
+  if (sendDataQueueLength >= SEND_DATA_QUEUE_MAX) {
+    // Drop the oldest entry.
+    countDroppedSendDataEntry(sendDataQueue[0]);
+    removeSendDataEntry(0);
+  }
+  sendDataQueue[sendDataQueueLength++] = entry;
+}
 
-  for (byte x=0; x < CONTROLLER_MAX; x++)
-  {
-    event->ControllerIndex = x;
-    event->idx = Settings.TaskDeviceID[x][event->TaskIndex];
-    if (Settings.TaskDeviceSendData[event->ControllerIndex][event->TaskIndex] &&
-        Settings.ControllerEnabled[event->ControllerIndex] && Settings.Protocol[event->ControllerIndex])
-    {
-      event->ProtocolIndex = getProtocolIndex(Settings.Protocol[event->ControllerIndex]);
-      if (validUserVar(event)) {
-        CPlugin_ptr[event->ProtocolIndex](CPLUGIN_PROTOCOL_SEND, event, dummyString);
-      } else {
-        String log = F("Invalid value detected for controller ");
-        String controllerName;
-        CPlugin_ptr[event->ProtocolIndex](CPLUGIN_GET_DEVICENAME, event, controllerName);
-        log += controllerName;
-        addLog(LOG_LEVEL_DEBUG, log);
+void countDroppedSendDataEntry(const SendDataEntryStruct& entry)
+{
+  for (byte x = 0; x < CONTROLLER_MAX; x++) {
+    if (entry.controllers & (1 << x))
+      ++ControllerQueue[x].dropped;
+  }
+}
+
+void removeSendDataEntry(byte pos)
+{
+  for (byte i = pos + 1; i < sendDataQueueLength; ++i) {
+    sendDataQueue[i - 1] = sendDataQueue[i];
+  }
+  --sendDataQueueLength;
+}
+
+// Number of queued entries still to be sent to the controller.
+byte getSendDataQueueDepth(byte ControllerIndex)
+{
+  byte depth = 0;
+  for (byte i = 0; i < sendDataQueueLength; ++i) {
+    if (sendDataQueue[i].controllers & (1 << ControllerIndex))
+      ++depth;
+  }
+  return depth;
+}
+
+// Position of the first queued entry for the controller, or -1 if none.
+int firstSendDataEntry(byte ControllerIndex)
+{
+  for (byte i = 0; i < sendDataQueueLength; ++i) {
+    if (sendDataQueue[i].controllers & (1 << ControllerIndex))
+      return i;
+  }
+  return -1;
+}
+
+bool controllerUsesBatchSend(byte ControllerIndex)
+{
+  return Protocol[getProtocolIndex(Settings.Protocol[ControllerIndex])].usesBatchSend;
+}
+
+// Moment the controller may send its first queued entry.
+unsigned long getControllerSendTime(byte ControllerIndex, const SendDataEntryStruct& entry)
+{
+  const ControllerQueueStruct& queue = ControllerQueue[ControllerIndex];
+  unsigned long runAt = entry.received;
+  if (controllerUsesBatchSend(ControllerIndex))
+    runAt += SEND_DATA_BATCH_WINDOW_MSEC;
+  if (Settings.MessageDelay != 0 && queue.lastSend != 0) {
+    const unsigned long allowedAt = queue.lastSend + Settings.MessageDelay;
+    if (timeDiff(runAt, allowedAt) > 0) runAt = allowedAt;
+  }
+  if (queue.failures != 0 && timeDiff(runAt, queue.retryAt) > 0)
+    runAt = queue.retryAt;
+  return runAt;
+}
+
+// Schedule the next run of processSendDataQueue(), if anything is left to send.
+void scheduleSendDataQueue()
+{
+  unsigned long runAt = 0;
+  bool found = false;
+  for (byte x = 0; x < CONTROLLER_MAX; x++) {
+    const int pos = firstSendDataEntry(x);
+    if (pos >= 0) {
+      const unsigned long controllerRunAt = getControllerSendTime(x, sendDataQueue[pos]);
+      if (!found || timeDiff(controllerRunAt, runAt) > 0) runAt = controllerRunAt;
+      found = true;
+    }
+  }
+  if (found)
+    schedule_send_data_timer(runAt);
+}
+
+void processSendDataQueue(bool ignoreSendTime)
+{
+  // Called again while a controller waits in delayBackground(), the outer call continues.
+  if (sendDataQueueBusy) return;
+  START_TIMER;
+  sendDataQueueBusy = true;
+  for (byte x = 0; x < CONTROLLER_MAX; x++) {
+    const byte mask = 1 << x;
+    if (!Settings.ControllerEnabled[x] || !Settings.Protocol[x]) {
+      for (byte i = 0; i < sendDataQueueLength; ++i)
+        sendDataQueue[i].controllers &= ~mask;
+      ControllerQueue[x].failures = 0;
+      continue;
+    }
+    const int first = firstSendDataEntry(x);
+    if (first < 0) continue;
+    if (!ignoreSendTime && !timeOutReached(getControllerSendTime(x, sendDataQueue[first]))) continue;
+
+    struct EventStruct TempEvent;
+    TempEvent.ControllerIndex = x;
+    TempEvent.ProtocolIndex = getProtocolIndex(Settings.Protocol[x]);
+    const bool batch = Protocol[TempEvent.ProtocolIndex].usesBatchSend;
+    byte result = SEND_SKIPPED;
+    byte included[SEND_DATA_QUEUE_MAX]; // Positions of entries handed to the controller
+    byte nrIncluded = 0;
+    for (byte i = first; i < sendDataQueueLength; ++i) {
+      SendDataEntryStruct& entry = sendDataQueue[i];
+      if (!(entry.controllers & mask)) continue;
+      if (batch && !ignoreSendTime && !timeOutReached(entry.received + SEND_DATA_BATCH_WINDOW_MSEC)) break;
+      result = sendDataEntry(entry, &TempEvent);
+      if (result != SEND_FAILED)
+        entry.controllers &= ~mask;
+      if (result == SEND_OK)
+        included[nrIncluded++] = i;
+      if (!batch) break;
+    }
+    if (batch && nrIncluded != 0) {
+      result = CPlugin_ptr[TempEvent.ProtocolIndex](CPLUGIN_FLUSH, &TempEvent, dummyString) ? SEND_OK : SEND_FAILED;
+      if (result == SEND_FAILED) {
+        // Keep the entries for the next attempt.
+        for (byte i = 0; i < nrIncluded; ++i)
+          sendDataQueue[included[i]].controllers |= mask;
       }
     }
+    processSendResult(x, result, batch ? nrIncluded : 1);
+  }
+  for (byte i = sendDataQueueLength; i > 0; --i) {
+    if (sendDataQueue[i - 1].controllers == 0)
+      removeSendDataEntry(i - 1);
   }
+  sendDataQueueBusy = false;
+  for (byte i = 0; i < sendDataDeferredLength; ++i)
+    addSendDataEntry(sendDataDeferred[i]);
+  sendDataDeferredLength = 0;
+  scheduleSendDataQueue();
+  STOP_TIMER(SEND_DATA_STATS);
+}
 
-  PluginCall(PLUGIN_EVENT_OUT, event, dummyString);
+void processSendResult(byte ControllerIndex, byte result, byte nrEntries)
+{
+  if (result == SEND_SKIPPED) return;
+  ControllerQueueStruct& queue = ControllerQueue[ControllerIndex];
   lastSend = millis();
-  STOP_TIMER(SEND_DATA_STATS);
+  queue.lastSend = lastSend;
+  if (result == SEND_OK) {
+    queue.sent += nrEntries;
+    queue.failures = 0;
+    return;
+  }
+  if (queue.failures < 255)
+    ++queue.failures;
+  if (queue.failures > CONTROLLER_SEND_MAX_RETRIES) {
+    // Give up on the oldest entry, keep trying the next ones at the max. interval.
+    const int pos = firstSendDataEntry(ControllerIndex);
+    if (pos >= 0) {
+      sendDataQueue[pos].controllers &= ~(1 << ControllerIndex);
+      ++queue.dropped;
+    }
+  } else {
+    ++queue.retries;
+  }
+  const byte shift = queue.failures > 8 ? 8 : queue.failures - 1;
+  unsigned long backoff = static_cast<unsigned long>(CONTROLLER_RETRY_DELAY_MSEC) << shift;
+  if (backoff > CONTROLLER_RETRY_DELAY_MAX_MSEC)
+    backoff = CONTROLLER_RETRY_DELAY_MAX_MSEC;
+  queue.retryAt = millis() + backoff;
+}
+
+// Send everything left in the queue, e.g. before going to deep sleep.
+// No retries are done here.
+void flushSendDataQueue()
+{
+  while (sendDataQueueLength != 0 && !sendDataQueueBusy) {
+    if (Settings.MessageDelay != 0) {
+      const long dif = timePassedSince(lastSend);
+      if (dif >= 0 && dif < static_cast<long>(Settings.MessageDelay))
+        delayBackground(Settings.MessageDelay - dif);
+    }
+    for (byte x = 0; x < CONTROLLER_MAX; x++) {
+      // Make sure a failing entry will be dropped.
+      ControllerQueue[x].failures = CONTROLLER_SEND_MAX_RETRIES;
+    }
+    processSendDataQueue(true);
+  }
+}
+
+// Call the controller with the values stored in the entry.
+byte sendDataEntry(const SendDataEntryStruct& entry, struct EventStruct *event)
+{
+  const byte TaskIndex = entry.TaskIndex;
+  event->TaskIndex = TaskIndex;
+  event->BaseVarIndex = TaskIndex * VARS_PER_TASK;
+  event->sensorType = entry.sensorType;
+  event->idx = Settings.TaskDeviceID[event->ControllerIndex][TaskIndex];
+  // UserVar may have changed since queued.
+  event->Values = entry.values;
+  LoadTaskSettings(TaskIndex);
+
+  byte result = SEND_SKIPPED;
+  if (validUserVar(event)) {
+    const bool batch = Protocol[event->ProtocolIndex].usesBatchSend;
+    if (CPlugin_ptr[event->ProtocolIndex](CPLUGIN_PROTOCOL_SEND, event, dummyString))
+      result = SEND_OK;
+    else
+      // A batch controller only collects the values, nothing to retry then.
+      result = batch ? SEND_SKIPPED : SEND_FAILED;
+  } else {
+    String log = F("Invalid value detected for controller ");
+    String controllerName;
+    CPlugin_ptr[event->ProtocolIndex](CPLUGIN_GET_DEVICENAME, event, controllerName);
+    log += controllerName;
+    addLog(LOG_LEVEL_DEBUG, log);
+  }
+  event->Values = NULL;
+  return result;
 }
 
 boolean validUserVar(struct EventStruct *event) {
   byte valueCount = getValueCountFromSensorType(event->sensorType);
+  const float* values = getEventValues(event);
   for (int i = 0; i < valueCount; ++i) {
-    const float f(UserVar[event->BaseVarIndex + i]);
+    const float f(values[i]);
     if (!isValidFloat(f)) return false;
   }
   return true;
 }
 
+// The task values of the event, the queued values when sending to a controller.
+const float* getEventValues(struct EventStruct *event)
+{
+  if (event->Values != NULL)
+    return event->Values;
+  return &UserVar[event->BaseVarIndex];
+}
+
 /*********************************************************************************************\
  * Handle incoming MQTT messages
 \*********************************************************************************************/
@@ -125,8 +374,7 @@ void callback(char* c_topic, byte* b_payload, unsigned int length) {
 bool MQTTConnect(int controller_idx)
 {
   ++mqtt_reconnect_count;
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(controller_idx, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(controller_idx);
   if (!ControllerSettings.checkHostReachable(true))
     return false;
   if (MQTTclient.connected()) {
@@ -265,7 +513,27 @@ void SendStatus(byte source, String status)
 
 boolean MQTTpublish(int controller_idx, const char* topic, const char* payload, boolean retained)
 {
-  if (MQTTclient.publish(topic, payload, retained)) {
+  return MQTTpublishResult(MQTTclient.publish(topic, payload, retained));
+}
+
+// Publish with the payload printed straight into the MQTT packet buffer:
+//   MQTTbeginPublish(), MQTTclient.print() or printTo(MQTTclient) the payload, MQTTendPublish()
+boolean MQTTbeginPublish(const char* topic, boolean retained)
+{
+  if (MQTTclient.beginPublish(topic, retained))
+    return true;
+  addLog(LOG_LEVEL_DEBUG, F("MQTT : publish failed"));
+  return false;
+}
+
+boolean MQTTendPublish()
+{
+  return MQTTpublishResult(MQTTclient.endPublish());
+}
+
+boolean MQTTpublishResult(boolean success)
+{
+  if (success) {
     setIntervalTimerOverride(TIMER_MQTT, 10); // Make sure the MQTT is being processed as soon as possible.
     return true;
   }
@@ -273,15 +541,49 @@ boolean MQTTpublish(int controller_idx, const char* topic, const char* payload,
   return false;
 }
 
+/*********************************************************************************************\
+ * Publish topic of a task value: the controller Publish setting with all variables replaced.
+ * Kept until the settings change, unless the topic has variables changing at runtime.
+ * Those topics are parsed into topic once per publish, so pass the same empty String
+ * for all values of a publish. The result is valid until the next call.
+\*********************************************************************************************/
+const String& getMQTTTopic(struct EventStruct *event, byte varNr, String& topic)
+{
+  String& cachedTopic = MQTTTopicCache[event->TaskIndex].topics[event->ControllerIndex][varNr];
+  if (cachedTopic.length() != 0)
+    return cachedTopic;
+
+  if (topic.length() == 0) {
+    ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
+    topic = ControllerSettings.Publish;
+    parseControllerVariables(topic, event, false);
+    if (hasOnlySettingsVariables(ControllerSettings.Publish)) {
+      cachedTopic = topic;
+      cachedTopic.replace(F("%valname%"), ExtraTaskSettings.TaskDeviceValueNames[varNr]);
+      topic = String();
+      return cachedTopic;
+    }
+  }
+  static String valueTopic;
+  valueTopic = topic;
+  valueTopic.replace(F("%valname%"), ExtraTaskSettings.TaskDeviceValueNames[varNr]);
+  return valueTopic;
+}
+
+void invalidateMQTTTopicCache()
+{
+  for (byte x = 0; x < TASKS_MAX; ++x)
+    MQTTTopicCache[x].clear();
+}
+
 /*********************************************************************************************\
  * Send status info back to channel where request came from
 \*********************************************************************************************/
 void MQTTStatus(String& status)
 {
-  ControllerSettingsStruct ControllerSettings;
   int enabledMqttController = firstEnabledMQTTController();
   if (enabledMqttController >= 0) {
-    LoadControllerSettings(enabledMqttController, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+    ControllerSettingsStruct& ControllerSettings = getControllerSettings(enabledMqttController);
     String pubname = ControllerSettings.Subscribe;
     pubname.replace(F("/#"), F("/status"));
     parseSystemVariables(pubname, false);
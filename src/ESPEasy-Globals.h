@@ -88,6 +88,7 @@
 #define LOG_TO_SYSLOG         2
 #define LOG_TO_WEBLOG         3
 #define LOG_TO_SDCARD         4
+#define LOG_TO_EVENTSTREAM    5  // Only a log buffer reader, lines for the /events subscribers
 #define DEFAULT_SYSLOG_IP                       ""                      // Syslog IP Address
 #define DEFAULT_SYSLOG_LEVEL            0                               // Syslog Log Level
 #define DEFAULT_SERIAL_LOG_LEVEL        0                               // Serial Log Level
@@ -203,6 +204,8 @@
 #define TIMER_MQTT                          5
 #define TIMER_STATISTICS                    6
 
+#define IDLE_SLEEP_MAX_MSEC                10  // Max. time the loop sleeps waiting for the next timer
+
 #define PLUGIN_INIT_ALL                     1
 #define PLUGIN_INIT                         2
 #define PLUGIN_READ                         3
@@ -241,6 +244,7 @@
 #define CPLUGIN_TASK_CHANGE_NOTIFICATION    9
 #define CPLUGIN_INIT                       10
 #define CPLUGIN_UDP_IN                     11
+#define CPLUGIN_FLUSH                      12
 
 #define CONTROLLER_HOSTNAME                 1
 #define CONTROLLER_IP                       2
@@ -288,6 +292,7 @@
 #define CONTROLLER_MAX                      3 // max 4!
 #define NOTIFICATION_MAX                    3 // max 4!
 #define VARS_PER_TASK                       4
+#define FORMAT_VALUE_BUFFER_SIZE           33 // Formatted task value, like the buffer of String(float)
 #define PLUGIN_MAX                DEVICES_MAX
 #define PLUGIN_CONFIGVAR_MAX                8
 #define PLUGIN_CONFIGFLOATVAR_MAX           4
@@ -356,6 +361,13 @@
 #define DAT_NOTIFICATION_SIZE            1024
 
 #define DAT_BASIC_SETTINGS_SIZE          4096
+#define DAT_BASIC_SETTINGS_MD5_OFFSET    (DAT_BASIC_SETTINGS_SIZE - 16) // MD5 of SettingsStruct, at the end of its area
+#define DAT_FILE_PAGE_SIZE               256   // Settings files are compared and written per page
+
+// Changes to config.dat and security.dat are written to FILE_SETTINGS_JOURNAL first, see writeToFile()
+#define SETTINGS_JOURNAL_MAGIC           0x4A53
+#define SETTINGS_JOURNAL_DATA            1     // Record followed by 'length' bytes for 'offset' in 'file'
+#define SETTINGS_JOURNAL_COMMIT          2     // Data records before it are complete, 'offset' holds their total length
 
 #if defined(ESP8266)
   #define DAT_OFFSET_TASKS                 4096  // each task = 2k, (1024 basic + 1024 bytes custom), 12 max
@@ -408,6 +420,7 @@ bool showSettingsFileLayout = false;
 #endif
 
 #include "WebStaticData.h"
+#include "WebStaticData_gz.h"
 #include "ESPEasyTimeTypes.h"
 #include "I2CTypes.h"
 #include <I2Cdev.h>
@@ -421,6 +434,7 @@ bool showSettingsFileLayout = false;
   #define FILE_SECURITY     "security.dat"
   #define FILE_NOTIFICATION "notification.dat"
   #define FILE_RULES        "rules1.txt"
+  #define FILE_SETTINGS_JOURNAL "settings.jnl"
   #include <lwip/init.h>
   #ifndef LWIP_VERSION_MAJOR
     #error
@@ -477,7 +491,17 @@ bool showSettingsFileLayout = false;
   #define FILE_SECURITY     "/security.dat"
   #define FILE_NOTIFICATION "/notification.dat"
   #define FILE_RULES        "/rules1.txt"
+  #define FILE_SETTINGS_JOURNAL "/settings.jnl"
+  #ifdef USE_SETTINGS_PARTITION
+    // Keep config.dat in a memory mapped data partition instead of SPIFFS.
+    // The partition table must have a data partition with this label of at least CONFIG_FILE_SIZE.
+    #ifndef SETTINGS_PARTITION_LABEL
+      #define SETTINGS_PARTITION_LABEL "espeasy_cfg"
+    #endif
+    #include <esp_partition.h>
+  #endif
   #include <WiFi.h>
+  #include <lwip/sockets.h>
   #include  "esp32_ping.h"
   #include <ESP32WebServer.h>
   #include "SPIFFS.h"
@@ -660,6 +684,7 @@ struct SettingsStruct
     SyslogFacility = DEFAULT_SYSLOG_FACILITY;
     StructSize = 0;
     MQTTUseUnitNameAsClientId = 0;
+    EventQueueBatchSize = 0;
 
     for (byte i = 0; i < CONTROLLER_MAX; ++i) {
       Protocol[i] = 0;
@@ -786,6 +811,7 @@ struct SettingsStruct
   //TODO: document config.dat somewhere here
   float         Latitude;
   float         Longitude;
+  byte          EventQueueBatchSize; // Max. number of queued system events processed per loop, 0 = default
 
   // FIXME @TD-er: As discussed in #1292, the CRC for the settings is now disabled.
   // make sure crc is the last value in the struct
@@ -915,6 +941,31 @@ private:
 
 };
 
+// Controller settings kept in RAM, so the controllers do not read them from flash on every send.
+// See getControllerSettings()
+struct ControllerSettingsCacheStruct
+{
+  ControllerSettingsCacheStruct() : settings(nullptr), valid(false), loads(0) {}
+
+  ControllerSettingsStruct* settings; // Allocated on first use, never freed since references to it are kept during a call
+  bool valid;
+  unsigned long loads;                // Number of times loaded from flash
+} ControllerSettingsCache[CONTROLLER_MAX];
+
+// Publish topics of the task values, parsed once until the settings change. See getMQTTTopic()
+// Per controller, a task sent to several MQTT controllers has topics for each.
+struct MQTTTopicCacheStruct
+{
+  void clear() {
+    for (byte x = 0; x < CONTROLLER_MAX; ++x) {
+      for (byte i = 0; i < VARS_PER_TASK; ++i)
+        topics[x][i] = String();
+    }
+  }
+
+  String topics[CONTROLLER_MAX][VARS_PER_TASK]; // Empty when not parsed yet
+} MQTTTopicCache[TASKS_MAX];
+
 struct NotificationSettingsStruct
 {
   NotificationSettingsStruct() : Port(0), Pin1(0), Pin2(0) {
@@ -1015,12 +1066,116 @@ struct ExtraTaskSettingsStruct
   int16_t TaskDevicePluginConfig[PLUGIN_EXTRACONFIGVAR_MAX];
 } ExtraTaskSettings;
 
+// Task value formulas are compiled once into RPN instructions, with %value% and %pvalue%
+// as register operands, to evaluate them without parsing the formula on every read.
+// See compileTaskFormula() in Misc.ino
+#define FORMULA_NOT_COMPILED                0
+#define FORMULA_COMPILED                    1
+#define FORMULA_USE_TEXT                    2  // Cannot be represented by the compiled form, use Calculate()
+
+#define FORMULA_INSTR_CONST                 0
+#define FORMULA_INSTR_VALUE                 1
+#define FORMULA_INSTR_PVALUE                2
+#define FORMULA_INSTR_OPERATOR              3
+
+struct FormulaInstruction
+{
+  FormulaInstruction() : type(FORMULA_INSTR_CONST), op(0), value(0.0) {}
+  FormulaInstruction(byte t, char o, float v) : type(t), op(o), value(v) {}
+
+  byte  type;
+  char  op;
+  float value;
+};
+
+struct TaskFormulaStruct
+{
+  TaskFormulaStruct() : state(FORMULA_NOT_COMPILED), usesValue(false), usesPValue(false),
+    valueSignSensitive(false), pvalueSignSensitive(false) {}
+
+  void clear() {
+    state = FORMULA_NOT_COMPILED;
+    usesValue = false;
+    usesPValue = false;
+    valueSignSensitive = false;
+    pvalueSignSensitive = false;
+    program.clear();
+  }
+
+  byte    state;
+  boolean usesValue;
+  boolean usesPValue;
+  // A negative %value% is parsed by Calculate() as '-' operator, unless preceded by another operator.
+  // Then the compiled program cannot be used, since that changes the order of operations.
+  boolean valueSignSensitive;
+  boolean pvalueSignSensitive;
+  std::vector<FormulaInstruction> program;
+} TaskFormula[TASKS_MAX][VARS_PER_TASK];
+
+// Most used fields of ExtraTaskSettings for all tasks, to prevent reading
+// the settings file for every task name or value name lookup.
+struct TaskSettingsCacheStruct
+{
+  TaskSettingsCacheStruct() : loaded(false) {
+    clear();
+  }
+
+  void clear() {
+    loaded = false;
+    TaskDeviceName = "";
+    for (byte i = 0; i < VARS_PER_TASK; ++i) {
+      TaskDeviceValueNames[i] = "";
+      TaskDeviceValueDecimals[i] = 2;
+    }
+  }
+
+  boolean loaded;
+  String  TaskDeviceName;
+  String  TaskDeviceValueNames[VARS_PER_TASK];
+  byte    TaskDeviceValueDecimals[VARS_PER_TASK];
+} TaskSettingsCache[TASKS_MAX];
+
+struct TaskSettingsCacheStatsStruct
+{
+  TaskSettingsCacheStatsStruct() : hits(0), misses(0), fileLoads(0), start(0) {}
+
+  void reset() {
+    hits = 0;
+    misses = 0;
+    fileLoads = 0;
+    start = millis();
+  }
+
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long fileLoads; // Number of LoadFromFile() calls
+  unsigned long start;
+} taskSettingsCacheStats;
+
+// Index of the task value names, see findTaskValueByName()
+#define TASK_VALUE_INDEX_SIZE  (TASKS_MAX * VARS_PER_TASK)
+
+struct TaskValueIndexStruct
+{
+  TaskValueIndexStruct() : valid(false), nrEntries(0) {}
+
+  bool valid;
+  byte nrEntries;
+  uint32_t hash[TASK_VALUE_INDEX_SIZE];   // Sorted
+  byte taskVar[TASK_VALUE_INDEX_SIZE];    // TaskIndex * VARS_PER_TASK + varNr
+} TaskValueIndex;
+
+// Change counters of the task values, see updateTaskDataVersions()
+unsigned long dataVersion = 0;               // Last version handed out
+unsigned long taskDataVersion[TASKS_MAX];    // Version of the last change per task
+float taskDataSnapshot[VARS_PER_TASK * TASKS_MAX];
+
 struct EventStruct
 {
   EventStruct() :
     Source(0), TaskIndex(TASKS_MAX), ControllerIndex(0), ProtocolIndex(0), NotificationIndex(0),
     BaseVarIndex(0), idx(0), sensorType(0), Par1(0), Par2(0), Par3(0), Par4(0), Par5(0),
-    OriginTaskIndex(0), Data(NULL) {}
+    OriginTaskIndex(0), Data(NULL), Values(NULL) {}
   EventStruct(const struct EventStruct& event):
         Source(event.Source), TaskIndex(event.TaskIndex), ControllerIndex(event.ControllerIndex)
         , ProtocolIndex(event.ProtocolIndex), NotificationIndex(event.NotificationIndex)
@@ -1032,7 +1187,7 @@ struct EventStruct
         , String3(event.String3)
         , String4(event.String4)
         , String5(event.String5)
-        , Data(event.Data) {}
+        , Data(event.Data), Values(event.Values) {}
 
   byte Source;
   byte TaskIndex; // index position in TaskSettings array, 0-11
@@ -1056,123 +1211,162 @@ struct EventStruct
   String String4;
   String String5;
   byte *Data;
+  const float *Values; // Task values to use instead of UserVar, see getEventValues()
 };
 
-#define LOG_STRUCT_MESSAGE_SIZE 128
+// Log lines are kept as variable length records in byte ring buffers.
+// Record: timestamp (4 bytes), log level, destinations bit mask, length (2 bytes), followed by the text.
+// Serial and syslog read from one ring, the web log and /events from another,
+// so lots of serial only (e.g. debug) lines do not push the lines out of the web log.
+// Each destination (serial, syslog, web log, /events) has its own cursor,
+// the oldest records are overwritten when a ring is full.
+#define LOG_STRUCT_MESSAGE_SIZE 128 // Web log and /events lines are cut at this size, including the 0
 #ifdef ESP32
-  #define LOG_STRUCT_MESSAGE_LINES 30
+  #define LOG_BUFFER_SIZE       4096
 #else
   #if defined(PLUGIN_BUILD_TESTING) || defined(PLUGIN_BUILD_DEV)
-    #define LOG_STRUCT_MESSAGE_LINES 10
+    #define LOG_BUFFER_SIZE     1024
   #else
-    #define LOG_STRUCT_MESSAGE_LINES 15
+    #define LOG_BUFFER_SIZE     2048
   #endif
 #endif
+#define LOG_RING_SIZE           (LOG_BUFFER_SIZE / 2) // Both rings, LOG_BUFFER_SIZE must be a power of 2
+#define LOG_RING_MASK           (LOG_RING_SIZE - 1)
+#define LOG_LINE_MAX_SIZE       (LOG_RING_SIZE / 2)   // Serial and syslog lines are cut at this size, excluding the 0
+#define LOG_RECORD_HEADER_SIZE  8
+#define LOG_READER_MAX          (LOG_TO_EVENTSTREAM + 1) // Cursor index is the LOG_TO_xxx destination
+#define LOG_WEB_DESTINATIONS    ((1 << LOG_TO_WEBLOG) | (1 << LOG_TO_EVENTSTREAM))
 
-struct LogStruct {
-    LogStruct() : write_idx(0), read_idx(0) {
-      for (int i = 0; i < LOG_STRUCT_MESSAGE_LINES; ++i) {
-        Message[i].reserve(LOG_STRUCT_MESSAGE_SIZE);
-        timeStamp[i] = 0;
-        log_level[i] = 0;
+#ifdef ESP32
+  // Log lines may be added from other RTOS tasks.
+  // Those tasks only add to the buffer, the readers run from the main loop.
+  TaskHandle_t mainLoopTaskHandle = NULL;
+  portMUX_TYPE logBufferMux = portMUX_INITIALIZER_UNLOCKED;
+  #define LOG_BUFFER_LOCK()     portENTER_CRITICAL(&logBufferMux)
+  #define LOG_BUFFER_UNLOCK()   portEXIT_CRITICAL(&logBufferMux)
+#else
+  #define LOG_BUFFER_LOCK()
+  #define LOG_BUFFER_UNLOCK()
+#endif
+
+struct LogRingStruct {
+    LogRingStruct() : head(0), tail(0) {
+      for (byte i = 0; i < LOG_READER_MAX; ++i) {
+        cursor[i] = 0;
       }
     }
 
-    void add(const byte loglevel, const char *line) {
-      write_idx = (write_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-      if (write_idx == read_idx) {
-        // Buffer full, move read_idx to overwrite oldest entry.
-        read_idx = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-      }
-      timeStamp[write_idx] = millis();
-      log_level[write_idx] = loglevel;
-      unsigned linelength = strlen(line);
-      if (linelength > LOG_STRUCT_MESSAGE_SIZE-1)
-        linelength = LOG_STRUCT_MESSAGE_SIZE-1;
-      Message[write_idx] = "";
-      for (unsigned i = 0; i < linelength; ++i) {
-        Message[write_idx] += *(line + i);
+    void add(const unsigned long timestamp, const byte loglevel, const byte destinations, const char *line, const uint16_t linelength) {
+      uint8_t header[LOG_RECORD_HEADER_SIZE];
+      memcpy(header, &timestamp, 4);
+      header[4] = loglevel;
+      header[5] = destinations;
+      memcpy(header + 6, &linelength, 2);
+      const uint32_t recordSize = LOG_RECORD_HEADER_SIZE + linelength;
+
+      // Drop the oldest records to make room.
+      while ((head - tail) + recordSize > LOG_RING_SIZE) {
+        tail += LOG_RECORD_HEADER_SIZE + recordLength(tail);
       }
+      copyIn(head, header, LOG_RECORD_HEADER_SIZE);
+      copyIn(head + LOG_RECORD_HEADER_SIZE, line, linelength);
+      head += recordSize;
     }
 
-    // Read the next item and append it to the given string.
-    // Returns whether new lines are available.
-    bool get(String& output, const String& lineEnd) {
-      if (!isEmpty()) {
-        read_idx = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-        output += formatLine(read_idx, lineEnd);
+    // Copy at most size-1 chars of the line, the rest of a longer line is skipped.
+    bool read(const byte destination, unsigned long& timestamp, byte& loglevel, char *line, const unsigned int size) {
+      bool found = false;
+      uint32_t pos = cursor[destination];
+      if ((head - pos) > (head - tail)) {
+        // Lines not read yet were overwritten, continue at the oldest.
+        pos = tail;
+      }
+      while (!found && pos != head) {
+        uint8_t header[LOG_RECORD_HEADER_SIZE];
+        copyOut(pos, header, LOG_RECORD_HEADER_SIZE);
+        const uint16_t linelength = recordLength(pos);
+        if (header[5] & (1 << destination)) {
+          memcpy(&timestamp, header, 4);
+          loglevel = header[4];
+          const unsigned int length = _min(linelength, size - 1);
+          copyOut(pos + LOG_RECORD_HEADER_SIZE, line, length);
+          line[length] = 0;
+          found = true;
+        }
+        pos += LOG_RECORD_HEADER_SIZE + linelength;
       }
-      return !isEmpty();
+      cursor[destination] = pos;
+      return found;
     }
 
-    String get_logjson_formatted(bool& logLinesAvailable, unsigned long& timestamp) {
-      logLinesAvailable = false;
-      if (isEmpty()) {
-        return "";
-      }
-      read_idx = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-      timestamp = timeStamp[read_idx];
-      String output = logjson_formatLine(read_idx);
-      if (isEmpty()) return output;
-      output += ",\n";
-      logLinesAvailable = true;
-      return output;
+    bool isEmpty(const byte destination) {
+      return cursor[destination] == head;
     }
 
-    bool get(String& output, const String& lineEnd, int line) {
-      int tmpread((write_idx + 1+line) % LOG_STRUCT_MESSAGE_LINES);
-      if (timeStamp[tmpread] != 0) {
-        output += formatLine(tmpread, lineEnd);
-      }
-      return !isEmpty();
+  private:
+    uint16_t recordLength(uint32_t pos) {
+      uint16_t linelength;
+      copyOut(pos + 6, &linelength, 2);
+      return linelength;
     }
 
-    bool getAll(String& output, const String& lineEnd) {
-      int tmpread((write_idx + 1) % LOG_STRUCT_MESSAGE_LINES);
-      bool someAdded = false;
-      while (tmpread != write_idx) {
-        if (timeStamp[tmpread] != 0) {
-          output += formatLine(tmpread, lineEnd);
-          someAdded = true;
-        }
-        tmpread = (tmpread + 1)% LOG_STRUCT_MESSAGE_LINES;
-      }
-      return someAdded;
+    // At most 2 memcpy calls, when the data wraps around the end of the buffer.
+    void copyIn(uint32_t pos, const void* data, unsigned int length) {
+      const unsigned int index = pos & LOG_RING_MASK;
+      const unsigned int first = _min(length, LOG_RING_SIZE - index);
+      memcpy(buffer + index, data, first);
+      memcpy(buffer, static_cast<const uint8_t*>(data) + first, length - first);
     }
 
-    bool isEmpty() {
-      return (write_idx == read_idx);
+    void copyOut(uint32_t pos, void* data, unsigned int length) {
+      const unsigned int index = pos & LOG_RING_MASK;
+      const unsigned int first = _min(length, LOG_RING_SIZE - index);
+      memcpy(data, buffer + index, first);
+      memcpy(static_cast<uint8_t*>(data) + first, buffer, length - first);
     }
 
-  private:
-    String formatLine(int index, const String& lineEnd) {
-      String output;
-      output += timeStamp[index];
-      output += " : ";
-      output += Message[index];
-      output += lineEnd;
-      return output;
+    // Positions only increase, the index in the buffer is (position & LOG_RING_MASK).
+    uint32_t head;                   // Where the next record is written
+    uint32_t tail;                   // Oldest record
+    uint32_t cursor[LOG_READER_MAX]; // Next record to read per destination
+    uint8_t buffer[LOG_RING_SIZE];
+};
+
+struct LogStruct {
+    // Add a line for the destinations in the bit mask (1 << LOG_TO_xxx).
+    void add(const byte loglevel, const byte destinations, const char *line) {
+      const unsigned long timestamp = millis();
+      const unsigned int linelength = strlen(line);
+      LOG_BUFFER_LOCK();
+      if (destinations & ~LOG_WEB_DESTINATIONS) {
+        serial.add(timestamp, loglevel, destinations & ~LOG_WEB_DESTINATIONS, line, _min(linelength, LOG_LINE_MAX_SIZE));
+      }
+      if (destinations & LOG_WEB_DESTINATIONS) {
+        web.add(timestamp, loglevel, destinations & LOG_WEB_DESTINATIONS, line, _min(linelength, LOG_STRUCT_MESSAGE_SIZE-1));
+      }
+      LOG_BUFFER_UNLOCK();
+    }
+
+    // Read the next line for the destination, line holds size chars, including the 0.
+    // Returns false when there is no new line.
+    bool read(const byte destination, unsigned long& timestamp, byte& loglevel, char *line, const unsigned int size) {
+      LOG_BUFFER_LOCK();
+      const bool found = ring(destination).read(destination, timestamp, loglevel, line, size);
+      LOG_BUFFER_UNLOCK();
+      return found;
     }
 
-    String logjson_formatLine(int index) {
-      String output;
-      output.reserve(LOG_STRUCT_MESSAGE_SIZE + 64);
-      output = "{";
-      output += to_json_object_value("timestamp", String(timeStamp[index]));
-      output += ",\n";
-      output += to_json_object_value("text",  Message[index]);
-      output += ",\n";
-      output += to_json_object_value("level", String(log_level[index]));
-      output += "}";
-      return output;
+    bool isEmpty(const byte destination) {
+      return ring(destination).isEmpty(destination);
     }
 
+  private:
+    LogRingStruct& ring(const byte destination) {
+      return ((1 << destination) & LOG_WEB_DESTINATIONS) ? web : serial;
+    }
 
-    int write_idx;
-    int read_idx;
-    unsigned long timeStamp[LOG_STRUCT_MESSAGE_LINES];
-    byte log_level[LOG_STRUCT_MESSAGE_LINES];
-    String Message[LOG_STRUCT_MESSAGE_LINES];
+    LogRingStruct serial; // Serial and syslog
+    LogRingStruct web;    // Web log and /events
 
 } Logging;
 
@@ -1214,7 +1408,7 @@ struct ProtocolStruct
 {
   ProtocolStruct() :
     Number(0), usesMQTT(false), usesAccount(false), usesPassword(false),
-    defaultPort(0), usesTemplate(false), usesID(false), Custom(false) {}
+    defaultPort(0), usesTemplate(false), usesID(false), Custom(false), usesBatchSend(false) {}
   byte Number;
   boolean usesMQTT;
   boolean usesAccount;
@@ -1223,8 +1417,45 @@ struct ProtocolStruct
   boolean usesTemplate;
   boolean usesID;
   boolean Custom;
+  boolean usesBatchSend; // CPLUGIN_PROTOCOL_SEND only collects values, CPLUGIN_FLUSH sends them in one request
 } Protocol[CPLUGIN_MAX];
 
+// Task values queued to be sent to the controllers, see queueSendData()
+#define SEND_DATA_QUEUE_MAX            (TASKS_MAX * 2)
+#define SEND_DATA_BATCH_WINDOW_MSEC    500  // Time to collect values for controllers using batch send
+#define SEND_DATA_DEFERRED_MAX         TASKS_MAX // Entries queued while the queue is being processed
+
+struct SendDataEntryStruct {
+  SendDataEntryStruct() : received(0), TaskIndex(0), sensorType(0), controllers(0) {
+    for (byte i = 0; i < VARS_PER_TASK; ++i) {
+      values[i] = 0.0;
+    }
+  }
+
+  unsigned long received;
+  byte TaskIndex;
+  byte sensorType;
+  byte controllers; // Bitmask of controllers this entry still has to be sent to.
+  float values[VARS_PER_TASK];
+};
+
+// Retry of failed controller sends, see processSendResult()
+#define CONTROLLER_SEND_MAX_RETRIES        5
+#define CONTROLLER_RETRY_DELAY_MSEC        1000  // Doubled on every next failure
+#define CONTROLLER_RETRY_DELAY_MAX_MSEC    60000
+
+struct ControllerQueueStruct {
+  ControllerQueueStruct() : lastSend(0), retryAt(0), failures(0), sent(0), dropped(0), retries(0) {}
+
+  unsigned long lastSend;
+  unsigned long retryAt;
+  byte failures;          // Consecutive failed sends
+  unsigned long sent;
+  unsigned long dropped;
+  unsigned long retries;
+};
+ControllerQueueStruct ControllerQueue[CONTROLLER_MAX];
+
 struct NotificationStruct
 {
   NotificationStruct() :
@@ -1291,6 +1522,50 @@ struct RTCStruct
   unsigned long bootCounter;
 } RTC;
 
+// Writes to the settings files since boot, see writeDirtyPages()
+struct FlashWriteStatsStruct
+{
+  FlashWriteStatsStruct() : saves(0), unchanged(0), lastWritten(0), totalWritten(0) {}
+
+  unsigned long saves;
+  unsigned long unchanged;    // Saves not writing anything, the data was already stored
+  unsigned long lastWritten;  // Bytes written by the last save
+  unsigned long totalWritten;
+} flashWriteStats;
+
+struct SettingsJournalRecordStruct
+{
+  uint16_t magic;
+  uint8_t  type;
+  uint8_t  file;    // See getSettingsJournalFile()
+  uint32_t offset;
+  uint16_t length;
+  uint16_t crc;     // Of the record with crc = 0, XOR the CRC of the data
+};
+
+// State of the batch of settings saves not yet committed, see beginSettingsBatch()
+struct SettingsJournalStruct
+{
+  SettingsJournalStruct() : batchDepth(0), records(0), bytes(0), failed(false) {}
+
+  byte batchDepth;
+  unsigned int records;
+  unsigned long bytes;
+  bool failed;
+} settingsJournal;
+
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+// config.dat in a data partition, reads are done from the mapped flash, see settingsPartitionInit()
+struct SettingsPartitionStruct
+{
+  SettingsPartitionStruct() : partition(nullptr), data(nullptr), handle(0) {}
+
+  const esp_partition_t* partition;
+  const byte* data;
+  spi_flash_mmap_handle_t handle;
+} settingsPartition;
+#endif
+
 
 int deviceCount = -1;
 int protocolCount = -1;
@@ -1470,6 +1745,174 @@ bool firstLoop=true;
 
 boolean activeRuleSets[RULESETS_MAX];
 
+// Rules sets are kept in RAM, with their "on ... do" blocks indexed on the event name.
+// Only when there is not enough free memory, the rules file is read for every event.
+#define RULES_CACHE_MIN_FREE_MEM         8000 // Minimum free memory left after caching a rules set.
+
+struct RulesBlockStruct
+{
+  RulesBlockStruct() : eventNameHash(0), alwaysCheck(false), start(0), end(0) {}
+
+  uint16_t eventNameHash; // Hash of the lower case event name in the "on" line.
+  boolean  alwaysCheck;   // Wildcard or templated event name, must be checked for every event.
+  uint16_t start;         // Offset of the "on" line in RulesSetCacheStruct::lines
+  uint16_t end;           // Offset just past the last line of the block.
+};
+
+struct RulesSetCacheStruct
+{
+  RulesSetCacheStruct() : cached(false) {}
+
+  void clear() {
+    cached = false;
+    lines = String();
+    blocks.clear();
+  }
+
+  boolean cached;
+  String  lines;  // All non-comment lines of the blocks, each terminated with '\n'
+  std::vector<RulesBlockStruct> blocks;
+} rulesSetCache[RULESETS_MAX];
+
+// Compiled custom .esp pages, see handle_custom()
+#define CUSTOM_PAGE_CACHE_MAX            2
+#define CUSTOM_PAGE_PLACEHOLDER_MAX      32  // Max. length of a %..%, {..} or &..; placeholder
+
+struct CustomPagePlaceholderStruct
+{
+  CustomPagePlaceholderStruct(uint16_t s, uint16_t l) : start(s), length(l) {}
+
+  uint16_t start;   // Offset in the file
+  uint16_t length;
+};
+
+struct CustomPageCacheStruct
+{
+  CustomPageCacheStruct() : size(0), lastUsed(0) {}
+
+  void clear() {
+    path = String();
+    size = 0;
+    placeholders.clear();
+  }
+
+  String path;
+  size_t size;             // File size when compiled
+  unsigned long lastUsed;
+  // The text in between the placeholders is streamed from the file as is.
+  std::vector<CustomPagePlaceholderStruct> placeholders;
+} customPageCache[CUSTOM_PAGE_CACHE_MAX];
+
+// Content hash ETags of files on SPIFFS, see getFileETag()
+#define FILE_ETAG_CACHE_MAX              8
+
+struct FileETagCacheStruct
+{
+  FileETagCacheStruct() : size(0), hash(0) {}
+
+  String path;
+  size_t size;
+  uint32_t hash;
+} fileETagCache[FILE_ETAG_CACHE_MAX];
+byte fileETagCacheNext = 0; // Next entry to replace
+
+// Subscribers of the /events push channel (Server-Sent Events), see handle_events()
+// These are served concurrently, next to the one request handled by the web server.
+#ifndef EVENT_STREAM_CLIENTS_MAX
+  #if defined(ESP32)
+    #define EVENT_STREAM_CLIENTS_MAX     4
+  #else
+    #define EVENT_STREAM_CLIENTS_MAX     2
+  #endif
+#endif
+#define EVENT_STREAM_BUFFER_MAX          1024  // Max. pending output per client, new events are dropped when full
+#define EVENT_STREAM_STALL_TIMEOUT_MSEC  10000 // Disconnect a client not accepting any data for this long
+#define EVENT_STREAM_KEEPALIVE_MSEC      15000
+#define EVENT_STREAM_MIN_FREE_HEAP       8000  // Refuse new subscribers below this amount of free heap
+
+struct EventStreamClientStruct
+{
+  EventStreamClientStruct() : active(false), lastWrite(0), stalledSince(0), sent(0), dropped(0) {}
+
+  bool active;
+  WiFiClient client;
+  String pending;             // Formatted events not yet accepted by the client
+  unsigned long lastWrite;
+  unsigned long stalledSince; // 0 when the client accepts data
+  unsigned long sent;         // Events queued for this client
+  unsigned long dropped;      // Events dropped since the client could not keep up
+} eventStreamClients[EVENT_STREAM_CLIENTS_MAX];
+byte eventStreamClientCount = 0;
+
+#ifdef ESP32
+// Task values set on another RTOS task, pushed from the main loop, see eventStreamTaskValues()
+uint32_t eventStreamPendingTasks = 0; // Bit per task
+float eventStreamPendingValues[TASKS_MAX][VARS_PER_TASK];
+portMUX_TYPE eventStreamPendingMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+// Responses of /json and files, sent from the loop interleaved with the scheduler
+// and the other clients, see handleWebStreams()
+#ifndef WEB_STREAMS_MAX
+  #if defined(ESP32)
+    #define WEB_STREAMS_MAX              4
+  #else
+    #define WEB_STREAMS_MAX              2
+  #endif
+#endif
+#define WEB_STREAM_STALL_TIMEOUT_MSEC    10000 // Disconnect a client not accepting any data for this long
+#define WEB_STREAM_MIN_FREE_HEAP         8000  // Below this amount of free heap the response is sent blocking
+#define WEB_STREAM_BLOCK_SIZE            512   // Max. bytes of a file written per loop
+
+#define WEB_STREAM_NONE                  0
+#define WEB_STREAM_JSON                  1
+#define WEB_STREAM_FILE                  2
+#define WEB_STREAM_DATA                  3     // Data in RAM or mapped flash
+
+// Sections of the /json page, see addJsonPageSection()
+#define JSON_PAGE_SYSTEM                 0
+#define JSON_PAGE_WIFI                   1
+#define JSON_PAGE_NODES                  2
+#define JSON_PAGE_TASKS                  3     // One section per task
+#define JSON_PAGE_END                    4
+#define JSON_PAGE_DONE                   5
+
+struct JsonPageStruct
+{
+  JsonPageStruct() : section(JSON_PAGE_SYSTEM), nextTask(0), lastTask(TASKS_MAX - 1),
+    showSpecificTask(false), showSystem(true), showWifi(true), showNodes(true),
+    showDataAcquisition(true), showTaskDetails(true), commaBetween(false), since(0), ttl(60) {}
+
+  byte section;
+  byte nextTask;
+  byte lastTask;
+  bool showSpecificTask;
+  bool showSystem;
+  bool showWifi;
+  bool showNodes;
+  bool showDataAcquisition;
+  bool showTaskDetails;
+  bool commaBetween;          // A task was added to "Sensors"
+  unsigned long since;        // Only tasks changed after this data version
+  unsigned long ttl;          // The shortest interval of the enabled tasks with values in seconds
+};
+
+struct WebStreamStruct
+{
+  WebStreamStruct() : type(WEB_STREAM_NONE), data(nullptr), remaining(0), lastWrite(0), stalledSince(0) {}
+
+  byte type;
+  WiFiClient client;
+  String pending;             // Generated part of the response not yet accepted by the client
+  JsonPageStruct json;        // WEB_STREAM_JSON
+  fs::File file;              // WEB_STREAM_FILE
+  const uint8_t* data;        // WEB_STREAM_DATA
+  size_t remaining;
+  unsigned long lastWrite;
+  unsigned long stalledSince; // 0 when the client accepts data
+} webStreams[WEB_STREAMS_MAX];
+byte webStreamCount = 0;
+
 boolean       UseRTOSMultitasking;
 
 void (*MainLoopCall_ptr)(void);
@@ -1536,6 +1979,109 @@ String getLogLine(const TimingStats& stats) {
     return log;
 }
 
+// Latency histogram with one bucket per power of 2 usec.
+// Bucket 0 holds all below 16 usec, the last bucket all from 2^22 usec (~4 sec).
+#define TIMING_HISTOGRAM_BUCKETS  20
+
+class TimingHistogram {
+    public:
+      TimingHistogram() {
+          reset();
+      }
+
+      void add(unsigned long time) {
+          const byte bucket = getBucket(time);
+          if (_buckets[bucket] == 0xFFFF) {
+              // Keep the distribution, but halve the weight of older samples.
+              for (byte i = 0; i < TIMING_HISTOGRAM_BUCKETS; ++i) {
+                  _buckets[i] = (_buckets[i] + 1) / 2;
+              }
+          }
+          ++_buckets[bucket];
+          _timeTotal += time;
+          ++_count;
+          if (time > _maxVal) _maxVal = time;
+      }
+
+      void reset() {
+          for (byte i = 0; i < TIMING_HISTOGRAM_BUCKETS; ++i) {
+              _buckets[i] = 0;
+          }
+          _timeTotal = 0.0;
+          _count = 0;
+          _maxVal = 0;
+      }
+
+      bool isEmpty() const {
+          return _count == 0;
+      }
+
+      unsigned long getCount() const {
+          return _count;
+      }
+
+      float getAvg() const {
+        if (_count == 0) return 0.0;
+        return _timeTotal / _count;
+      }
+
+      unsigned long getMax() const {
+          return _maxVal;
+      }
+
+      // Upper bound of the bucket holding the given percentile, never more than the max.
+      unsigned long getPercentile(byte percentile) const {
+          unsigned long total = 0;
+          for (byte i = 0; i < TIMING_HISTOGRAM_BUCKETS; ++i) {
+              total += _buckets[i];
+          }
+          if (total == 0) return 0;
+          const unsigned long threshold = (total * percentile + 99) / 100;
+          unsigned long cumulative = 0;
+          for (byte i = 0; i < (TIMING_HISTOGRAM_BUCKETS - 1); ++i) {
+              cumulative += _buckets[i];
+              if (cumulative >= threshold) {
+                  const unsigned long upper = (1ul << (i + 4)) - 1;
+                  return upper < _maxVal ? upper : _maxVal;
+              }
+          }
+          return _maxVal;
+      }
+
+    private:
+      static byte getBucket(unsigned long time) {
+          if (time < 16) return 0;
+          // Highest bit set: 4 for 16..31 usec
+          byte bit = 31 - __builtin_clz(static_cast<uint32_t>(time));
+          byte bucket = bit - 3;
+          return bucket < TIMING_HISTOGRAM_BUCKETS ? bucket : (TIMING_HISTOGRAM_BUCKETS - 1);
+      }
+
+      uint16_t _buckets[TIMING_HISTOGRAM_BUCKETS];
+      float _timeTotal;
+      unsigned long _count;
+      unsigned long _maxVal;
+};
+
+String getLogLine(const TimingHistogram& stats) {
+    String log;
+    log.reserve(80);
+    log += F("Count: ");
+    log += stats.getCount();
+    log += F(" Avg/p50/p90/p99/max ");
+    log += stats.getAvg();
+    log += '/';
+    log += stats.getPercentile(50);
+    log += '/';
+    log += stats.getPercentile(90);
+    log += '/';
+    log += stats.getPercentile(99);
+    log += '/';
+    log += stats.getMax();
+    log += F(" usec");
+    return log;
+}
+
 
 
 String getPluginFunctionName(int function) {
@@ -1570,39 +2116,72 @@ String getPluginFunctionName(int function) {
     return F("Unknown");
 }
 
-bool mustLogFunction(int function) {
+// Index of the plugin function in the plugin statistics, or -1 when not logged.
+#define PLUGIN_STATS_FUNCTIONS  10
+int getPluginStatsFunctionIndex(int function) {
     switch(function) {
-        case PLUGIN_INIT_ALL:              return false;
-        case PLUGIN_INIT:                  return false;
-        case PLUGIN_READ:                  return true;
-        case PLUGIN_ONCE_A_SECOND:         return true;
-        case PLUGIN_TEN_PER_SECOND:        return true;
-        case PLUGIN_DEVICE_ADD:            return false;
-        case PLUGIN_EVENTLIST_ADD:         return false;
-        case PLUGIN_WEBFORM_SAVE:          return false;
-        case PLUGIN_WEBFORM_LOAD:          return false;
-        case PLUGIN_WEBFORM_SHOW_VALUES:   return false;
-        case PLUGIN_GET_DEVICENAME:        return false;
-        case PLUGIN_GET_DEVICEVALUENAMES:  return false;
-        case PLUGIN_WRITE:                 return true;
-        case PLUGIN_EVENT_OUT:             return true;
-        case PLUGIN_WEBFORM_SHOW_CONFIG:   return false;
-        case PLUGIN_SERIAL_IN:             return true;
-        case PLUGIN_UDP_IN:                return true;
-        case PLUGIN_CLOCK_IN:              return false;
-        case PLUGIN_TIMER_IN:              return true;
-        case PLUGIN_FIFTY_PER_SECOND:      return true;
-        case PLUGIN_SET_CONFIG:            return false;
-        case PLUGIN_GET_DEVICEGPIONAMES:   return false;
-        case PLUGIN_EXIT:                  return false;
-        case PLUGIN_GET_CONFIG:            return false;
-        case PLUGIN_UNCONDITIONAL_POLL:    return false;
-        case PLUGIN_REQUEST:               return true;
+        case PLUGIN_READ:                  return 0;
+        case PLUGIN_ONCE_A_SECOND:         return 1;
+        case PLUGIN_TEN_PER_SECOND:        return 2;
+        case PLUGIN_FIFTY_PER_SECOND:      return 3;
+        case PLUGIN_WRITE:                 return 4;
+        case PLUGIN_EVENT_OUT:             return 5;
+        case PLUGIN_SERIAL_IN:             return 6;
+        case PLUGIN_UDP_IN:                return 7;
+        case PLUGIN_TIMER_IN:              return 8;
+        case PLUGIN_REQUEST:               return 9;
     }
-    return false;
+    return -1;
+}
+
+bool mustLogFunction(int function) {
+    return getPluginStatsFunctionIndex(function) >= 0;
 }
 
-std::map<int,TimingStats> pluginStats;
+// Latency histograms per task and plugin function.
+// Histograms are taken from a fixed pool on first use, since only a few functions are used per task.
+#ifndef PLUGIN_STATS_MAX
+  #if defined(ESP32)
+    #define PLUGIN_STATS_MAX  64
+  #else
+    #define PLUGIN_STATS_MAX  32
+  #endif
+#endif
+
+struct PluginStatsStruct {
+  PluginStatsStruct() : nrUsed(0), dropped(0) {
+    for (byte task = 0; task < TASKS_MAX; ++task) {
+      for (byte f = 0; f < PLUGIN_STATS_FUNCTIONS; ++f) {
+        index[task][f] = 0;
+      }
+    }
+  }
+
+  void add(byte TaskIndex, int function, unsigned long time) {
+    const int f = getPluginStatsFunctionIndex(function);
+    if (f < 0 || TaskIndex >= TASKS_MAX) return;
+    byte slot = index[TaskIndex][f];
+    if (slot == 0) {
+      if (nrUsed >= PLUGIN_STATS_MAX) {
+        ++dropped;
+        return;
+      }
+      taskIndex[nrUsed] = TaskIndex;
+      pluginFunction[nrUsed] = function;
+      ++nrUsed;
+      slot = nrUsed;
+      index[TaskIndex][f] = slot;
+    }
+    stats[slot - 1].add(time);
+  }
+
+  byte index[TASKS_MAX][PLUGIN_STATS_FUNCTIONS]; // Slot in stats + 1, 0 = not used yet
+  TimingHistogram stats[PLUGIN_STATS_MAX];
+  byte taskIndex[PLUGIN_STATS_MAX];
+  byte pluginFunction[PLUGIN_STATS_MAX];
+  byte nrUsed;
+  unsigned long dropped;
+} pluginStats;
 std::map<int,TimingStats> miscStats;
 unsigned long timediff_calls = 0;
 unsigned long timediff_cpu_cycles_total = 0;
@@ -1619,13 +2198,14 @@ unsigned long timediff_cpu_cycles_total = 0;
 #define PROC_SYS_TIMER        9
 #define SET_NEW_TIMER        10
 #define TIME_DIFF_COMPUTE    11
+#define RULES_PROCESSING     12
 
 
 
 
 
 #define START_TIMER const unsigned statisticsTimerStart(micros());
-#define STOP_TIMER_TASK(T,F)  if (mustLogFunction(F)) pluginStats[T*32 + F].add(usecPassedSince(statisticsTimerStart));
+#define STOP_TIMER_TASK(T,F)  if (mustLogFunction(F)) pluginStats.add(T, F, usecPassedSince(statisticsTimerStart));
 #define STOP_TIMER_LOADFILE miscStats[LOADFILE_STATS].add(usecPassedSince(statisticsTimerStart));
 #define STOP_TIMER(L)       miscStats[L].add(usecPassedSince(statisticsTimerStart));
 
@@ -1644,6 +2224,7 @@ String getMiscStatsName(int stat) {
         case PROC_SYS_TIMER:        return F("proc_system_timer() ");
         case SET_NEW_TIMER:         return F("setNewTimerAt()     ");
         case TIME_DIFF_COMPUTE:     return F("timeDiff()          ");
+        case RULES_PROCESSING:      return F("rulesProcessing()   ");
     }
     return F("Unknown");
 }
@@ -113,6 +113,7 @@ void setup()
 
   checkRAM(F("setup"));
   #if defined(ESP32)
+    mainLoopTaskHandle = xTaskGetCurrentTaskHandle();
     for(byte x = 0; x < 16; x++)
       ledChannelPin[x] = -1;
   #endif
@@ -489,12 +490,37 @@ void loop()
       String event = F("System#Sleep");
       rulesProcessing(event);
     }
-    // Flush outstanding MQTT messages
+    // Send queued task values and flush outstanding MQTT messages
+    flushSendDataQueue();
     runPeriodicalMQTT();
 
     deepSleep(Settings.Delay);
     //deepsleep will never return, its a special kind of reboot
   }
+
+  idleSleep();
+}
+
+/*********************************************************************************************\
+ * Sleep until the next scheduled timer is due, when there is nothing else to do.
+ * The core's delay() lets the WiFi stack run and the CPU idle meanwhile.
+ * Serial input ends the sleep early, other (network) input is handled after at most IDLE_SLEEP_MAX_MSEC.
+ * The time spent here is counted as idle time in getCPUload().
+\*********************************************************************************************/
+void idleSleep() {
+  if (MainLoopCall_ptr || isDeepSleepEnabled() || wifiSetupConnect) return;
+  if (!systemEventQueueEmpty()) return;
+  if (!processedConnect || !processedDisconnect || !processedGetIP ||
+      !processedConnectAPmode || !processedDisconnectAPmode || !processedScanDone) return;
+  long sleepTime = msecTimerHandler.msecUntilNextTimer();
+  if (sleepTime <= 0) return;
+  if (sleepTime > IDLE_SLEEP_MAX_MSEC) sleepTime = IDLE_SLEEP_MAX_MSEC;
+  msecTimerHandler.setIdle();
+  const unsigned long wakeup = millis() + sleepTime;
+  while (!timeOutReached(wakeup)) {
+    if (Settings.UseSerial && Serial.available()) return;
+    delay(1);
+  }
 }
 
 bool checkConnectionsEstablished() {
@@ -684,7 +710,7 @@ void logTimerStatistics() {
   updateLoopStats_30sec(loglevel);
   logStatistics(loglevel, true);
   if (loglevelActiveFor(loglevel)) {
-    String queueLog = F("Scheduler stats: (called/tasks/max_length/idle%) ");
+    String queueLog = F("Scheduler stats: (called/tasks/max_length/idle%/dropped) ");
     queueLog += msecTimerHandler.getQueueStats();
     addLog(loglevel, queueLog);
   }
@@ -775,14 +801,10 @@ void SensorSendTask(byte TaskIndex)
       {
         if (ExtraTaskSettings.TaskDeviceFormula[varNr][0] != 0)
         {
-          String spreValue = String(preValue[varNr]);
-          String formula = ExtraTaskSettings.TaskDeviceFormula[varNr];
-          float value = UserVar[varIndex + varNr];
           float result = 0;
-          String svalue = String(value);
-          formula.replace(F("%pvalue%"), spreValue);
-          formula.replace(F("%value%"), svalue);
-          byte error = Calculate(formula.c_str(), &result);
+          byte error = calculateTaskFormula(
+            TaskIndex, varNr, ExtraTaskSettings.TaskDeviceFormula[varNr],
+            UserVar[varIndex + varNr], preValue[varNr], &result);
           if (error == 0)
             UserVar[varIndex + varNr] = result;
         }
@@ -823,6 +845,12 @@ void backgroundtasks()
     WebServer.handleClient();
     checkUDP();
   }
+  // Log lines not yet written to serial
+  processLogReaders();
+  // Push pending task values and log lines to /events subscribers
+  handleEventStreams();
+  // Send the next part of /json and file responses
+  handleWebStreams();
 
   // process DNS, only used if the ESP has no valid WiFi config
   if (dnsServerActive)
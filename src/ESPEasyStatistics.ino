@@ -2,23 +2,27 @@ void logStatistics(byte loglevel, bool clearLog) {
   if (loglevelActiveFor(loglevel)) {
     String log;
     log.reserve(80);
-    for (auto& x: pluginStats) {
-        if (!x.second.isEmpty()) {
-            const int pluginId = x.first/32;
-            String P_name = "";
-            Plugin_ptr[pluginId](PLUGIN_GET_DEVICENAME, NULL, P_name);
-            log = F("PluginStats P_");
-            log += pluginId + 1;
+    for (byte slot = 0; slot < pluginStats.nrUsed; ++slot) {
+        TimingHistogram& stats = pluginStats.stats[slot];
+        if (!stats.isEmpty()) {
+            const byte taskIndex = pluginStats.taskIndex[slot];
+            log = F("PluginStats T_");
+            log += taskIndex + 1;
             log += '_';
-            log += P_name;
+            log += getPluginNameFromDeviceIndex(getDeviceIndex(Settings.TaskDeviceNumber[taskIndex]));
             log += ' ';
-            log += getPluginFunctionName(x.first%32);
+            log += getPluginFunctionName(pluginStats.pluginFunction[slot]);
             log += ' ';
-            log += getLogLine(x.second);
+            log += getLogLine(stats);
             addLog(loglevel, log);
-            if (clearLog) x.second.reset();
+            if (clearLog) stats.reset();
         }
     }
+    if (pluginStats.dropped != 0) {
+        log = F("PluginStats dropped (no free slot): ");
+        log += pluginStats.dropped;
+        addLog(loglevel, log);
+    }
     for (auto& x: miscStats) {
         if (!x.second.isEmpty()) {
             log = getMiscStatsName(x.first);
@@ -28,6 +32,20 @@ void logStatistics(byte loglevel, bool clearLog) {
             if (clearLog) x.second.reset();
         }
     }
+    {
+      const long duration = timePassedSince(taskSettingsCacheStats.start);
+      log = F("Task settings cache stats: Hits: ");
+      log += taskSettingsCacheStats.hits;
+      log += F(" Misses: ");
+      log += taskSettingsCacheStats.misses;
+      log += F(" - File loads per minute: ");
+      if (duration > 0)
+        log += static_cast<float>(taskSettingsCacheStats.fileLoads) * 60000.0 / static_cast<float>(duration);
+      else
+        log += taskSettingsCacheStats.fileLoads;
+      addLog(loglevel, log);
+      if (clearLog) taskSettingsCacheStats.reset();
+    }
     log = getMiscStatsName(TIME_DIFF_COMPUTE);
     log += F(" stats: Count: ");
     log += timediff_calls;
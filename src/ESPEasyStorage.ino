@@ -25,7 +25,7 @@ void flashCount()
   saveToRTC();
 }
 
-String flashGuard()
+String flashGuardCheck()
 {
   checkRAM(F("flashGuard"));
   if (RTC.flashDayCounter > MAX_FLASHWRITES_PER_DAY)
@@ -34,12 +34,45 @@ String flashGuard()
     addLog(LOG_LEVEL_ERROR, log);
     return log;
   }
+  return(String());
+}
+
+String flashGuard()
+{
+  String err = flashGuardCheck();
+  if (err.length())
+    return err;
   flashCount();
   return(String());
 }
 
 //use this in function that can return an error string. it automaticly returns with an error string if there where too many flash writes.
 #define FLASH_GUARD() { String flashErr=flashGuard(); if (flashErr.length()) return(flashErr); }
+// Same, but the write is only counted when data was actually written, see updateFlashWriteStats()
+#define FLASH_GUARD_CHECK() { String flashErr=flashGuardCheck(); if (flashErr.length()) return(flashErr); }
+
+// Saves only count as a flash write when something differed from the stored data.
+void updateFlashWriteStats(const char* fname, int written, int datasize)
+{
+  ++flashWriteStats.saves;
+  flashWriteStats.lastWritten = written;
+  flashWriteStats.totalWritten += written;
+  if (written == 0) {
+    ++flashWriteStats.unchanged;
+  } else {
+    flashCount();
+  }
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    String log = F("FILE : Saved ");
+    log += fname;
+    log += F(", written ");
+    log += written;
+    log += F(" of ");
+    log += datasize;
+    log += F(" bytes");
+    addLog(LOG_LEVEL_INFO, log);
+  }
+}
 
 /********************************************************************************************\
   Fix stuff to clear out differences between releases
@@ -93,6 +126,9 @@ void fileSystemCheck()
 {
   checkRAM(F("fileSystemCheck"));
   addLog(LOG_LEVEL_INFO, F("FS   : Mounting..."));
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    const bool partitionMapped = settingsPartitionInit();
+  #endif
   if (SPIFFS.begin())
   {
     #if defined(ESP8266)
@@ -108,12 +144,22 @@ void fileSystemCheck()
       }
     #endif
 
+    #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+      if (partitionMapped) {
+        // An erased partition gets the config.dat of an earlier SPIFFS install, if present.
+        if (settingsPartitionErased() && !settingsPartitionImport())
+          ResetFactory();
+        recoverSettingsJournal();
+        return;
+      }
+    #endif
     fs::File f = SPIFFS.open(FILE_CONFIG, "r");
     if (!f)
     {
       ResetFactory();
     }
     f.close();
+    recoverSettingsJournal();
   }
   else
   {
@@ -136,21 +182,29 @@ String SaveSettings(void)
 
   Settings.StructSize = sizeof(struct SettingsStruct);
 
-  // FIXME @TD-er: As discussed in #1292, the CRC for the settings is now disabled.
-/*
-  memcpy( Settings.ProgmemMd5, CRCValues.runTimeMD5, 16);
+  // The MD5 is not part of SettingsStruct (see #1292), but stored at the end of its area in the file.
+  // Only the changed pages are written, so saving unchanged settings does not write at all.
+  FLASH_GUARD_CHECK();
   md5.begin();
-  md5.add((uint8_t *)&Settings, sizeof(Settings)-16);
+  md5.add((uint8_t *)&Settings, sizeof(Settings));
   md5.calculate();
   md5.getBytes(tmp_md5);
-  if (memcmp(tmp_md5, Settings.md5, 16) != 0) {
-    // Settings have changed, save to file.
-    memcpy(Settings.md5, tmp_md5, 16);
-*/
-    err=SaveToFile((char*)FILE_CONFIG, 0, (byte*)&Settings, sizeof(Settings));
-    if (err.length())
-     return(err);
-//  }
+  int written = 0;
+  int md5Written = 0;
+  // Settings and MD5 are committed together.
+  beginSettingsBatch();
+  err=writeToFile((char*)FILE_CONFIG, 0, (byte*)&Settings, sizeof(Settings), written);
+  if (!err.length() && sizeof(Settings) <= DAT_BASIC_SETTINGS_MD5_OFFSET)
+    err=writeToFile((char*)FILE_CONFIG, DAT_BASIC_SETTINGS_MD5_OFFSET, tmp_md5, 16, md5Written);
+  String commitErr = commitSettingsBatch();
+  if (err.length())
+    return(err);
+  if (commitErr.length())
+    return(commitErr);
+  updateFlashWriteStats(FILE_CONFIG, written + md5Written, sizeof(Settings) + 16);
+  // Task device numbers may have changed.
+  invalidateTaskValueIndex();
+  touchTaskDataVersions();
 
   memcpy( SecuritySettings.ProgmemMd5, CRCValues.runTimeMD5, 16);
   md5.begin();
@@ -183,23 +237,25 @@ String LoadSettings()
   if (err.length())
     return(err);
 
-    // FIXME @TD-er: As discussed in #1292, the CRC for the settings is now disabled.
-/*
-  if (Settings.StructSize > 16) {
+  if (sizeof(Settings) <= DAT_BASIC_SETTINGS_MD5_OFFSET) {
+    uint8_t storedMd5[16];
+    err=LoadFromFile((char*)FILE_CONFIG, DAT_BASIC_SETTINGS_MD5_OFFSET, storedMd5, 16);
+    if (err.length())
+      return(err);
     md5.begin();
-    md5.add((uint8_t *)&Settings, Settings.StructSize -16);
+    md5.add((uint8_t *)&Settings, sizeof(Settings));
     md5.calculate();
     md5.getBytes(calculatedMd5);
+    const uint8_t notSet[16] = {0};
+    if (memcmp(calculatedMd5, storedMd5, 16) == 0) {
+      addLog(LOG_LEVEL_INFO,  F("CRC  : Settings CRC           ...OK"));
+    } else if (memcmp(storedMd5, notSet, 16) == 0) {
+      // Saved by a version without the MD5, it will be stored with the next save.
+      addLog(LOG_LEVEL_INFO,  F("CRC  : Settings CRC           ...not set"));
+    } else {
+      addLog(LOG_LEVEL_ERROR, F("CRC  : Settings CRC           ...FAIL"));
+    }
   }
-  if (memcmp (calculatedMd5, Settings.md5,16)==0){
-    addLog(LOG_LEVEL_INFO,  F("CRC  : Settings CRC           ...OK"));
-    if (memcmp(Settings.ProgmemMd5, CRCValues.runTimeMD5, 16)!=0)
-      addLog(LOG_LEVEL_INFO, F("CRC  : binary has changed since last save of Settings"));
-  }
-  else{
-    addLog(LOG_LEVEL_ERROR, F("CRC  : Settings CRC           ...FAIL"));
-  }
-*/
 
   err=LoadFromFile((char*)FILE_SECURITY, 0, (byte*)&SecuritySettings, sizeof( SecurityStruct));
   md5.begin();
@@ -216,6 +272,10 @@ String LoadSettings()
   }
   setUseStaticIP(useStaticIP());
   ExtraTaskSettings.clear(); // make sure these will not contain old settings.
+  clearTaskSettingsCache();
+  clearTaskFormulas();
+  invalidateControllerSettingsCache();
+  touchTaskDataVersions();
   return(err);
 }
 
@@ -322,6 +382,13 @@ String SaveTaskSettings(byte TaskIndex)
   if (ExtraTaskSettings.TaskIndex != TaskIndex)
     return F("SaveTaskSettings taskIndex does not match");
   String err = SaveToFile(TaskSettings_Type, TaskIndex, (char*)FILE_CONFIG, (byte*)&ExtraTaskSettings, sizeof(struct ExtraTaskSettingsStruct));
+  // Formulas may have changed, compile again on next use.
+  clearTaskFormulas(TaskIndex);
+  if (err.length() == 0)
+    updateTaskSettingsCache();
+  else
+    clearTaskSettingsCache(TaskIndex);
+  touchTaskDataVersion(TaskIndex);
   if (err.length() == 0)
     err = checkTaskSettings(TaskIndex);
   return err;
@@ -352,11 +419,198 @@ String LoadTaskSettings(byte TaskIndex)
     //the plugin call should populate ExtraTaskSettings with its default values.
     PluginCall(PLUGIN_GET_DEVICEVALUENAMES, &TempEvent, dummyString);
   }
+  if (result.length() == 0)
+    updateTaskSettingsCache();
 
   return result;
 }
 
 
+/********************************************************************************************\
+  Keep the most used fields of ExtraTaskSettings of all tasks in RAM
+  \*********************************************************************************************/
+void updateTaskSettingsCache()
+{
+  updateTaskSettingsCache(ExtraTaskSettings);
+}
+
+void updateTaskSettingsCache(const ExtraTaskSettingsStruct& taskSettings)
+{
+  const byte TaskIndex = taskSettings.TaskIndex;
+  if (TaskIndex >= TASKS_MAX)
+    return;
+  TaskSettingsCacheStruct& cache = TaskSettingsCache[TaskIndex];
+  if (!cache.loaded || cache.TaskDeviceName != taskSettings.TaskDeviceName)
+    invalidateTaskValueIndex();
+  cache.TaskDeviceName = taskSettings.TaskDeviceName;
+  for (byte varNr = 0; varNr < VARS_PER_TASK; ++varNr) {
+    if (cache.TaskDeviceValueNames[varNr] != taskSettings.TaskDeviceValueNames[varNr])
+      invalidateTaskValueIndex();
+    cache.TaskDeviceValueNames[varNr] = taskSettings.TaskDeviceValueNames[varNr];
+    cache.TaskDeviceValueDecimals[varNr] = taskSettings.TaskDeviceValueDecimals[varNr];
+  }
+  cache.loaded = true;
+}
+
+void clearTaskSettingsCache(byte TaskIndex)
+{
+  if (TaskIndex < TASKS_MAX)
+    TaskSettingsCache[TaskIndex].clear();
+  invalidateTaskValueIndex();
+}
+
+void clearTaskSettingsCache()
+{
+  for (byte x = 0; x < TASKS_MAX; ++x)
+    TaskSettingsCache[x].clear();
+  invalidateTaskValueIndex();
+}
+
+// Get the cached settings of a task, without changing ExtraTaskSettings.
+// TaskIndex must be < TASKS_MAX
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex)
+{
+  TaskSettingsCacheStruct& cache = TaskSettingsCache[TaskIndex];
+  if (cache.loaded) {
+    ++taskSettingsCacheStats.hits;
+    return cache;
+  }
+  ++taskSettingsCacheStats.misses;
+  if (ExtraTaskSettings.TaskIndex == TaskIndex) {
+    updateTaskSettingsCache();
+    return cache;
+  }
+  // Read into a separate struct, ExtraTaskSettings may hold changes not yet saved.
+  ExtraTaskSettingsStruct* taskSettings = new ExtraTaskSettingsStruct();
+  if (taskSettings == nullptr)
+    return cache;
+  String result = LoadFromFile(TaskSettings_Type, TaskIndex, (char*)FILE_CONFIG, (byte*)taskSettings, sizeof(struct ExtraTaskSettingsStruct));
+  taskSettings->TaskIndex = TaskIndex;
+  if (result.length() == 0) {
+    if (taskSettings->TaskDeviceValueNames[0][0] == 0)
+      getDefaultTaskValueNames(*taskSettings);
+    updateTaskSettingsCache(*taskSettings);
+  }
+  delete taskSettings;
+  return cache;
+}
+
+// The plugin writes its default value names into ExtraTaskSettings.
+// Only the value names and the task index of ExtraTaskSettings are used for that, both are restored.
+void getDefaultTaskValueNames(ExtraTaskSettingsStruct& taskSettings)
+{
+  const byte loadedTaskIndex = ExtraTaskSettings.TaskIndex;
+  const size_t namesSize = sizeof(ExtraTaskSettings.TaskDeviceValueNames);
+  char loadedNames[VARS_PER_TASK][NAME_FORMULA_LENGTH_MAX + 1];
+  memcpy(loadedNames, ExtraTaskSettings.TaskDeviceValueNames, namesSize);
+  memcpy(ExtraTaskSettings.TaskDeviceValueNames, taskSettings.TaskDeviceValueNames, namesSize);
+
+  struct EventStruct TempEvent;
+  TempEvent.TaskIndex = taskSettings.TaskIndex;
+  String dummyString;
+  PluginCall(PLUGIN_GET_DEVICEVALUENAMES, &TempEvent, dummyString);
+
+  memcpy(taskSettings.TaskDeviceValueNames, ExtraTaskSettings.TaskDeviceValueNames, namesSize);
+  memcpy(ExtraTaskSettings.TaskDeviceValueNames, loadedNames, namesSize);
+  ExtraTaskSettings.TaskIndex = loadedTaskIndex;
+}
+
+// Case insensitive hash (FNV-1a) of "taskName#valueName"
+uint32_t taskValueNameHash(const String& taskName, const String& valueName)
+{
+  uint32_t hash = addToTaskValueNameHash(2166136261UL, taskName.c_str());
+  hash = (hash ^ '#') * 16777619UL;
+  return addToTaskValueNameHash(hash, valueName.c_str());
+}
+
+uint32_t addToTaskValueNameHash(uint32_t hash, const char* name)
+{
+  for (; *name != 0; ++name) {
+    uint8_t c = *name;
+    // Only ASCII, same as tolower() but without the locale lookup.
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    hash ^= c;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+void invalidateTaskValueIndex()
+{
+  TaskValueIndex.valid = false;
+  // Task and value names (or unit name, idx) have changed, these are part of the MQTT topics.
+  invalidateMQTTTopicCache();
+}
+
+// Index of all "task#value" names, sorted on hash.
+// Entries with equal hash keep the task order, so the first task wins, like a linear scan.
+void updateTaskValueIndex()
+{
+  byte nrEntries = 0;
+  for (byte x = 0; x < TASKS_MAX; ++x) {
+    if (Settings.TaskDeviceNumber[x] == 0)
+      continue;
+    const TaskSettingsCacheStruct& cache = getTaskSettingsCache(x);
+    if (cache.TaskDeviceName.length() == 0)
+      continue;
+    for (byte z = 0; z < VARS_PER_TASK; ++z) {
+      if (cache.TaskDeviceValueNames[z].length() == 0)
+        continue;
+      const uint32_t hash = taskValueNameHash(cache.TaskDeviceName, cache.TaskDeviceValueNames[z]);
+      // Insertion sort, the index is small.
+      byte pos = nrEntries;
+      while (pos > 0 && TaskValueIndex.hash[pos - 1] > hash) {
+        TaskValueIndex.hash[pos] = TaskValueIndex.hash[pos - 1];
+        TaskValueIndex.taskVar[pos] = TaskValueIndex.taskVar[pos - 1];
+        --pos;
+      }
+      TaskValueIndex.hash[pos] = hash;
+      TaskValueIndex.taskVar[pos] = x * VARS_PER_TASK + z;
+      ++nrEntries;
+    }
+  }
+  TaskValueIndex.nrEntries = nrEntries;
+  TaskValueIndex.valid = true;
+}
+
+// Find task and value index by their (case insensitive) names, using the index.
+// Only enabled tasks are considered.
+bool findTaskValueByName(const String& taskName, const String& valueName, byte& TaskIndex, byte& varNr)
+{
+  if (taskName.length() == 0)
+    return false;
+  if (!TaskValueIndex.valid)
+    updateTaskValueIndex();
+  const uint32_t hash = taskValueNameHash(taskName, valueName);
+  // Binary search for the first entry with this hash.
+  int first = 0;
+  int last = TaskValueIndex.nrEntries;
+  while (first < last) {
+    const int mid = (first + last) / 2;
+    if (TaskValueIndex.hash[mid] < hash)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+  for (int i = first; i < TaskValueIndex.nrEntries && TaskValueIndex.hash[i] == hash; ++i) {
+    const byte x = TaskValueIndex.taskVar[i] / VARS_PER_TASK;
+    const byte z = TaskValueIndex.taskVar[i] % VARS_PER_TASK;
+    if (!Settings.TaskDeviceEnabled[x])
+      continue;
+    // Check the names, the hash may collide.
+    const TaskSettingsCacheStruct& cache = getTaskSettingsCache(x);
+    if (taskName.equalsIgnoreCase(cache.TaskDeviceName) &&
+        valueName.equalsIgnoreCase(cache.TaskDeviceValueNames[z])) {
+      TaskIndex = x;
+      varNr = z;
+      return true;
+    }
+  }
+  return false;
+}
+
+
 /********************************************************************************************\
   Save Custom Task settings to SPIFFS
   \*********************************************************************************************/
@@ -391,6 +645,7 @@ String LoadCustomTaskSettings(int TaskIndex, byte* memAddress, int datasize)
 String SaveControllerSettings(int ControllerIndex, byte* memAddress, int datasize)
 {
   checkRAM(F("SaveControllerSettings"));
+  invalidateControllerSettingsCache(ControllerIndex);
   return SaveToFile(ControllerSettings_Type, ControllerIndex, (char*)FILE_CONFIG, memAddress, datasize);
 }
 
@@ -405,6 +660,39 @@ String LoadControllerSettings(int ControllerIndex, byte* memAddress, int datasiz
 }
 
 
+/********************************************************************************************\
+  Controller settings cached in RAM, loaded from flash only on first use and after a save.
+  The returned reference stays valid, a reload is done in the same memory.
+  \*********************************************************************************************/
+ControllerSettingsStruct& getControllerSettings(int ControllerIndex)
+{
+  ControllerSettingsCacheStruct& cache = ControllerSettingsCache[ControllerIndex];
+  if (cache.settings == nullptr) {
+    cache.settings = new ControllerSettingsStruct();
+  }
+  if (!cache.valid) {
+    LoadControllerSettings(ControllerIndex, (byte*)cache.settings, sizeof(ControllerSettingsStruct));
+    cache.valid = true;
+    ++cache.loads;
+  }
+  return *cache.settings;
+}
+
+void invalidateControllerSettingsCache(int ControllerIndex)
+{
+  if (ControllerIndex >= 0 && ControllerIndex < CONTROLLER_MAX)
+    ControllerSettingsCache[ControllerIndex].valid = false;
+  // Topics are parsed from the controller settings.
+  invalidateMQTTTopicCache();
+}
+
+void invalidateControllerSettingsCache()
+{
+  for (byte x = 0; x < CONTROLLER_MAX; ++x)
+    invalidateControllerSettingsCache(x);
+}
+
+
 /********************************************************************************************\
   Clear Custom Controller settings
   \*********************************************************************************************/
@@ -465,12 +753,22 @@ String InitFile(const char* fname, int datasize)
   checkRAM(F("InitFile"));
   FLASH_GUARD();
 
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    if (useSettingsPartition(fname)) {
+      SPIFFS_CHECK(settingsPartitionWrite(0, nullptr, _min(datasize, CONFIG_FILE_SIZE)) >= 0, fname);
+      return String();
+    }
+  #endif
+
   fs::File f = SPIFFS.open(fname, "w");
   SPIFFS_CHECK(f, fname);
 
-  for (int x = 0; x < datasize ; x++)
+  uint8_t page[DAT_FILE_PAGE_SIZE];
+  memset(page, 0, sizeof(page));
+  for (int pos = 0; pos < datasize; pos += DAT_FILE_PAGE_SIZE)
   {
-    SPIFFS_CHECK(f.write(0), fname);
+    const int length = _min(datasize - pos, DAT_FILE_PAGE_SIZE);
+    SPIFFS_CHECK(f.write(page, length) == static_cast<size_t>(length), fname);
   }
   f.close();
 
@@ -492,25 +790,381 @@ String SaveToFile(char* fname, int index, byte* memAddress, int datasize)
   }
 
   checkRAM(F("SaveToFile"));
-  FLASH_GUARD();
+  FLASH_GUARD_CHECK();
 
+  int written = 0;
+  String err = writeToFile(fname, index, memAddress, datasize, written);
+  if (err.length())
+    return err;
+  updateFlashWriteStats(fname, written, datasize);
+
+  //OK
+  return String();
+}
+
+/********************************************************************************************\
+  Write data at a position in a file on SPIFFS, only the pages which differ from the
+  file content are written. memAddress == nullptr writes zeros.
+  Changes to config.dat and security.dat go through the settings journal.
+  \*********************************************************************************************/
+String writeToFile(const char* fname, int index, const byte* memAddress, int datasize, int& written)
+{
+  const int journalFile = getSettingsJournalFile(fname);
+  if (journalFile < 0) {
+    written = writeDirtyPages(fname, index, memAddress, datasize);
+    SPIFFS_CHECK(written >= 0, fname);
+    return String();
+  }
+  written = appendToSettingsJournal(journalFile, index, memAddress, datasize);
+  if (written < 0)
+    settingsJournal.failed = true;
+  if (settingsJournal.batchDepth == 0) {
+    String err = commitSettingsJournal();
+    if (err.length())
+      return err;
+  }
+  SPIFFS_CHECK(written >= 0, fname);
+  return String();
+}
+
+// Returns the number of bytes written, -1 on error.
+int writeDirtyPages(const char* fname, int offset, const byte* data, int datasize)
+{
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    if (useSettingsPartition(fname))
+      return settingsPartitionWrite(offset, data, datasize);
+  #endif
   fs::File f = SPIFFS.open(fname, "r+");
-  SPIFFS_CHECK(f, fname);
+  if (!f)
+    return -1;
+  const int written = writeDirtyPages(f, offset, data, datasize);
+  f.close();
+  return written;
+}
 
-  SPIFFS_CHECK(f.seek(index, fs::SeekSet), fname);
-  byte *pointerToByteToSave = memAddress;
-  for (int x = 0; x < datasize ; x++)
-  {
-    SPIFFS_CHECK(f.write(*pointerToByteToSave), fname);
-    pointerToByteToSave++;
+// Returns the number of bytes written, -1 on error.
+int writeDirtyPages(fs::File& f, int offset, const byte* data, int datasize)
+{
+  uint8_t page[DAT_FILE_PAGE_SIZE];
+  int written = 0;
+  int pos = 0;
+  while (pos < datasize) {
+    // Pages are aligned to the position in the file.
+    int length = DAT_FILE_PAGE_SIZE - ((offset + pos) % DAT_FILE_PAGE_SIZE);
+    if (length > datasize - pos)
+      length = datasize - pos;
+    if (!f.seek(offset + pos, fs::SeekSet))
+      return -1;
+    bool dirty = f.read(page, length) != static_cast<size_t>(length);
+    if (!dirty)
+      dirty = isDirtyPage(page, (data != nullptr) ? data + pos : nullptr, length);
+    if (dirty) {
+      if (data == nullptr)
+        memset(page, 0, length);
+      const uint8_t* source = (data != nullptr) ? data + pos : page;
+      if (!f.seek(offset + pos, fs::SeekSet))
+        return -1;
+      if (f.write(source, length) != static_cast<size_t>(length))
+        return -1;
+      written += length;
+    }
+    pos += length;
+  }
+  return written;
+}
+
+// data == nullptr compares with zeros.
+bool isDirtyPage(const uint8_t* stored, const byte* data, int length)
+{
+  if (data != nullptr)
+    return memcmp(stored, data, length) != 0;
+  for (int i = 0; i < length; ++i) {
+    if (stored[i] != 0)
+      return true;
+  }
+  return false;
+}
+
+/********************************************************************************************\
+  Settings journal
+  Saves to config.dat and security.dat are appended to FILE_SETTINGS_JOURNAL as records of
+  the changed pages, or of the changed sectors for config.dat in a partition. A commit record marks them complete, only then they are written to the
+  settings files and the journal is removed. A save interrupted by a reset is either dropped
+  (no commit record) or replayed at boot, so the settings files never hold half a save.
+  \*********************************************************************************************/
+int getSettingsJournalFile(const char* fname)
+{
+  if (strcmp(fname, FILE_CONFIG) == 0)
+    return 0;
+  if (strcmp(fname, FILE_SECURITY) == 0)
+    return 1;
+  return -1;
+}
+
+const char* getSettingsJournalFileName(int journalFile)
+{
+  return (journalFile == 0) ? FILE_CONFIG : FILE_SECURITY;
+}
+
+/********************************************************************************************\
+  Combine several settings saves in one commit, e.g. all saves of a web form.
+  Either all or none of them are applied to the settings files.
+  \*********************************************************************************************/
+void beginSettingsBatch()
+{
+  ++settingsJournal.batchDepth;
+}
+
+String commitSettingsBatch()
+{
+  if (settingsJournal.batchDepth > 0)
+    --settingsJournal.batchDepth;
+  if (settingsJournal.batchDepth > 0)
+    return String();
+  return commitSettingsJournal();
+}
+
+uint16_t getSettingsJournalCRC(SettingsJournalRecordStruct record, const byte* data)
+{
+  record.crc = 0;
+  int crc = calc_CRC16((const char*)&record, sizeof(record));
+  if (record.length > 0)
+    crc ^= calc_CRC16((const char*)data, record.length);
+  return crc;
+}
+
+bool writeSettingsJournalRecord(uint8_t type, int journalFile, uint32_t offset, const byte* data, uint16_t length)
+{
+  SettingsJournalRecordStruct record;
+  record.magic = SETTINGS_JOURNAL_MAGIC;
+  record.type = type;
+  record.file = journalFile;
+  record.offset = offset;
+  record.length = length;
+  record.crc = getSettingsJournalCRC(record, data);
+
+  fs::File f = SPIFFS.open(FILE_SETTINGS_JOURNAL, "a");
+  if (!f)
+    return false;
+  bool success = f.write((const uint8_t*)&record, sizeof(record)) == sizeof(record);
+  if (success && length > 0)
+    success = f.write(data, length) == length;
+  f.close();
+  if (success && type == SETTINGS_JOURNAL_DATA) {
+    ++settingsJournal.records;
+    settingsJournal.bytes += length;
+  }
+  return success;
+}
+
+// Reads a record and its data into page, false at the end of the journal or a torn record.
+bool readSettingsJournalRecord(fs::File& f, SettingsJournalRecordStruct& record, uint8_t* page)
+{
+  if (f.read((uint8_t*)&record, sizeof(record)) != sizeof(record))
+    return false;
+  if (record.magic != SETTINGS_JOURNAL_MAGIC || record.file > 1 || record.length > DAT_FILE_PAGE_SIZE)
+    return false;
+  if (record.type != SETTINGS_JOURNAL_DATA && record.type != SETTINGS_JOURNAL_COMMIT)
+    return false;
+  if (record.length > 0 && f.read(page, record.length) != record.length)
+    return false;
+  return record.crc == getSettingsJournalCRC(record, page);
+}
+
+// Append the pages which differ from the current content, returns the number of bytes appended or -1 on error.
+int appendToSettingsJournal(int journalFile, int offset, const byte* data, int datasize)
+{
+  const char* fname = getSettingsJournalFileName(journalFile);
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    if (useSettingsPartition(fname))
+      return appendSectorsToSettingsJournal(journalFile, offset, data, datasize);
+  #endif
+  uint8_t page[DAT_FILE_PAGE_SIZE];
+  int written = 0;
+  int pos = 0;
+  while (pos < datasize) {
+    int length = DAT_FILE_PAGE_SIZE - ((offset + pos) % DAT_FILE_PAGE_SIZE);
+    if (length > datasize - pos)
+      length = datasize - pos;
+    // Compared with the content including earlier saves of the same batch.
+    bool dirty = !readFromFile(fname, offset + pos, page, length);
+    if (!dirty)
+      dirty = isDirtyPage(page, (data != nullptr) ? data + pos : nullptr, length);
+    if (dirty) {
+      if (data == nullptr)
+        memset(page, 0, length);
+      const byte* source = (data != nullptr) ? data + pos : page;
+      if (!writeSettingsJournalRecord(SETTINGS_JOURNAL_DATA, journalFile, offset + pos, source, length))
+        return -1;
+      written += length;
+    }
+    pos += length;
+  }
+  return written;
+}
+
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+// The partition is erased and written per sector, so changed sectors are appended as a whole.
+// A replay after a reset between erase and write then restores the complete sector.
+int appendSectorsToSettingsJournal(int journalFile, int offset, const byte* data, int datasize)
+{
+  byte* sector = static_cast<byte*>(malloc(SPI_FLASH_SEC_SIZE));
+  if (sector == nullptr)
+    return -1;
+  int written = 0;
+  int pos = 0;
+  bool success = true;
+  while (success && pos < datasize) {
+    const int sectorStart = ((offset + pos) / SPI_FLASH_SEC_SIZE) * SPI_FLASH_SEC_SIZE;
+    int length = sectorStart + SPI_FLASH_SEC_SIZE - (offset + pos);
+    if (length > datasize - pos)
+      length = datasize - pos;
+    byte* target = sector + (offset + pos - sectorStart);
+    // Compared with the content including earlier saves of the same batch.
+    success = readFromFile(getSettingsJournalFileName(journalFile), sectorStart, sector, SPI_FLASH_SEC_SIZE);
+    if (success && isDirtyPage(target, (data != nullptr) ? data + pos : nullptr, length)) {
+      if (data != nullptr)
+        memcpy(target, data + pos, length);
+      else
+        memset(target, 0, length);
+      for (int page = 0; success && page < SPI_FLASH_SEC_SIZE; page += DAT_FILE_PAGE_SIZE)
+        success = writeSettingsJournalRecord(SETTINGS_JOURNAL_DATA, journalFile, sectorStart + page, sector + page, DAT_FILE_PAGE_SIZE);
+      written += SPI_FLASH_SEC_SIZE;
+    }
+    pos += length;
+  }
+  free(sector);
+  return success ? written : -1;
+}
+#endif
+
+String commitSettingsJournal()
+{
+  if (settingsJournal.failed) {
+    // None of the saves of the batch is applied, drop what was loaded from it.
+    SPIFFS.remove(FILE_SETTINGS_JOURNAL);
+    settingsJournal.records = 0;
+    settingsJournal.bytes = 0;
+    settingsJournal.failed = false;
+    clearTaskSettingsCache();
+    clearTaskFormulas();
+    invalidateControllerSettingsCache();
+    return FileError(__LINE__, FILE_SETTINGS_JOURNAL);
+  }
+  if (settingsJournal.records == 0)
+    return String();
+  String err;
+  if (!writeSettingsJournalRecord(SETTINGS_JOURNAL_COMMIT, 0, settingsJournal.bytes, nullptr, 0)) {
+    SPIFFS.remove(FILE_SETTINGS_JOURNAL);
+    err = FileError(__LINE__, FILE_SETTINGS_JOURNAL);
+  } else if (replaySettingsJournal() < 0) {
+    // The journal is kept and replayed at the next boot.
+    err = FileError(__LINE__, FILE_SETTINGS_JOURNAL);
+  }
+  settingsJournal.records = 0;
+  settingsJournal.bytes = 0;
+  return err;
+}
+
+// Write the committed records to the settings files and remove the journal.
+// Returns the number of records written, -1 on error.
+int replaySettingsJournal()
+{
+  fs::File f = SPIFFS.open(FILE_SETTINGS_JOURNAL, "r");
+  if (!f)
+    return 0;
+  uint8_t page[DAT_FILE_PAGE_SIZE];
+  byte* sector = nullptr;
+  SettingsJournalRecordStruct record;
+  size_t segmentStart = 0;
+  uint32_t segmentBytes = 0;
+  int applied = 0;
+  bool success = true;
+  while (success && readSettingsJournalRecord(f, record, page)) {
+    if (record.type == SETTINGS_JOURNAL_DATA) {
+      segmentBytes += record.length;
+      continue;
+    }
+    const size_t commitEnd = f.position();
+    if (record.offset == segmentBytes) {
+      success = f.seek(segmentStart, fs::SeekSet);
+      while (success && f.position() < commitEnd && readSettingsJournalRecord(f, record, page)) {
+        if (record.type == SETTINGS_JOURNAL_DATA) {
+          success = applySettingsJournalRecord(record, page, sector);
+          ++applied;
+        }
+      }
+      success = success && f.seek(commitEnd, fs::SeekSet);
+    }
+    segmentStart = commitEnd;
+    segmentBytes = 0;
   }
   f.close();
-  String log = F("FILE : Saved ");
-  log=log+fname;
-  addLog(LOG_LEVEL_INFO, log);
+  if (sector != nullptr)
+    free(sector);
+  if (!success)
+    return -1;
+  // Records after the last commit are of an interrupted save and are dropped.
+  SPIFFS.remove(FILE_SETTINGS_JOURNAL);
+  return applied;
+}
 
-  //OK
-  return String();
+// Write a committed record to its settings file, sector is a buffer allocated when needed.
+bool applySettingsJournalRecord(const SettingsJournalRecordStruct& record, const uint8_t* page, byte*& sector)
+{
+  const char* fname = getSettingsJournalFileName(record.file);
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    if (useSettingsPartition(fname)) {
+      // The records hold whole sectors, see appendSectorsToSettingsJournal().
+      // A sector is written once complete, without using what is left of it in flash.
+      const int sectorOffset = record.offset % SPI_FLASH_SEC_SIZE;
+      if (sector == nullptr) {
+        sector = static_cast<byte*>(malloc(SPI_FLASH_SEC_SIZE));
+        if (sector == nullptr)
+          return false;
+      }
+      memcpy(sector + sectorOffset, page, record.length);
+      if (sectorOffset + record.length < SPI_FLASH_SEC_SIZE)
+        return true;
+      return settingsPartitionWrite(record.offset - sectorOffset, sector, SPI_FLASH_SEC_SIZE) >= 0;
+    }
+  #endif
+  return writeDirtyPages(fname, record.offset, page, record.length) >= 0;
+}
+
+// Apply the records of the batch not yet committed to data read from a settings file.
+void overlaySettingsJournal(const char* fname, int offset, byte* data, int datasize)
+{
+  const int journalFile = getSettingsJournalFile(fname);
+  if (journalFile < 0 || settingsJournal.records == 0)
+    return;
+  fs::File f = SPIFFS.open(FILE_SETTINGS_JOURNAL, "r");
+  if (!f)
+    return;
+  uint8_t page[DAT_FILE_PAGE_SIZE];
+  SettingsJournalRecordStruct record;
+  while (readSettingsJournalRecord(f, record, page)) {
+    if (record.type != SETTINGS_JOURNAL_DATA || record.file != journalFile)
+      continue;
+    const int start = _max(offset, static_cast<int>(record.offset));
+    const int end = _min(offset + datasize, static_cast<int>(record.offset + record.length));
+    if (start < end)
+      memcpy(data + (start - offset), page + (start - record.offset), end - start);
+  }
+  f.close();
+}
+
+// Finish a save interrupted by a reset, only the journal is read.
+void recoverSettingsJournal()
+{
+  const int applied = replaySettingsJournal();
+  if (applied < 0) {
+    addLog(LOG_LEVEL_ERROR, F("FS   : Settings journal replay failed"));
+  } else if (applied > 0 && loglevelActiveFor(LOG_LEVEL_INFO)) {
+    String log = F("FS   : Settings journal replayed, records: ");
+    log += applied;
+    addLog(LOG_LEVEL_INFO, log);
+  }
 }
 
 /********************************************************************************************\
@@ -527,17 +1181,13 @@ String ClearInFile(char* fname, int index, int datasize)
   }
 
   checkRAM(F("ClearInFile"));
-  FLASH_GUARD();
-
-  fs::File f = SPIFFS.open(fname, "r+");
-  SPIFFS_CHECK(f, fname);
+  FLASH_GUARD_CHECK();
 
-  SPIFFS_CHECK(f.seek(index, fs::SeekSet), fname);
-  for (int x = 0; x < datasize ; x++)
-  {
-    SPIFFS_CHECK(f.write(0), fname);
-  }
-  f.close();
+  int written = 0;
+  String err = writeToFile(fname, index, nullptr, datasize, written);
+  if (err.length())
+    return err;
+  updateFlashWriteStats(fname, written, datasize);
 
   //OK
   return String();
@@ -557,20 +1207,39 @@ String LoadFromFile(char* fname, int offset, byte* memAddress, int datasize)
     return log;
   }
   START_TIMER;
+  ++taskSettingsCacheStats.fileLoads;
 
   checkRAM(F("LoadFromFile"));
 
-  fs::File f = SPIFFS.open(fname, "r+");
-  SPIFFS_CHECK(f, fname);
-  SPIFFS_CHECK(f.seek(offset, fs::SeekSet), fname);
-  SPIFFS_CHECK(f.read(memAddress,datasize), fname);
-  f.close();
+  SPIFFS_CHECK(readFromFile(fname, offset, memAddress, datasize), fname);
 
   STOP_TIMER(LOADFILE_STATS);
 
   return(String());
 }
 
+// Read data as stored, including the saves of a batch not yet committed.
+bool readFromFile(const char* fname, int offset, byte* data, int datasize)
+{
+  #if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    if (useSettingsPartition(fname)) {
+      if (offset + datasize > CONFIG_FILE_SIZE)
+        return false;
+      memcpy(data, settingsPartition.data + offset, datasize);
+      overlaySettingsJournal(fname, offset, data, datasize);
+      return true;
+    }
+  #endif
+  fs::File f = SPIFFS.open(fname, "r");
+  if (!f)
+    return false;
+  const bool success = f.seek(offset, fs::SeekSet) && f.read(data, datasize) > 0;
+  f.close();
+  if (success)
+    overlaySettingsJournal(fname, offset, data, datasize);
+  return success;
+}
+
 /********************************************************************************************\
   Wrapper functions to handle errors in accessing settings
   \*********************************************************************************************/
@@ -631,6 +1300,125 @@ String ClearInFile(SettingsType settingsType, int index, char* fname) {
   return(ClearInFile(fname, offset, max_size));
 }
 
+/********************************************************************************************\
+  config.dat in a memory mapped data partition (ESP32, build with USE_SETTINGS_PARTITION)
+  Reads are a memcpy from the mapped flash, writes erase and program only the changed sectors.
+  \*********************************************************************************************/
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+bool settingsPartitionInit()
+{
+  if (settingsPartition.data != nullptr)
+    return true;
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, SETTINGS_PARTITION_LABEL);
+  if (partition == nullptr) {
+    addLog(LOG_LEVEL_ERROR, F("FS   : No partition " SETTINGS_PARTITION_LABEL ", config.dat stored on SPIFFS"));
+    return false;
+  }
+  if (partition->size < CONFIG_FILE_SIZE) {
+    addLog(LOG_LEVEL_ERROR, F("FS   : Partition " SETTINGS_PARTITION_LABEL " too small, config.dat stored on SPIFFS"));
+    return false;
+  }
+  const void* mapped = nullptr;
+  if (esp_partition_mmap(partition, 0, CONFIG_FILE_SIZE, SPI_FLASH_MMAP_DATA, &mapped, &settingsPartition.handle) != ESP_OK) {
+    addLog(LOG_LEVEL_ERROR, F("FS   : Cannot map partition " SETTINGS_PARTITION_LABEL ", config.dat stored on SPIFFS"));
+    return false;
+  }
+  settingsPartition.partition = partition;
+  settingsPartition.data = static_cast<const byte*>(mapped);
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    String log = F("FS   : config.dat in partition " SETTINGS_PARTITION_LABEL " at ");
+    log += formatToHex(partition->address);
+    addLog(LOG_LEVEL_INFO, log);
+  }
+  return true;
+}
+
+bool useSettingsPartition(const char* fname)
+{
+  return settingsPartition.data != nullptr && strcmp(fname, FILE_CONFIG) == 0;
+}
+
+// Erased flash reads 0xFF, a stored config.dat starts with PID and version.
+bool settingsPartitionErased()
+{
+  for (int i = 0; i < 8; ++i) {
+    if (settingsPartition.data[i] != 0xFF)
+      return false;
+  }
+  return true;
+}
+
+// Returns the number of bytes written, -1 on error. data == nullptr writes zeros.
+int settingsPartitionWrite(int offset, const byte* data, int datasize)
+{
+  if (offset < 0 || offset + datasize > CONFIG_FILE_SIZE)
+    return -1;
+  byte* sector = nullptr;
+  int written = 0;
+  int pos = 0;
+  while (pos < datasize) {
+    const int sectorStart = ((offset + pos) / SPI_FLASH_SEC_SIZE) * SPI_FLASH_SEC_SIZE;
+    int length = sectorStart + SPI_FLASH_SEC_SIZE - (offset + pos);
+    if (length > datasize - pos)
+      length = datasize - pos;
+    const byte* stored = settingsPartition.data + offset + pos;
+    if (isDirtyPage(stored, (data != nullptr) ? data + pos : nullptr, length)) {
+      if (sector == nullptr) {
+        sector = static_cast<byte*>(malloc(SPI_FLASH_SEC_SIZE));
+        if (sector == nullptr)
+          return -1;
+      }
+      memcpy(sector, settingsPartition.data + sectorStart, SPI_FLASH_SEC_SIZE);
+      byte* target = sector + (offset + pos - sectorStart);
+      if (data != nullptr)
+        memcpy(target, data + pos, length);
+      else
+        memset(target, 0, length);
+      // Erase and write flush the cache of the mapped region, reads see the new data.
+      if (esp_partition_erase_range(settingsPartition.partition, sectorStart, SPI_FLASH_SEC_SIZE) != ESP_OK ||
+          esp_partition_write(settingsPartition.partition, sectorStart, sector, SPI_FLASH_SEC_SIZE) != ESP_OK) {
+        free(sector);
+        return -1;
+      }
+      written += SPI_FLASH_SEC_SIZE;
+    }
+    pos += length;
+  }
+  if (sector != nullptr)
+    free(sector);
+  return written;
+}
+
+// Move config.dat from SPIFFS (earlier install or upload) into the partition.
+bool settingsPartitionImport()
+{
+  fs::File f = SPIFFS.open(FILE_CONFIG, "r");
+  if (!f)
+    return false;
+  byte* buffer = static_cast<byte*>(malloc(SPI_FLASH_SEC_SIZE));
+  bool success = buffer != nullptr;
+  int pos = 0;
+  while (success && pos < CONFIG_FILE_SIZE) {
+    const int length = f.read(buffer, _min(SPI_FLASH_SEC_SIZE, CONFIG_FILE_SIZE - pos));
+    if (length <= 0)
+      break;
+    success = settingsPartitionWrite(pos, buffer, length) >= 0;
+    pos += length;
+  }
+  f.close();
+  if (buffer != nullptr)
+    free(buffer);
+  if (success && pos < CONFIG_FILE_SIZE)
+    success = settingsPartitionWrite(pos, nullptr, CONFIG_FILE_SIZE - pos) >= 0;
+  if (success)
+    SPIFFS.remove(FILE_CONFIG);
+  String log = F("FS   : Import config.dat into partition ");
+  log += success ? F("done") : F("failed");
+  addLog(success ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR, log);
+  return success;
+}
+#endif
+
 /********************************************************************************************\
   Check SPIFFS area settings
   \*********************************************************************************************/
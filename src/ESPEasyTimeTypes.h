@@ -2,7 +2,6 @@
 #define ESPEASY_TIMETYPES_H_
 
 #include <stdint.h>
-#include <list>
 
 struct  timeStruct {
   timeStruct() : Second(0), Minute(0), Hour(0), Wday(0), Day(0), Month(0), Year(0) {}
@@ -80,58 +79,98 @@ void setPluginTaskTimer(unsigned long timer, byte plugin, short taskIndex, int P
  * TimerHandler Used by the Scheduler
 \*********************************************************************************************/
 
+// Max. number of timers which can be scheduled at the same time.
+// One per task device timer, the interval timers and the plugin task timers (systemTimers)
+#ifndef MSEC_TIMER_HANDLER_MAX
+  #define MSEC_TIMER_HANDLER_MAX   (TASKS_MAX + 36)   // Must be < 128
+#endif
+// Size of the id -> heap position lookup table. Keep it at least twice the number of timers.
+#define MSEC_TIMER_INDEX_SIZE      (2 * MSEC_TIMER_HANDLER_MAX)
+
 struct timer_id_couple {
-  timer_id_couple(unsigned long id, unsigned long newtimer) : _id(id), _timer(newtimer) {}
+  timer_id_couple() : _id(0), _timer(0), _index_slot(0) {}
+
+  timer_id_couple(unsigned long id, unsigned long newtimer) : _id(id), _timer(newtimer), _index_slot(0) {}
 
-  timer_id_couple(unsigned long id) : _id(id) {
+  timer_id_couple(unsigned long id) : _id(id), _index_slot(0) {
     _timer = millis();
   }
 
-  bool operator<(const timer_id_couple& other) {
-    const unsigned long now(millis());
-    // timediff > 0, means timer has already passed
-    return (timeDiff(_timer, now) > timeDiff(other._timer, now));
+  // Wrap-safe compare, true when this timer should run before the other.
+  // Valid as long as all timers are within 2^31 msec of eachother.
+  bool runsBefore(const timer_id_couple& other) const {
+    return timeDiff(_timer, other._timer) > 0;
   }
 
   unsigned long _id;
   unsigned long _timer;
+  uint8_t _index_slot; // Position of this timer in the id -> heap position lookup table.
 };
 
+/*********************************************************************************************\
+ * Scheduled timers are kept in a preallocated binary min-heap, ordered on their timer value.
+ * A small open addressing hash table keeps track of the heap position of each id,
+ * so a (re)schedule of an existing id can be done in O(log n) without any allocation.
+\*********************************************************************************************/
 struct msecTimerHandlerStruct {
 
   msecTimerHandlerStruct() : get_called(0), get_called_ret_id(0), max_queue_length(0),
-      last_exec_time_usec(0), total_idle_time_usec(0), is_idle(false), idle_time_pct(0.0)
+      dropped_timers(0), last_exec_time_usec(0), total_idle_time_usec(0), is_idle(false),
+      idle_time_pct(0.0), _timer_count(0)
   {
     last_log_start_time = millis();
+    for (int i = 0; i < MSEC_TIMER_INDEX_SIZE; ++i) {
+      _index[i] = 0;
+    }
   }
 
-  void registerAt(unsigned long id, unsigned long timer) {
+  // False when the timer is not set, since all MSEC_TIMER_HANDLER_MAX are in use.
+  bool registerAt(unsigned long id, unsigned long timer) {
     timer_id_couple item(id, timer);
-    insert(item);
+    return insert(item);
   }
 
   // Check if timeout has been reached and also return its set timer.
   // Return 0 if no item has reached timeout moment.
   unsigned long getNextId(unsigned long& timer) {
     ++get_called;
-    if (_timer_ids.empty()) {
+    if (_timer_count == 0) {
       recordIdle();
       return 0;
     }
-    timer_id_couple item = _timer_ids.front();
+    const timer_id_couple item = _timer_heap[0];
     if (!timeOutReached(item._timer)) {
       recordIdle();
       return 0;
     }
     recordRunning();
-    unsigned long size = _timer_ids.size();
-    if (size > max_queue_length) max_queue_length = size;
-    _timer_ids.pop_front();
+    if (static_cast<unsigned long>(_timer_count) > max_queue_length) max_queue_length = _timer_count;
+    removeAt(0);
     timer = item._timer;
     ++get_called_ret_id;
     return item._id;
   }
 
+  // Time in msec until the first timer is due, 0 when already due, -1 when no timer is set.
+  long msecUntilNextTimer() const {
+    if (_timer_count == 0) return -1;
+    const long diff = timeDiff(millis(), _timer_heap[0]._timer);
+    return diff > 0 ? diff : 0;
+  }
+
+  // Mark the start of idle time, e.g. just before the loop sleeps until the next timer.
+  void setIdle() {
+    recordIdle();
+  }
+
+  // Remove a scheduled timer, if present.
+  bool remove(unsigned long id) {
+    const int pos = findPos(id);
+    if (pos < 0) return false;
+    removeAt(pos);
+    return true;
+  }
+
   String getQueueStats() {
 
     String result;
@@ -142,6 +181,8 @@ struct msecTimerHandlerStruct {
     result += max_queue_length;
     result += '/';
     result += idle_time_pct;
+    result += '/';
+    result += dropped_timers;
     get_called = 0;
     get_called_ret_id = 0;
     //max_queue_length = 0;
@@ -160,24 +201,122 @@ struct msecTimerHandlerStruct {
   }
 
 private:
-  struct match_id {
-    match_id(unsigned long id) : _id(id) {}
-    bool operator() (const timer_id_couple& item) { return _id == item._id; }
-    unsigned long _id;
-  };
 
-  void insert(const timer_id_couple& item) {
-    if (item._id == 0) return;
+  bool insert(const timer_id_couple& item) {
+    if (item._id == 0) return false;
 
     // Make sure only one is present with the same id.
-    _timer_ids.remove_if(match_id(item._id));
-    const bool mustSort = !_timer_ids.empty();
-    _timer_ids.push_front(item);
-    if (mustSort)
-      _timer_ids.sort(); // TD-er: Must check if this is an expensive operation.
-    // It should be a relative light operation, to insert into a sorted list.
-    // Perhaps it is better to use std::set ????
-    // Keep in mind: order is based on timer, uniqueness is based on id.
+    const int pos = findPos(item._id);
+    if (pos >= 0) {
+      // Reschedule existing timer, it may need to move in both directions.
+      _timer_heap[pos]._timer = item._timer;
+      siftDown(siftUp(pos));
+      return true;
+    }
+    if (_timer_count >= MSEC_TIMER_HANDLER_MAX) {
+      ++dropped_timers;
+      return false;
+    }
+    const int newPos = _timer_count;
+    ++_timer_count;
+    _timer_heap[newPos] = item;
+    _timer_heap[newPos]._index_slot = addToIndex(item._id, newPos);
+    siftUp(newPos);
+    return true;
+  }
+
+  void removeAt(int pos) {
+    removeFromIndex(_timer_heap[pos]._index_slot);
+    --_timer_count;
+    if (pos == _timer_count) return;
+    // Move last element to the free position and restore the heap order.
+    placeAt(pos, _timer_heap[_timer_count]);
+    siftDown(siftUp(pos));
+  }
+
+  void placeAt(int pos, const timer_id_couple& item) {
+    _timer_heap[pos] = item;
+    _index[item._index_slot] = pos + 1;
+  }
+
+  // Returns the new position of the item.
+  int siftUp(int pos) {
+    const timer_id_couple item = _timer_heap[pos];
+    while (pos > 0) {
+      const int parent = (pos - 1) / 2;
+      if (!item.runsBefore(_timer_heap[parent])) break;
+      placeAt(pos, _timer_heap[parent]);
+      pos = parent;
+    }
+    placeAt(pos, item);
+    return pos;
+  }
+
+  int siftDown(int pos) {
+    const timer_id_couple item = _timer_heap[pos];
+    while (true) {
+      int child = 2 * pos + 1;
+      if (child >= _timer_count) break;
+      if ((child + 1) < _timer_count && _timer_heap[child + 1].runsBefore(_timer_heap[child])) {
+        ++child;
+      }
+      if (!_timer_heap[child].runsBefore(item)) break;
+      placeAt(pos, _timer_heap[child]);
+      pos = child;
+    }
+    placeAt(pos, item);
+    return pos;
+  }
+
+  /*********************************************************************************************\
+   * Lookup table id -> heap position
+   * Linear probing, entries store heap position + 1 (0 = empty slot)
+  \*********************************************************************************************/
+  static int indexHash(unsigned long id) {
+    // Mixed ids differ mainly in the lower bits and the timer type in the upper 4 bits.
+    unsigned long hash = id ^ (id >> 16) ^ (id >> 28);
+    hash *= 0x45d9f3b;
+    return (hash ^ (hash >> 16)) % MSEC_TIMER_INDEX_SIZE;
+  }
+
+  int findPos(unsigned long id) const {
+    int slot = indexHash(id);
+    while (_index[slot] != 0) {
+      const int pos = _index[slot] - 1;
+      if (_timer_heap[pos]._id == id) return pos;
+      slot = (slot + 1) % MSEC_TIMER_INDEX_SIZE;
+    }
+    return -1;
+  }
+
+  uint8_t addToIndex(unsigned long id, int pos) {
+    int slot = indexHash(id);
+    while (_index[slot] != 0) {
+      slot = (slot + 1) % MSEC_TIMER_INDEX_SIZE;
+    }
+    _index[slot] = pos + 1;
+    return slot;
+  }
+
+  // Backward shift deletion, to keep the probe sequences intact without tombstones.
+  void removeFromIndex(int slot) {
+    int next = slot;
+    while (true) {
+      next = (next + 1) % MSEC_TIMER_INDEX_SIZE;
+      if (_index[next] == 0) break;
+      const int pos = _index[next] - 1;
+      const int home = indexHash(_timer_heap[pos]._id);
+      // Check whether home is cyclically in (slot, next], then this entry must stay.
+      const bool stays = (slot <= next) ?
+                           (slot < home && home <= next) :
+                           (slot < home || home <= next);
+      if (!stays) {
+        _index[slot] = _index[next];
+        _timer_heap[pos]._index_slot = slot;
+        slot = next;
+      }
+    }
+    _index[slot] = 0;
   }
 
   void recordIdle() {
@@ -197,6 +336,7 @@ private:
   unsigned long get_called;
   unsigned long get_called_ret_id;
   unsigned long max_queue_length;
+  unsigned long dropped_timers;
 
   // Compute idle system time
   unsigned long last_exec_time_usec;
@@ -205,8 +345,10 @@ private:
   bool is_idle;
   float idle_time_pct;
 
-  // The list of set timers
-  std::list<timer_id_couple> _timer_ids;
+  // The heap of set timers, earliest timer at position 0.
+  timer_id_couple _timer_heap[MSEC_TIMER_HANDLER_MAX];
+  int _timer_count;
+  uint8_t _index[MSEC_TIMER_INDEX_SIZE];
 };
 
 
@@ -132,8 +132,7 @@ int8_t getTaskIndexByName(String TaskNameSearch)
 
   for (byte x = 0; x < TASKS_MAX; x++)
   {
-    LoadTaskSettings(x);
-    String TaskName = getTaskDeviceName(x);
+    const String& TaskName = getTaskSettingsCache(x).TaskDeviceName;
     if ((TaskName.length() != 0 ) && (TaskNameSearch.equalsIgnoreCase(TaskName)))
     {
       return x;
@@ -381,6 +380,8 @@ void taskClear(byte taskIndex, boolean save)
   Settings.clearTask(taskIndex);
   ExtraTaskSettings.clear(); // Invalidate any cached values.
   ExtraTaskSettings.TaskIndex = taskIndex;
+  clearTaskFormulas(taskIndex);
+  clearTaskSettingsCache(taskIndex);
   if (save) {
     SaveTaskSettings(taskIndex);
     SaveSettings();
@@ -405,9 +406,9 @@ String checkTaskSettings(byte taskIndex) {
   }
   for (int i = 0; i < TASKS_MAX; ++i) {
     if (i != taskIndex && Settings.TaskDeviceEnabled[i]) {
-      LoadTaskSettings(i);
-      if (ExtraTaskSettings.TaskDeviceName[0] != 0) {
-        if (strcasecmp(ExtraTaskSettings.TaskDeviceName, deviceName.c_str()) == 0) {
+      const String& otherName = getTaskSettingsCache(i).TaskDeviceName;
+      if (otherName.length() != 0) {
+        if (otherName.equalsIgnoreCase(deviceName)) {
           err = F("Task Device Name is not unique, conflicts with task ID #");
           err += (i+1);
           return err;
@@ -607,8 +608,37 @@ uint32_t progMemMD5check(){
   Handler for keeping ExtraTaskSettings up to date using cache
   \*********************************************************************************************/
 String getTaskDeviceName(byte TaskIndex) {
-  LoadTaskSettings(TaskIndex);
-  return ExtraTaskSettings.TaskDeviceName;
+  if (TaskIndex >= TASKS_MAX)
+    return String();
+  return getTaskSettingsCache(TaskIndex).TaskDeviceName;
+}
+
+/********************************************************************************************\
+  Change counters of the task values, used for the ETag of /json and view=sensorupdate&since=
+  \*********************************************************************************************/
+void touchTaskDataVersion(byte TaskIndex) {
+  if (TaskIndex >= TASKS_MAX)
+    return;
+  taskDataVersion[TaskIndex] = ++dataVersion;
+}
+
+// Task settings (names, decimals, interval, ...) are part of the JSON output too.
+void touchTaskDataVersions() {
+  for (byte TaskIndex = 0; TaskIndex < TASKS_MAX; ++TaskIndex)
+    touchTaskDataVersion(TaskIndex);
+}
+
+// Compare the task values with the snapshot of the previous call, new version for changed tasks.
+void updateTaskDataVersions() {
+  for (byte TaskIndex = 0; TaskIndex < TASKS_MAX; ++TaskIndex) {
+    const float* current = &UserVar[TaskIndex * VARS_PER_TASK];
+    float* snapshot = &taskDataSnapshot[TaskIndex * VARS_PER_TASK];
+    // memcmp, since NaN values never compare equal.
+    if (memcmp(current, snapshot, sizeof(float) * VARS_PER_TASK) != 0) {
+      memcpy(snapshot, current, sizeof(float) * VARS_PER_TASK);
+      touchTaskDataVersion(TaskIndex);
+    }
+  }
 }
 
 
@@ -1131,7 +1161,7 @@ boolean loglevelActiveFor(byte destination, byte logLevel) {
   byte logLevelSettings = 0;
   switch (destination) {
     case LOG_TO_SERIAL: {
-      if (!SerialAvailableForWrite()) return false;
+      if (!Settings.UseSerial) return false;
       logLevelSettings = Settings.SerialLogLevel;
       if (wifiStatus != ESPEASY_WIFI_SERVICES_INITIALIZED)
         logLevelSettings = 2;
@@ -1162,16 +1192,22 @@ boolean loglevelActive(byte logLevel, byte logLevelSettings) {
 
 void addToLog(byte logLevel, const char *line)
 {
-  if (loglevelActiveFor(LOG_TO_SERIAL, logLevel)) {
-    Serial.print(millis());
-    Serial.print(F(" : "));
-    Serial.println(line);
-  }
-  if (loglevelActiveFor(LOG_TO_SYSLOG, logLevel)) {
-    syslog(logLevel, line);
-  }
+  // The line is stored once for serial, syslog and the web log, each reads it with its own cursor.
+  byte destinations = 0;
+  if (loglevelActiveFor(LOG_TO_SERIAL, logLevel))
+    destinations |= (1 << LOG_TO_SERIAL);
+  if (loglevelActiveFor(LOG_TO_SYSLOG, logLevel))
+    destinations |= (1 << LOG_TO_SYSLOG);
   if (loglevelActiveFor(LOG_TO_WEBLOG, logLevel)) {
-    Logging.add(logLevel, line);
+    destinations |= (1 << LOG_TO_WEBLOG);
+    if (eventStreamClientCount != 0)
+      destinations |= (1 << LOG_TO_EVENTSTREAM);
+  }
+  if (destinations != 0) {
+    Logging.add(logLevel, destinations, line);
+    // Other RTOS tasks only add the line, the main loop writes it.
+    if (isMainLoopTask())
+      processLogReaders();
   }
 
 #ifdef FEATURE_SD
@@ -1185,6 +1221,44 @@ void addToLog(byte logLevel, const char *line)
 }
 
 
+bool isMainLoopTask()
+{
+  #ifdef ESP32
+    return mainLoopTaskHandle == NULL || xTaskGetCurrentTaskHandle() == mainLoopTaskHandle;
+  #else
+    return true;
+  #endif
+}
+
+/********************************************************************************************\
+  Write the log lines queued for serial, syslog and the /events subscribers.
+  Serial only gets lines while the UART has room, the rest is written on a next call
+  from backgroundtasks(), so heavy logging does not wait on the serial port.
+  Only runs on the main loop task, so the readers need no locking.
+  \*********************************************************************************************/
+void processLogReaders()
+{
+  static bool processing = false; // Prevent recursion
+  if (processing || !isMainLoopTask()) return;
+  processing = true;
+  unsigned long timestamp;
+  byte logLevel;
+  static char line[LOG_LINE_MAX_SIZE + 1]; // Too large for the stack of the ESP8266
+  while (SerialAvailableForWrite() && Logging.read(LOG_TO_SERIAL, timestamp, logLevel, line, sizeof(line))) {
+    Serial.print(timestamp);
+    Serial.print(F(" : "));
+    Serial.println(line);
+  }
+  while (Logging.read(LOG_TO_SYSLOG, timestamp, logLevel, line, sizeof(line))) {
+    syslog(logLevel, line);
+  }
+  while (Logging.read(LOG_TO_EVENTSTREAM, timestamp, logLevel, line, LOG_STRUCT_MESSAGE_SIZE)) {
+    eventStreamLog(timestamp, logLevel, line);
+  }
+  processing = false;
+}
+
+
 /********************************************************************************************\
   Delayed reboot, in case of issues, do not reboot with high frequency as it might not help...
   \*********************************************************************************************/
@@ -1319,316 +1393,84 @@ uint32_t getChecksum(byte* buffer, size_t size)
 String parseTemplate(String &tmpString, byte lineSize)
 {
   checkRAM(F("parseTemplate"));
-  String newString = "";
-  String tmpStringMid = "";
-  newString.reserve(lineSize);
+  String newString;
+  const int length = tmpString.length();
+  newString.reserve(length > lineSize ? length : lineSize);
 
   // replace task template variables
-  int leftBracketIndex = tmpString.indexOf('[');
-  if (leftBracketIndex == -1)
-    newString = tmpString;
-  else
+  const byte currentTaskIndex = ExtraTaskSettings.TaskIndex;
+  int pos = 0; // Part of tmpString before pos has been handled
+  while (pos < length)
   {
-    byte count = 0;
-    byte currentTaskIndex = ExtraTaskSettings.TaskIndex;
+    const int leftBracketIndex = tmpString.indexOf('[', pos);
+    if (leftBracketIndex == -1)
+      break;
+    const int rightBracketIndex = tmpString.indexOf(']', leftBracketIndex + 1);
+    if (rightBracketIndex == -1)
+      break;
+    for (int i = pos; i < leftBracketIndex; ++i)
+      newString += tmpString[i];
+    pos = rightBracketIndex + 1;
+
+    // Syntax: [task#value#transformation#justification]
+    const int hashtagIndex = tmpString.indexOf('#', leftBracketIndex + 1);
+    if (hashtagIndex == -1 || hashtagIndex > rightBracketIndex)
+      continue;
+    const String deviceName = tmpString.substring(leftBracketIndex + 1, hashtagIndex);
+    if (deviceName.equalsIgnoreCase(F("Plugin")))
+    {
+      String request = tmpString.substring(hashtagIndex + 1, rightBracketIndex);
+      request.replace('#', ',');
+      if (PluginCall(PLUGIN_REQUEST, 0, request))
+        newString += request;
+      continue;
+    }
+    int formatIndex = tmpString.indexOf('#', hashtagIndex + 1);
+    if (formatIndex == -1 || formatIndex > rightBracketIndex)
+      formatIndex = rightBracketIndex;
+    const String valueName = tmpString.substring(hashtagIndex + 1, formatIndex);
 
-    while (leftBracketIndex >= 0 && count < 10 - 1)
+    byte TaskIndex, varNr;
+    if (findTaskValueByName(deviceName, valueName, TaskIndex, varNr))
+    {
+      // here we know the task and value, so find the uservar
+      bool isvalid;
+      String value = formatUserVar(TaskIndex, varNr, isvalid);
+      if (isvalid) {
+        if (formatIndex < rightBracketIndex)
+          transformTemplateValue(newString, value, tmpString.substring(formatIndex + 1, rightBracketIndex), length - pos, lineSize);
+        newString += value;
+        if (loglevelActiveFor(LOG_LEVEL_DEBUG_DEV)) {
+          String logParsed = F("DEBUG DEV: Parsed String='");
+          logParsed += newString;
+          logParsed += "'";
+          addLog(LOG_LEVEL_DEBUG_DEV, logParsed);
+        }
+      }
+    }
+    else
     {
-      newString += tmpString.substring(0, leftBracketIndex);
-      tmpString = tmpString.substring(leftBracketIndex + 1);
-      int rightBracketIndex = tmpString.indexOf(']');
-      if (rightBracketIndex >= 0)
+      // try if this is a get config request
+      for (byte y = 0; y < TASKS_MAX; y++)
       {
-        tmpStringMid = tmpString.substring(0, rightBracketIndex);
-        tmpString = tmpString.substring(rightBracketIndex + 1);
-        int hashtagIndex = tmpStringMid.indexOf('#');
-        if (hashtagIndex >= 0) {
-          String deviceName = tmpStringMid.substring(0, hashtagIndex);
-          String valueName = tmpStringMid.substring(hashtagIndex + 1);
-          String valueFormat = "";
-          hashtagIndex = valueName.indexOf('#');
-          if (hashtagIndex >= 0)
-          {
-            valueFormat = valueName.substring(hashtagIndex + 1);
-            valueName = valueName.substring(0, hashtagIndex);
-          }
-
-          if (deviceName.equalsIgnoreCase(F("Plugin")))
-          {
-            String tmpString = tmpStringMid.substring(7);
-            tmpString.replace('#', ',');
-            if (PluginCall(PLUGIN_REQUEST, 0, tmpString))
-              newString += tmpString;
-          }
-          else
-            for (byte y = 0; y < TASKS_MAX; y++)
-            {
-              if (Settings.TaskDeviceEnabled[y])
-              {
-                LoadTaskSettings(y);
-                String taskDeviceName = getTaskDeviceName(y);
-                if (taskDeviceName.length() != 0)
-                {
-                  if (deviceName.equalsIgnoreCase(taskDeviceName))
-                  {
-                    boolean match = false;
-                    for (byte z = 0; z < VARS_PER_TASK; z++)
-                      if (valueName.equalsIgnoreCase(ExtraTaskSettings.TaskDeviceValueNames[z]))
-                      {
-                        // here we know the task and value, so find the uservar
-                        match = true;
-                        bool isvalid;
-                        String value = formatUserVar(y, z, isvalid);
-                        if (isvalid) {
-                          // start changes by giig1967g - 2018-04-20
-                          // Syntax: [task#value#transformation#justification]
-                          // valueFormat="transformation#justification"
-                          if (valueFormat.length() > 0) //do the checks only if a Format is defined to optimize loop
-                          {
-                            String valueJust = "";
-
-                            hashtagIndex = valueFormat.indexOf('#');
-                            if (hashtagIndex >= 0)
-                            {
-                              valueJust = valueFormat.substring(hashtagIndex + 1); //Justification part
-                              valueFormat = valueFormat.substring(0, hashtagIndex); //Transformation part
-                            }
-
-                            // valueFormat="transformation"
-                            // valueJust="justification"
-                            if (valueFormat.length() > 0) //do the checks only if a Format is defined to optimize loop
-                            {
-                              const int val = value == "0" ? 0 : 1; //to be used for GPIO status (0 or 1)
-                              const float valFloat = value.toFloat();
-
-                              String tempValueFormat = valueFormat;
-                              int tempValueFormatLength = tempValueFormat.length();
-                              const int invertedIndex = tempValueFormat.indexOf('!');
-                              const bool inverted = invertedIndex >= 0 ? 1 : 0;
-                              if (inverted)
-                                tempValueFormat.remove(invertedIndex,1);
-
-                              const int rightJustifyIndex = tempValueFormat.indexOf('R');
-                              const bool rightJustify = rightJustifyIndex >= 0 ? 1 : 0;
-                              if (rightJustify)
-                                tempValueFormat.remove(rightJustifyIndex,1);
-
-                              tempValueFormatLength = tempValueFormat.length(); //needed because could have been changed after '!' and 'R' removal
-
-                              //Check Transformation syntax
-                              if (tempValueFormatLength > 0)
-                              {
-                                switch (tempValueFormat[0])
-                                  {
-                                  case 'V': //value = value without transformations
-                                    break;
-                                  case 'O':
-                                    value = val == inverted ? F("OFF") : F(" ON"); //(equivalent to XOR operator)
-                                    break;
-                                  case 'C':
-                                    value = val == inverted ? F("CLOSE") : F(" OPEN");
-                                    break;
-                                  case 'M':
-                                    value = val == inverted ? F("AUTO") : F(" MAN");
-                                    break;
-                                  case 'm':
-                                    value = val == inverted ? F("A") : F("M");
-                                    break;
-                                  case 'H':
-                                    value = val == inverted ? F("COLD") : F(" HOT");
-                                    break;
-                                  case 'U':
-                                    value = val == inverted ? F("DOWN") : F("  UP");
-                                    break;
-                                  case 'u':
-                                    value = val == inverted ? F("D") : F("U");
-                                    break;
-                                  case 'Y':
-                                    value = val == inverted ? F(" NO") : F("YES");
-                                    break;
-                                  case 'y':
-                                    value = val == inverted ? F("N") : F("Y");
-                                    break;
-                                  case 'X':
-                                    value = val == inverted ? F("O") : F("X");
-                                    break;
-                                  case 'I':
-                                    value = val == inverted ? F("OUT") : F(" IN");
-                                    break;
-                                  case 'Z' :// return "0" or "1"
-                                    value = val == inverted ? F("0") : F("1");
-                                    break;
-                                  case 'D' ://Dx.y min 'x' digits zero filled & 'y' decimal fixed digits
-                                    {
-                                      int x;
-                                      int y;
-                                      x = 0;
-                                      y = 0;
-
-                                      switch (tempValueFormatLength)
-                                      {
-                                        case 2: //Dx
-                                          if (isDigit(tempValueFormat[1]))
-                                          {
-                                            x = (int)tempValueFormat[1]-'0';
-                                          }
-                                          break;
-                                        case 3: //D.y
-                                          if (tempValueFormat[1]=='.' && isDigit(tempValueFormat[2]))
-                                          {
-                                            y = (int)tempValueFormat[2]-'0';
-                                          }
-                                          break;
-                                        case 4: //Dx.y
-                                          if (isDigit(tempValueFormat[1]) && tempValueFormat[2]=='.' && isDigit(tempValueFormat[3]))
-                                          {
-                                            x = (int)tempValueFormat[1]-'0';
-                                            y = (int)tempValueFormat[3]-'0';
-                                          }
-                                          break;
-                                        case 1: //D
-                                        default: //any other combination x=0; y=0;
-                                          break;
-                                      }
-                                      value = toString(valFloat,y);
-                                      int indexDot;
-                                      indexDot = value.indexOf('.') > 0 ? value.indexOf('.') : value.length();
-                                      for (byte f = 0; f < (x - indexDot); f++)
-                                        value = "0" + value;
-                                      break;
-                                    }
-                                  case 'F' :// FLOOR (round down)
-                                    value = (int)floorf(valFloat);
-                                    break;
-                                  case 'E' :// CEILING (round up)
-                                    value = (int)ceilf(valFloat);
-                                    break;
-                                  default:
-                                    value = F("ERR");
-                                    break;
-                                  }
-
-                                  // Check Justification syntax
-                                  const int valueJustLength = valueJust.length();
-                                  if (valueJustLength > 0) //do the checks only if a Justification is defined to optimize loop
-                                  {
-                                    value.trim(); //remove right justification spaces for backward compatibility
-                                    switch (valueJust[0])
-                                    {
-                                    case 'P' :// Prefix Fill with n spaces: Pn
-                                      if (valueJustLength > 1)
-                                      {
-                                        if (isDigit(valueJust[1])) //Check Pn where n is between 0 and 9
-                                        {
-                                          int filler = valueJust[1] - value.length() - '0' ; //char '0' = 48; char '9' = 58
-                                          for (byte f = 0; f < filler; f++)
-                                            newString += " ";
-                                        }
-                                      }
-                                      break;
-                                    case 'S' :// Suffix Fill with n spaces: Sn
-                                      if (valueJustLength > 1)
-                                      {
-                                        if (isDigit(valueJust[1])) //Check Sn where n is between 0 and 9
-                                        {
-                                          int filler = valueJust[1] - value.length() - '0' ; //48
-                                          for (byte f = 0; f < filler; f++)
-                                            value += " ";
-                                        }
-                                      }
-                                      break;
-                                    case 'L': //left part of the string
-                                      if (valueJustLength > 1)
-                                      {
-                                        if (isDigit(valueJust[1])) //Check n where n is between 0 and 9
-                                        {
-                                          value = value.substring(0,(int)valueJust[1]-'0');
-                                        }
-                                      }
-                                      break;
-                                    case 'R': //Right part of the string
-                                      if (valueJustLength > 1)
-                                      {
-                                        if (isDigit(valueJust[1])) //Check n where n is between 0 and 9
-                                        {
-                                          value = value.substring(std::max(0,(int)value.length()-((int)valueJust[1]-'0')));
-                                         }
-                                      }
-                                      break;
-                                    case 'U': //Substring Ux.y where x=firstChar and y=number of characters
-                                      if (valueJustLength > 1)
-                                      {
-                                        if (isDigit(valueJust[1]) && valueJust[2]=='.' && isDigit(valueJust[3]) && valueJust[1] > '0' && valueJust[3] > '0')
-                                        {
-                                          value = value.substring(std::min((int)value.length(),(int)valueJust[1]-'0'-1),(int)valueJust[1]-'0'-1+(int)valueJust[3]-'0');
-                                        }
-                                        else
-                                        {
-                                          newString += F("ERR");
-                                        }
-                                      }
-                                      break;
-                                    default:
-                                      newString += F("ERR");
-                                      break;
-                                  }
-                                }
-                              }
-                              if (rightJustify)
-                              {
-                                int filler = lineSize - newString.length() - value.length() - tmpString.length() ;
-                                for (byte f = 0; f < filler; f++)
-                                  newString += " ";
-                              }
-                              {
-                                if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-                                  String logFormatted = F("DEBUG: Formatted String='");
-                                  logFormatted += newString;
-                                  logFormatted += value;
-                                  logFormatted += "'";
-                                  addLog(LOG_LEVEL_DEBUG, logFormatted);
-                                }
-                              }
-                            }
-                          }
-                          //end of changes by giig1967g - 2018-04-18
-
-                          newString += String(value);
-                          {
-                            if (loglevelActiveFor(LOG_LEVEL_DEBUG_DEV)) {
-                              String logParsed = F("DEBUG DEV: Parsed String='");
-                              logParsed += newString;
-                              logParsed += "'";
-                              addLog(LOG_LEVEL_DEBUG_DEV, logParsed);
-                            }
-                          }
-                          break;
-                        }
-                      }
-                    if (!match) // try if this is a get config request
-                    {
-                      struct EventStruct TempEvent;
-                      TempEvent.TaskIndex = y;
-                      String tmpName = valueName;
-                      if (PluginCall(PLUGIN_GET_CONFIG, &TempEvent, tmpName))
-                        newString += tmpName;
-                    }
-                    break;
-                  }
-                }
-              }
-            }
+        if (Settings.TaskDeviceEnabled[y] && deviceName.equalsIgnoreCase(getTaskSettingsCache(y).TaskDeviceName))
+        {
+          struct EventStruct TempEvent;
+          TempEvent.TaskIndex = y;
+          String tmpName = valueName;
+          if (PluginCall(PLUGIN_GET_CONFIG, &TempEvent, tmpName))
+            newString += tmpName;
+          break;
         }
       }
-      leftBracketIndex = tmpString.indexOf('[');
-      count++;
     }
-    checkRAM(F("parseTemplate2"));
-    newString += tmpString;
-
-    if (currentTaskIndex != 255)
-      LoadTaskSettings(currentTaskIndex);
   }
+  checkRAM(F("parseTemplate2"));
+  for (int i = pos; i < length; ++i)
+    newString += tmpString[i];
+
+  if (currentTaskIndex != 255 && ExtraTaskSettings.TaskIndex != currentTaskIndex)
+    LoadTaskSettings(currentTaskIndex);
 
   parseSystemVariables(newString, false);
   parseStandardConversions(newString, false);
@@ -1640,6 +1482,222 @@ String parseTemplate(String &tmpString, byte lineSize)
   return newString;
 }
 
+// Apply the format of a template value: "transformation#justification"
+// remainingLength is the length of the template after this value, used for right justify.
+// start changes by giig1967g - 2018-04-20
+void transformTemplateValue(String& newString, String& value, String valueFormat, int remainingLength, byte lineSize)
+{
+  if (valueFormat.length() > 0) //do the checks only if a Format is defined to optimize loop
+  {
+    String valueJust = "";
+
+    const int hashtagIndex = valueFormat.indexOf('#');
+    if (hashtagIndex >= 0)
+    {
+      valueJust = valueFormat.substring(hashtagIndex + 1); //Justification part
+      valueFormat = valueFormat.substring(0, hashtagIndex); //Transformation part
+    }
+
+    // valueFormat="transformation"
+    // valueJust="justification"
+    if (valueFormat.length() > 0) //do the checks only if a Format is defined to optimize loop
+    {
+      const int val = value == "0" ? 0 : 1; //to be used for GPIO status (0 or 1)
+      const float valFloat = value.toFloat();
+
+      String tempValueFormat = valueFormat;
+      int tempValueFormatLength = tempValueFormat.length();
+      const int invertedIndex = tempValueFormat.indexOf('!');
+      const bool inverted = invertedIndex >= 0 ? 1 : 0;
+      if (inverted)
+        tempValueFormat.remove(invertedIndex,1);
+
+      const int rightJustifyIndex = tempValueFormat.indexOf('R');
+      const bool rightJustify = rightJustifyIndex >= 0 ? 1 : 0;
+      if (rightJustify)
+        tempValueFormat.remove(rightJustifyIndex,1);
+
+      tempValueFormatLength = tempValueFormat.length(); //needed because could have been changed after '!' and 'R' removal
+
+      //Check Transformation syntax
+      if (tempValueFormatLength > 0)
+      {
+        switch (tempValueFormat[0])
+          {
+          case 'V': //value = value without transformations
+            break;
+          case 'O':
+            value = val == inverted ? F("OFF") : F(" ON"); //(equivalent to XOR operator)
+            break;
+          case 'C':
+            value = val == inverted ? F("CLOSE") : F(" OPEN");
+            break;
+          case 'M':
+            value = val == inverted ? F("AUTO") : F(" MAN");
+            break;
+          case 'm':
+            value = val == inverted ? F("A") : F("M");
+            break;
+          case 'H':
+            value = val == inverted ? F("COLD") : F(" HOT");
+            break;
+          case 'U':
+            value = val == inverted ? F("DOWN") : F("  UP");
+            break;
+          case 'u':
+            value = val == inverted ? F("D") : F("U");
+            break;
+          case 'Y':
+            value = val == inverted ? F(" NO") : F("YES");
+            break;
+          case 'y':
+            value = val == inverted ? F("N") : F("Y");
+            break;
+          case 'X':
+            value = val == inverted ? F("O") : F("X");
+            break;
+          case 'I':
+            value = val == inverted ? F("OUT") : F(" IN");
+            break;
+          case 'Z' :// return "0" or "1"
+            value = val == inverted ? F("0") : F("1");
+            break;
+          case 'D' ://Dx.y min 'x' digits zero filled & 'y' decimal fixed digits
+            {
+              int x;
+              int y;
+              x = 0;
+              y = 0;
+
+              switch (tempValueFormatLength)
+              {
+                case 2: //Dx
+                  if (isDigit(tempValueFormat[1]))
+                  {
+                    x = (int)tempValueFormat[1]-'0';
+                  }
+                  break;
+                case 3: //D.y
+                  if (tempValueFormat[1]=='.' && isDigit(tempValueFormat[2]))
+                  {
+                    y = (int)tempValueFormat[2]-'0';
+                  }
+                  break;
+                case 4: //Dx.y
+                  if (isDigit(tempValueFormat[1]) && tempValueFormat[2]=='.' && isDigit(tempValueFormat[3]))
+                  {
+                    x = (int)tempValueFormat[1]-'0';
+                    y = (int)tempValueFormat[3]-'0';
+                  }
+                  break;
+                case 1: //D
+                default: //any other combination x=0; y=0;
+                  break;
+              }
+              value = toString(valFloat,y);
+              int indexDot;
+              indexDot = value.indexOf('.') > 0 ? value.indexOf('.') : value.length();
+              for (byte f = 0; f < (x - indexDot); f++)
+                value = "0" + value;
+              break;
+            }
+          case 'F' :// FLOOR (round down)
+            value = (int)floorf(valFloat);
+            break;
+          case 'E' :// CEILING (round up)
+            value = (int)ceilf(valFloat);
+            break;
+          default:
+            value = F("ERR");
+            break;
+          }
+
+          // Check Justification syntax
+          const int valueJustLength = valueJust.length();
+          if (valueJustLength > 0) //do the checks only if a Justification is defined to optimize loop
+          {
+            value.trim(); //remove right justification spaces for backward compatibility
+            switch (valueJust[0])
+            {
+            case 'P' :// Prefix Fill with n spaces: Pn
+              if (valueJustLength > 1)
+              {
+                if (isDigit(valueJust[1])) //Check Pn where n is between 0 and 9
+                {
+                  int filler = valueJust[1] - value.length() - '0' ; //char '0' = 48; char '9' = 58
+                  for (byte f = 0; f < filler; f++)
+                    newString += " ";
+                }
+              }
+              break;
+            case 'S' :// Suffix Fill with n spaces: Sn
+              if (valueJustLength > 1)
+              {
+                if (isDigit(valueJust[1])) //Check Sn where n is between 0 and 9
+                {
+                  int filler = valueJust[1] - value.length() - '0' ; //48
+                  for (byte f = 0; f < filler; f++)
+                    value += " ";
+                }
+              }
+              break;
+            case 'L': //left part of the string
+              if (valueJustLength > 1)
+              {
+                if (isDigit(valueJust[1])) //Check n where n is between 0 and 9
+                {
+                  value = value.substring(0,(int)valueJust[1]-'0');
+                }
+              }
+              break;
+            case 'R': //Right part of the string
+              if (valueJustLength > 1)
+              {
+                if (isDigit(valueJust[1])) //Check n where n is between 0 and 9
+                {
+                  value = value.substring(std::max(0,(int)value.length()-((int)valueJust[1]-'0')));
+                 }
+              }
+              break;
+            case 'U': //Substring Ux.y where x=firstChar and y=number of characters
+              if (valueJustLength > 1)
+              {
+                if (isDigit(valueJust[1]) && valueJust[2]=='.' && isDigit(valueJust[3]) && valueJust[1] > '0' && valueJust[3] > '0')
+                {
+                  value = value.substring(std::min((int)value.length(),(int)valueJust[1]-'0'-1),(int)valueJust[1]-'0'-1+(int)valueJust[3]-'0');
+                }
+                else
+                {
+                  newString += F("ERR");
+                }
+              }
+              break;
+            default:
+              newString += F("ERR");
+              break;
+          }
+        }
+      }
+      if (rightJustify)
+      {
+        int filler = lineSize - newString.length() - value.length() - remainingLength;
+        for (byte f = 0; f < filler; f++)
+          newString += " ";
+      }
+      {
+        if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+          String logFormatted = F("DEBUG: Formatted String='");
+          logFormatted += newString;
+          logFormatted += value;
+          logFormatted += "'";
+          addLog(LOG_LEVEL_DEBUG, logFormatted);
+        }
+      }
+    }
+  }
+  //end of changes by giig1967g - 2018-04-18
+}
+
 /********************************************************************************************\
   Calculate function for simple expressions
   \*********************************************************************************************/
@@ -1914,35 +1972,461 @@ int Calculate(const char *input, float* result)
 }
 
 
-void checkRuleSets(){
-for (byte x=0; x < RULESETS_MAX; x++){
+/********************************************************************************************\
+  Compiled task value formulas
+  The formula is compiled using the same shunting-yard steps as Calculate(), but the RPN tokens
+  are stored as instructions instead of being evaluated. %value% and %pvalue% become register
+  operands, so no String conversion or parsing is needed on every sensor read.
+  \*********************************************************************************************/
+#define FORMULA_MARKER_VALUE    '\x01'
+#define FORMULA_MARKER_PVALUE   '\x02'
+#define FORMULA_TEXT_SIZE_MAX   256 // Formula with %value% and %pvalue% replaced by their text representation
+
+#define is_formula_marker(c)  (c == FORMULA_MARKER_VALUE || c == FORMULA_MARKER_PVALUE)
+
+// Same as String::replace(), but on a zero terminated char buffer.
+// Returns false when the result does not fit in the buffer.
+bool replaceInBuffer(char* buffer, size_t size, const char* find, const char* replace)
+{
+  const size_t findLength = strlen(find);
+  const size_t replaceLength = strlen(replace);
+  char* pos = strstr(buffer, find);
+  while (pos != NULL) {
+    const size_t tailLength = strlen(pos + findLength);
+    if ((pos - buffer) + replaceLength + tailLength + 1 > size) return false;
+    memmove(pos + replaceLength, pos + findLength, tailLength + 1);
+    memcpy(pos, replace, replaceLength);
+    pos = strstr(pos + replaceLength, find);
+  }
+  return true;
+}
+
+void clearTaskFormulas(byte TaskIndex)
+{
+  if (TaskIndex >= TASKS_MAX) return;
+  for (byte varNr = 0; varNr < VARS_PER_TASK; ++varNr)
+    TaskFormula[TaskIndex][varNr].clear();
+}
+
+void clearTaskFormulas()
+{
+  for (byte TaskIndex = 0; TaskIndex < TASKS_MAX; ++TaskIndex)
+    clearTaskFormulas(TaskIndex);
+}
+
+// Add a token like RPNCalculate() would process it.
+int addFormulaToken(const char* token, TaskFormulaStruct& compiled)
+{
+  if (token[0] == 0)
+    return 0;
+
+  if (is_operator(token[0]) && token[1] == 0) {
+    compiled.program.emplace_back(FORMULA_INSTR_OPERATOR, token[0], 0.0);
+    return 0;
+  }
+  if (is_formula_marker(token[0]) && token[1] == 0) {
+    const byte type = (token[0] == FORMULA_MARKER_VALUE) ? FORMULA_INSTR_VALUE : FORMULA_INSTR_PVALUE;
+    compiled.program.emplace_back(type, 0, 0.0);
+    return 0;
+  }
+  for (const char* c = token; *c != 0; ++c) {
+    if (is_formula_marker(*c)) {
+      // Variable is concatenated with other characters into a single number.
+      compiled.state = FORMULA_USE_TEXT;
+      return 0;
+    }
+  }
+  compiled.program.emplace_back(FORMULA_INSTR_CONST, 0, atof(token));
+  return 0;
+}
+
+#define FORMULA_ADD_TOKEN()  { *(TokenPos) = 0; error = addFormulaToken(token, compiled); TokenPos = token; if (error) return error; if (compiled.state != FORMULA_COMPILED) return 0; }
+
+int compileFormula(const char *input, TaskFormulaStruct& compiled)
+{
+  const char *strpos = input, *strend = input + strlen(input);
+  char token[25];
+  char c, oc, *TokenPos = token;
+  char stack[32];       // operator stack
+  unsigned int sl = 0;  // stack length
+  char     sc;          // used for record stack element
+  int error = 0;
+
+  oc=c=0;
+  while (strpos < strend)
+  {
+    // read one token from the input stream
+    oc = c;
+    c = *strpos;
+    if (c != ' ')
+    {
+      if (is_formula_marker(c) && !is_operator(oc))
+      {
+        // A negative value would be parsed as operator '-' by Calculate()
+        if (c == FORMULA_MARKER_VALUE)
+          compiled.valueSignSensitive = true;
+        else
+          compiled.pvalueSignSensitive = true;
+      }
+      if ((c >= '0' && c <= '9') || c == '.' || (c == '-' && is_operator(oc)) || is_formula_marker(c))
+      {
+        if (TokenPos >= (token + sizeof(token) - 1))
+          return CALCULATE_ERROR_UNKNOWN_TOKEN;
+        *TokenPos = c;
+        ++TokenPos;
+      }
+      else if (is_operator(c))
+      {
+        FORMULA_ADD_TOKEN();
+        while (sl > 0)
+        {
+          sc = stack[sl - 1];
+          if (is_operator(sc) && ((op_left_assoc(c) && (op_preced(c) <= op_preced(sc))) || (op_preced(c) < op_preced(sc))))
+          {
+            *TokenPos = sc;
+            ++TokenPos;
+            FORMULA_ADD_TOKEN();
+            sl--;
+          }
+          else
+            break;
+        }
+        if (sl >= sizeof(stack)) return CALCULATE_ERROR_STACK_OVERFLOW;
+        stack[sl] = c;
+        ++sl;
+      }
+      else if (c == '(')
+      {
+        if (sl >= sizeof(stack)) return CALCULATE_ERROR_STACK_OVERFLOW;
+        stack[sl] = c;
+        ++sl;
+      }
+      else if (c == ')')
+      {
+        bool pe = false;
+        while (sl > 0)
+        {
+          FORMULA_ADD_TOKEN();
+          sc = stack[sl - 1];
+          if (sc == '(')
+          {
+            pe = true;
+            break;
+          }
+          else
+          {
+            *TokenPos = sc;
+            ++TokenPos;
+            sl--;
+          }
+        }
+        if (!pe)
+          return CALCULATE_ERROR_PARENTHESES_MISMATCHED;
+        sl--;
+      }
+      else
+        return CALCULATE_ERROR_UNKNOWN_TOKEN;
+    }
+    ++strpos;
+  }
+  while (sl > 0)
+  {
+    sc = stack[sl - 1];
+    if (sc == '(' || sc == ')')
+      return CALCULATE_ERROR_PARENTHESES_MISMATCHED;
+
+    FORMULA_ADD_TOKEN();
+    *TokenPos = sc;
+    ++TokenPos;
+    --sl;
+  }
+  FORMULA_ADD_TOKEN();
+  return CALCULATE_OK;
+}
+
+void compileTaskFormula(const char* formula, TaskFormulaStruct& compiled)
+{
+  compiled.clear();
+  compiled.state = FORMULA_COMPILED;
+  char text[NAME_FORMULA_LENGTH_MAX + 1];
+  strncpy(text, formula, sizeof(text));
+  text[sizeof(text) - 1] = 0;
+
+  // Same order of replacement as used to be done in SensorSendTask()
+  const char pvalueMarker[2] = { FORMULA_MARKER_PVALUE, 0 };
+  const char valueMarker[2] = { FORMULA_MARKER_VALUE, 0 };
+  replaceInBuffer(text, sizeof(text), "%pvalue%", pvalueMarker);
+  replaceInBuffer(text, sizeof(text), "%value%", valueMarker);
+  compiled.usesPValue = strchr(text, FORMULA_MARKER_PVALUE) != NULL;
+  compiled.usesValue = strchr(text, FORMULA_MARKER_VALUE) != NULL;
+
+  // Calculate() reports the first error it runs into while evaluating, which may depend on the values.
+  // So a formula with errors is left to Calculate(), to return the same error.
+  if (compileFormula(text, compiled) != CALCULATE_OK)
+    compiled.state = FORMULA_USE_TEXT;
+  if (compiled.state != FORMULA_COMPILED)
+    compiled.program.clear();
+  compiled.program.shrink_to_fit();
+}
+
+// Check if the text will be parsed by Calculate() as a single number.
+bool isFormulaNumber(const char* text)
+{
+  if (*text == '-') ++text;
+  if (*text == 0) return false;
+  for (; *text != 0; ++text) {
+    if (!((*text >= '0' && *text <= '9') || *text == '.'))
+      return false;
+  }
+  return true;
+}
+
+/********************************************************************************************\
+  Evaluate the formula of a task value, without String or heap use.
+  The formula is compiled on first use, see clearTaskFormulas() to invalidate.
+  Results are the same as Calculate() on the formula with %value% and %pvalue% replaced by String(value)
+  \*********************************************************************************************/
+int calculateTaskFormula(byte TaskIndex, byte varNr, const char* formula, float value, float pvalue, float* result)
+{
+  if (TaskIndex >= TASKS_MAX || varNr >= VARS_PER_TASK)
+    return CALCULATE_ERROR_UNKNOWN_TOKEN;
+  TaskFormulaStruct& compiled = TaskFormula[TaskIndex][varNr];
+  if (compiled.state == FORMULA_NOT_COMPILED)
+    compileTaskFormula(formula, compiled);
+
+  // Text representation of the values, as String(float) would do.
+  char valueText[33];
+  char pvalueText[33];
+  dtostrf(value, 4, 2, valueText);
+  dtostrf(pvalue, 4, 2, pvalueText);
+
+  bool useText = compiled.state == FORMULA_USE_TEXT;
+  if (compiled.usesValue) {
+    if (!isFormulaNumber(valueText) || (compiled.valueSignSensitive && valueText[0] == '-'))
+      useText = true;
+  }
+  if (compiled.usesPValue) {
+    if (!isFormulaNumber(pvalueText) || (compiled.pvalueSignSensitive && pvalueText[0] == '-'))
+      useText = true;
+  }
+  if (useText) {
+    char text[FORMULA_TEXT_SIZE_MAX];
+    strncpy(text, formula, sizeof(text));
+    text[sizeof(text) - 1] = 0;
+    if (!replaceInBuffer(text, sizeof(text), "%pvalue%", pvalueText) ||
+        !replaceInBuffer(text, sizeof(text), "%value%", valueText))
+      return CALCULATE_ERROR_STACK_OVERFLOW;
+    return Calculate(text, result);
+  }
+
+  const float valueOperand = atof(valueText);
+  const float pvalueOperand = atof(pvalueText);
+  float stack[STACK_SIZE];
+  int top = -1;
+  for (size_t i = 0; i < compiled.program.size(); ++i) {
+    const FormulaInstruction& instr = compiled.program[i];
+    float operand = 0.0;
+    switch (instr.type) {
+      case FORMULA_INSTR_CONST:  operand = instr.value; break;
+      case FORMULA_INSTR_VALUE:  operand = valueOperand; break;
+      case FORMULA_INSTR_PVALUE: operand = pvalueOperand; break;
+      case FORMULA_INSTR_OPERATOR:
+      {
+        // Same as RPNCalculate(), pop from an empty stack returns 0.
+        const float second = (top >= 0) ? stack[top--] : 0.0;
+        const float first = (top >= 0) ? stack[top--] : 0.0;
+        operand = apply_operator(instr.op, first, second);
+        break;
+      }
+    }
+    if (top >= (STACK_SIZE - 1))
+      return CALCULATE_ERROR_STACK_OVERFLOW;
+    stack[++top] = operand;
+  }
+  *result = (top >= 0) ? stack[top] : 0.0;
+  return CALCULATE_OK;
+}
+
+
+String getRulesFileName(byte rulesSet) {
   #if defined(ESP8266)
     String fileName = F("rules");
   #endif
   #if defined(ESP32)
     String fileName = F("/rules");
   #endif
-  fileName += x+1;
+  fileName += rulesSet+1;
   fileName += F(".txt");
+  return fileName;
+}
+
+void checkRuleSets(){
+for (byte x=0; x < RULESETS_MAX; x++){
+  String fileName = getRulesFileName(x);
   if (SPIFFS.exists(fileName))
     activeRuleSets[x] = true;
   else
     activeRuleSets[x] = false;
 
+  // Rules may have changed, so compile them again.
+  rulesSetCache[x].clear();
+  if (activeRuleSets[x])
+    compileRuleSet(x, fileName);
+
   if (Settings.SerialLogLevel == LOG_LEVEL_DEBUG_DEV){
     Serial.print(fileName);
     Serial.print(" ");
-    Serial.println(activeRuleSets[x]);
+    Serial.print(activeRuleSets[x]);
+    Serial.print(F(" cached: "));
+    Serial.println(rulesSetCache[x].cached);
+    }
+  }
+}
+
+
+/********************************************************************************************\
+  Compile a rules set into RAM
+  Only the "on ... do" blocks are kept, without comments, indexed on the event name.
+  The lines are still parsed at runtime, since they may contain [task#value] templates.
+  \*********************************************************************************************/
+bool compileRuleSet(byte rulesSet, const String& fileName)
+{
+  checkRAM(F("compileRuleSet"));
+  RulesSetCacheStruct& cache = rulesSetCache[rulesSet];
+  cache.clear();
+
+  fs::File f = SPIFFS.open(fileName, "r");
+  if (!f) return false;
+  const size_t fileSize = f.size();
+  if (fileSize > 65535 || FreeMem() < (fileSize + RULES_CACHE_MIN_FREE_MEM)) {
+    // Not enough memory, the rules will be read from file for each event.
+    f.close();
+    String log = F("Rules: Not enough memory to cache ");
+    log += fileName;
+    addLog(LOG_LEVEL_ERROR, log);
+    return false;
+  }
+  cache.lines.reserve(fileSize);
+
+  String line = "";
+  bool inBlock = false;
+  byte buf[RULES_BUFFER_SIZE];
+  int len = 0;
+  while (f.available())
+  {
+    len = f.read((byte*)buf, RULES_BUFFER_SIZE);
+    for (int x = 0; x < len; x++) {
+      if (buf[x] != 10) {
+        line += char(buf[x]);
+      } else {
+        // Just like rulesProcessingFile(), only complete lines are processed.
+        addLineToRulesCache(cache, line, inBlock);
+        line = "";
+      }
+    }
+  }
+  f.close();
+  cache.cached = true;
+
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    String log = F("Rules: Compiled ");
+    log += fileName;
+    log += F(" blocks: ");
+    log += cache.blocks.size();
+    log += F(" size: ");
+    log += cache.lines.length();
+    addLog(LOG_LEVEL_INFO, log);
+  }
+  return true;
+}
+
+void addLineToRulesCache(RulesSetCacheStruct& cache, String& line, bool& inBlock)
+{
+  line.replace(F("\r"), "");
+  if (line.startsWith(F("//"))) return;
+
+  // Strip comments
+  int comment = line.indexOf(F("//"));
+  if (comment > 0)
+    line = line.substring(0, comment);
+  line.trim();
+  if (line.length() == 0) return;
+
+  String lcLine = line;
+  lcLine.toLowerCase();
+
+  if (!inBlock) {
+    // Lines outside an "on ... do" block will never be executed.
+    if (!lcLine.startsWith(F("on "))) return;
+
+    RulesBlockStruct block;
+    block.start = cache.lines.length();
+    const int split = lcLine.indexOf(F(" do"), 3);
+    if (split == -1) {
+      // Malformed "on" line, leave the matching to ruleMatch()
+      block.alwaysCheck = true;
+      inBlock = true;
+    } else {
+      String eventTrigger = lcLine.substring(3, split);
+      block.alwaysCheck = eventTrigger == "*" ||
+                          eventTrigger.indexOf('[') != -1 ||
+                          eventTrigger.indexOf('%') != -1;
+      block.eventNameHash = rulesEventNameHash(eventTrigger, true);
+      String action = line.substring(split + 4);
+      action.trim();
+      // No action on the same line means a block of actions until "endon"
+      inBlock = action.length() == 0;
     }
+    cache.lines += line;
+    cache.lines += '\n';
+    block.end = cache.lines.length();
+    cache.blocks.push_back(block);
+    return;
   }
+
+  cache.lines += line;
+  cache.lines += '\n';
+  cache.blocks.back().end = cache.lines.length();
+  if (lcLine == F("endon"))
+    inBlock = false;
+}
+
+/********************************************************************************************\
+  Hash of the event name, used to select the rule blocks which may match an event.
+  Must use the same event name as ruleMatch() does, e.g. "clock#time" for "Clock#Time=Mon,12:00"
+  \*********************************************************************************************/
+uint16_t rulesEventNameHash(const String& str, bool isRule)
+{
+  int nameLength = str.length();
+  int pos = -1;
+  if (isRule) {
+    // Same order of compare operators as ruleMatch()
+    pos = str.indexOf('>');
+    if (pos <= 0) pos = str.indexOf('<');
+    if (pos <= 0) pos = str.indexOf('=');
+  } else {
+    pos = str.indexOf('=');
+  }
+  if (pos > 0) nameLength = pos;
+
+  // FNV-1a, folded to 16 bit.
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < nameLength; ++i) {
+    hash ^= static_cast<uint8_t>(tolower(str[i]));
+    hash *= 16777619u;
+  }
+  return (hash >> 16) ^ (hash & 0xFFFF);
 }
 
 
 /********************************************************************************************\
   Rules processing
   \*********************************************************************************************/
+byte rulesNestingLevel = 0;
+
 void rulesProcessing(String& event)
 {
+  START_TIMER;
   checkRAM(F("rulesProcessing"));
   unsigned long timer = millis();
   if (loglevelActiveFor(LOG_LEVEL_INFO)) {
@@ -1953,16 +2437,10 @@ void rulesProcessing(String& event)
 
   for (byte x = 0; x < RULESETS_MAX; x++)
   {
-    #if defined(ESP8266)
-      String fileName = F("rules");
-    #endif
-    #if defined(ESP32)
-      String fileName = F("/rules");
-    #endif
-    fileName += x+1;
-    fileName += F(".txt");
-    if(activeRuleSets[x])
-      rulesProcessingFile(fileName, event);
+    if (rulesSetCache[x].cached)
+      rulesProcessingCache(x, event);
+    else if(activeRuleSets[x])
+      rulesProcessingFile(getRulesFileName(x), event);
   }
 
   if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
@@ -1973,7 +2451,7 @@ void rulesProcessing(String& event)
     log += F(" milliSeconds");
     addLog(LOG_LEVEL_DEBUG, log);
   }
-
+  STOP_TIMER(RULES_PROCESSING);
 }
 
 /********************************************************************************************\
@@ -1988,15 +2466,14 @@ String rulesProcessingFile(String fileName, String& event)
     Serial.println(F("     flags CMI  parse output:"));
   }
 
-  static byte nestingLevel = 0;
   int data = 0;
   String log = "";
 
-  nestingLevel++;
-  if (nestingLevel > RULES_MAX_NESTING_LEVEL)
+  rulesNestingLevel++;
+  if (rulesNestingLevel > RULES_MAX_NESTING_LEVEL)
   {
     addLog(LOG_LEVEL_ERROR, F("EVENT: Error: Nesting level exceeded!"));
-    nestingLevel--;
+    rulesNestingLevel--;
     return (log);
   }
 
@@ -2042,11 +2519,68 @@ String rulesProcessingFile(String fileName, String& event)
     }
   }
 
-  nestingLevel--;
+  rulesNestingLevel--;
   checkRAM(F("rulesProcessingFile2"));
   return (F(""));
 }
 
+/********************************************************************************************\
+  Rules processing using the compiled rules set
+  Only blocks with a matching event name hash (or a wildcard) are evaluated.
+  \*********************************************************************************************/
+void rulesProcessingCache(byte rulesSet, String& event)
+{
+  checkRAM(F("rulesProcessingCache"));
+  rulesNestingLevel++;
+  if (rulesNestingLevel > RULES_MAX_NESTING_LEVEL)
+  {
+    addLog(LOG_LEVEL_ERROR, F("EVENT: Error: Nesting level exceeded!"));
+    rulesNestingLevel--;
+    return;
+  }
+
+  // Literal string events use a prefix match on the rule, so check all blocks.
+  const bool checkAll = event.charAt(0) == '!';
+  const uint16_t eventNameHash = rulesEventNameHash(event, false);
+  String log = "";
+  String line = "";
+
+  // The rules set may be compiled again while processing, so check bounds on every iteration.
+  for (size_t b = 0; b < rulesSetCache[rulesSet].blocks.size(); ++b)
+  {
+    const RulesBlockStruct block = rulesSetCache[rulesSet].blocks[b];
+    if (!checkAll && !block.alwaysCheck && block.eventNameHash != eventNameHash)
+      continue;
+
+    bool match = false;
+    bool codeBlock = false;
+    bool isCommand = false;
+    bool conditional = false;
+    bool condition = false;
+    bool ifBranche = false;
+    bool ifBrancheJustMatch = false;
+
+    int pos = block.start;
+    while (pos < block.end)
+    {
+      const String& lines = rulesSetCache[rulesSet].lines;
+      int lineEnd = lines.indexOf('\n', pos);
+      if (lineEnd < 0 || lineEnd > block.end) lineEnd = block.end;
+      line = lines.substring(pos, lineEnd);
+      pos = lineEnd + 1;
+
+      parseCompleteNonCommentLine(
+        line, event, log,
+        match, codeBlock, isCommand,
+        conditional, condition,
+        ifBranche, ifBrancheJustMatch);
+      if (!match) break; // Event did not match the "on" line, or the block has ended.
+    }
+  }
+
+  rulesNestingLevel--;
+}
+
 void parseCompleteNonCommentLine(
     String& line,
     String& event,
@@ -2542,15 +3076,15 @@ void rulesTimers()
 
 void createRuleEvents(byte TaskIndex)
 {
-  LoadTaskSettings(TaskIndex);
+  const TaskSettingsCacheStruct& cache = getTaskSettingsCache(TaskIndex);
   byte BaseVarIndex = TaskIndex * VARS_PER_TASK;
   byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
   byte sensorType = Device[DeviceIndex].VType;
   for (byte varNr = 0; varNr < Device[DeviceIndex].ValueCount; varNr++)
   {
-    String eventString = getTaskDeviceName(TaskIndex);
+    String eventString = cache.TaskDeviceName;
     eventString += F("#");
-    eventString += ExtraTaskSettings.TaskDeviceValueNames[varNr];
+    eventString += cache.TaskDeviceValueNames[varNr];
     eventString += F("=");
 
     if (sensorType == SENSOR_TYPE_LONG)
@@ -2572,7 +3106,7 @@ void SendValueLogger(byte TaskIndex)
 
   String logger;
   if (featureSD || loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-    LoadTaskSettings(TaskIndex);
+    const TaskSettingsCacheStruct& cache = getTaskSettingsCache(TaskIndex);
     byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
     for (byte varNr = 0; varNr < Device[DeviceIndex].ValueCount; varNr++)
     {
@@ -2582,9 +3116,9 @@ void SendValueLogger(byte TaskIndex)
       logger += F(",");
       logger += Settings.Unit;
       logger += F(",");
-      logger += getTaskDeviceName(TaskIndex);
+      logger += cache.TaskDeviceName;
       logger += F(",");
-      logger += ExtraTaskSettings.TaskDeviceValueNames[varNr];
+      logger += cache.TaskDeviceValueNames[varNr];
       logger += F(",");
       logger += formatUserVarNoCheck(TaskIndex, varNr);
       logger += F("\r\n");
@@ -4,31 +4,154 @@
 #define CONST_INTERVAL_TIMER 1
 #define PLUGIN_TASK_TIMER    2
 #define TASK_DEVICE_TIMER    3
+#define SEND_DATA_TIMER      4
 
-#include <list>
 struct EventStructCommandWrapper {
   EventStructCommandWrapper() : id(0) {}
   EventStructCommandWrapper(unsigned long i, const struct EventStruct& e) : id(i), event(e) {}
 
+  bool isDuplicate(unsigned long i, const struct EventStruct& e, const String& c, const String& l) const {
+    return id == i &&
+           event.TaskIndex == e.TaskIndex && event.Source == e.Source &&
+           event.Par1 == e.Par1 && event.Par2 == e.Par2 && event.Par3 == e.Par3 &&
+           event.Par4 == e.Par4 && event.Par5 == e.Par5 &&
+           event.String1 == e.String1 && event.String2 == e.String2 && event.String3 == e.String3 &&
+           event.String4 == e.String4 && event.String5 == e.String5 &&
+           cmd == c && line == l;
+  }
+
   unsigned long id;
   String cmd;
   String line;
   struct EventStruct event;
 };
-std::list<EventStructCommandWrapper> EventQueue;
+
+/*********************************************************************************************\
+ * System event queue
+ * Fixed number of preallocated slots, with a ring buffer of slot numbers per priority.
+ * The slots are reused, so their String members do not need to be re-allocated for every event.
+ * When full, the oldest event of a lower priority is dropped to make room, or else the new event.
+ * Only exact duplicates are coalesced, since for example all MQTT messages received
+ * for a controller share the same mixed ID.
+\*********************************************************************************************/
+#ifndef EVENT_QUEUE_MAX
+  #if defined(ESP32)
+    #define EVENT_QUEUE_MAX          32
+  #else
+    #define EVENT_QUEUE_MAX          16
+  #endif
+#endif
+#define EVENT_QUEUE_BATCH_SIZE_DFLT   4  // Used when Settings.EventQueueBatchSize is 0
+
+#define EVENT_PRIORITY_COMMAND        0
+#define EVENT_PRIORITY_CONTROLLER     1
+#define EVENT_PRIORITY_PLUGIN         2
+#define EVENT_PRIORITY_NR             3
+
+struct SystemEventQueueStruct {
+  SystemEventQueueStruct() : _processing(false), max_length(0), dropped(0), coalesced(0) {
+    for (byte prio = 0; prio < EVENT_PRIORITY_NR; ++prio) {
+      _head[prio] = 0;
+      _size[prio] = 0;
+    }
+    for (byte i = 0; i < EVENT_QUEUE_MAX; ++i) {
+      _free[i] = i;
+    }
+    _nr_free = EVENT_QUEUE_MAX;
+  }
+
+  // Returns false when the event is a duplicate or could not be queued.
+  bool add(byte priority, unsigned long id, const struct EventStruct& event,
+                                 const String& cmd, const String& line) {
+    for (byte i = 0; i < _size[priority]; ++i) {
+      if (_slots[slotAt(priority, i)].isDuplicate(id, event, cmd, line)) {
+        ++coalesced;
+        return false;
+      }
+    }
+    if (_nr_free == 0) {
+      // Make room by dropping the oldest event with the lowest priority below this one.
+      byte prio = EVENT_PRIORITY_NR - 1;
+      while (prio > priority && _size[prio] == 0) --prio;
+      ++dropped;
+      if (prio <= priority) return false;
+      releaseSlot(popFront(prio));
+    }
+    const byte slot = _free[--_nr_free];
+    _ring[priority][(_head[priority] + _size[priority]) % EVENT_QUEUE_MAX] = slot;
+    ++_size[priority];
+    const byte length = size();
+    if (length > max_length) max_length = length;
+    EventStructCommandWrapper& wrapper = _slots[slot];
+    wrapper.id = id;
+    wrapper.event = event;
+    wrapper.cmd = cmd;
+    wrapper.line = line;
+    return true;
+  }
+
+  // Remove the event with the highest priority from the queue and return its slot.
+  // The slot must be released after processing, so it cannot be overwritten in the mean time.
+  int takeNext() {
+    for (byte prio = 0; prio < EVENT_PRIORITY_NR; ++prio) {
+      if (_size[prio] != 0) {
+        return popFront(prio);
+      }
+    }
+    return -1;
+  }
+
+  EventStructCommandWrapper& get(byte slot) {
+    return _slots[slot];
+  }
+
+  void releaseSlot(byte slot) {
+    _free[_nr_free++] = slot;
+  }
+
+  byte size() const {
+    return EVENT_QUEUE_MAX - _nr_free;
+  }
+
+  bool _processing;
+  byte max_length;
+  unsigned long dropped;
+  unsigned long coalesced;
+
+private:
+  byte slotAt(byte prio, byte i) const {
+    return _ring[prio][(_head[prio] + i) % EVENT_QUEUE_MAX];
+  }
+
+  byte popFront(byte prio) {
+    const byte slot = _ring[prio][_head[prio]];
+    _head[prio] = (_head[prio] + 1) % EVENT_QUEUE_MAX;
+    --_size[prio];
+    return slot;
+  }
+
+  EventStructCommandWrapper _slots[EVENT_QUEUE_MAX];
+  byte _ring[EVENT_PRIORITY_NR][EVENT_QUEUE_MAX];
+  byte _head[EVENT_PRIORITY_NR];
+  byte _size[EVENT_PRIORITY_NR];
+  byte _free[EVENT_QUEUE_MAX];
+  byte _nr_free;
+} EventQueue;
 
 
 /*********************************************************************************************\
  * Generic Timer functions.
 \*********************************************************************************************/
-void setTimer(unsigned long timerType, unsigned long id, unsigned long msecFromNow) {
-  setNewTimerAt(getMixedId(timerType, id), millis() + msecFromNow);
+// False when the timer could not be set, all timers are in use.
+bool setTimer(unsigned long timerType, unsigned long id, unsigned long msecFromNow) {
+  return setNewTimerAt(getMixedId(timerType, id), millis() + msecFromNow);
 }
 
-void setNewTimerAt(unsigned long id, unsigned long timer) {
+bool setNewTimerAt(unsigned long id, unsigned long timer) {
   START_TIMER;
-  msecTimerHandler.registerAt(id, timer);
+  const bool success = msecTimerHandler.registerAt(id, timer);
   STOP_TIMER(SET_NEW_TIMER);
+  return success;
 }
 
 // Mix timer type int with an ID describing the scheduled job.
@@ -63,6 +186,9 @@ void handle_schedule() {
     case TASK_DEVICE_TIMER:
       process_task_device_timer(id, timer);
       break;
+    case SEND_DATA_TIMER:
+      processSendDataQueue(false);
+      break;
   }
 }
 
@@ -152,7 +278,10 @@ void setPluginTaskTimer(unsigned long timer, byte plugin, short taskIndex, int P
   timer_data.Par4 = Par4;
   timer_data.Par5 = Par5;
   systemTimers[systemTimerId] = timer_data;
-  setTimer(PLUGIN_TASK_TIMER, systemTimerId, timer);
+  if (!setTimer(PLUGIN_TASK_TIMER, systemTimerId, timer)) {
+    // Never processed, so never erased by process_plugin_task_timer().
+    systemTimers.erase(systemTimerId);
+  }
 }
 
 void process_plugin_task_timer(unsigned long id) {
@@ -179,7 +308,9 @@ void process_plugin_task_timer(unsigned long id) {
 */
   if (y >= 0) {
     String dummy;
+    START_TIMER;
     Plugin_ptr[y](PLUGIN_TIMER_IN, &TempEvent, dummy);
+    STOP_TIMER_TASK(timer_data.TaskIndex, PLUGIN_TIMER_IN);
   }
   systemTimers.erase(id);
   STOP_TIMER(PROC_SYS_TIMER);
@@ -241,6 +372,14 @@ void process_task_device_timer(unsigned long task_index, unsigned long lasttimer
   STOP_TIMER(SENSOR_SEND_TASK);
 }
 
+/*********************************************************************************************\
+ * Send Data Timer
+ * Runs processSendDataQueue() to send queued task values to the controllers.
+\*********************************************************************************************/
+void schedule_send_data_timer(unsigned long runAt) {
+  setNewTimerAt(getMixedId(SEND_DATA_TIMER, 1), runAt);
+}
+
 /*********************************************************************************************\
  * System Event Timer
  * Handling of these events will be asynchronous and being called from the loop().
@@ -265,21 +404,16 @@ void schedule_command_timer(const char * cmd, struct EventStruct *event, const c
   String lineStr;
   lineStr += line;
   // Using CRC here based on the cmd AND line, to make sure other commands are
-  // not removed from the queue,  since the ID used in the queue must be unique.
+  // not coalesced in the queue, since the ID used in the queue must be unique.
   const int crc = calc_CRC16(cmdStr) ^ calc_CRC16(lineStr);
   const unsigned long mixedId = createSystemEventMixedId(CommandTimerEnum, static_cast<uint16_t>(crc));
-  EventStructCommandWrapper eventWrapper(mixedId, *event);
-  eventWrapper.cmd = cmdStr;
-  eventWrapper.line = lineStr;
-  EventQueue.push_back(eventWrapper);
+  EventQueue.add(EVENT_PRIORITY_COMMAND, mixedId, *event, cmdStr, lineStr);
 }
 
 void schedule_event_timer(PluginPtrType ptr_type, byte Index, byte Function, struct EventStruct* event) {
   const unsigned long mixedId = createSystemEventMixedId(ptr_type, Index, Function);
-//  EventStructCommandWrapper eventWrapper(mixedId, *event);
-//  EventQueue.push_back(eventWrapper);
-  EventQueue.emplace_back(mixedId, *event);
-
+  const byte priority = (ptr_type == ControllerPluginEnum) ? EVENT_PRIORITY_CONTROLLER : EVENT_PRIORITY_PLUGIN;
+  EventQueue.add(priority, mixedId, *event, dummyString, dummyString);
 }
 
 unsigned long createSystemEventMixedId(PluginPtrType ptr_type, uint16_t crc16) {
@@ -295,39 +429,52 @@ unsigned long createSystemEventMixedId(PluginPtrType ptr_type, byte Index, byte
   return getMixedId(SYSTEM_EVENT_QUEUE, subId);
 }
 
+bool systemEventQueueEmpty() {
+  return EventQueue.size() == 0;
+}
+
 void process_system_event_queue() {
-  if (EventQueue.size() == 0) return;
-  unsigned long id = EventQueue.front().id;
-  byte Function = id & 0xFF;
-  byte Index = (id >> 8) & 0xFF;
-  PluginPtrType ptr_type = static_cast<PluginPtrType>((id >> 16) & 0xFF);
-  // At this moment, the String is not being used in the plugin calls, so just supply a dummy String.
-  // Also since these events will be processed asynchronous, the resulting
-  //   output in the String is probably of no use elsewhere.
-  // Else the line string could be used.
-  String tmpString;
-  switch (ptr_type) {
-    case TaskPluginEnum:
-      LoadTaskSettings(EventQueue.front().event.TaskIndex);
-      Plugin_ptr[Index](Function, &EventQueue.front().event, tmpString);
-      break;
-    case ControllerPluginEnum:
-      CPlugin_ptr[Index](Function, &EventQueue.front().event, tmpString);
-      break;
-    case NotificationPluginEnum:
-      NPlugin_ptr[Index](Function, &EventQueue.front().event, tmpString);
-      break;
-    case CommandTimerEnum:
-      {
-        String status = doExecuteCommand(
-            EventQueue.front().cmd.c_str(),
-            &EventQueue.front().event,
-            EventQueue.front().line.c_str());
-        yield();
-        SendStatus(EventQueue.front().event.Source, status);
-        yield();
+  if (EventQueue.size() == 0 || EventQueue._processing) return;
+  EventQueue._processing = true;
+  byte batchSize = Settings.EventQueueBatchSize;
+  if (batchSize == 0) batchSize = EVENT_QUEUE_BATCH_SIZE_DFLT;
+  for (byte processed = 0; processed < batchSize; ++processed) {
+    const int slot = EventQueue.takeNext();
+    if (slot < 0) break;
+    EventStructCommandWrapper& wrapper = EventQueue.get(slot);
+    const unsigned long id = wrapper.id;
+    byte Function = id & 0xFF;
+    byte Index = (id >> 8) & 0xFF;
+    PluginPtrType ptr_type = static_cast<PluginPtrType>((id >> 16) & 0xFF);
+    // At this moment, the String is not being used in the plugin calls, so just supply a dummy String.
+    // Also since these events will be processed asynchronous, the resulting
+    //   output in the String is probably of no use elsewhere.
+    // Else the line string could be used.
+    String tmpString;
+    switch (ptr_type) {
+      case TaskPluginEnum:
+        LoadTaskSettings(wrapper.event.TaskIndex);
+        Plugin_ptr[Index](Function, &wrapper.event, tmpString);
         break;
-      }
+      case ControllerPluginEnum:
+        CPlugin_ptr[Index](Function, &wrapper.event, tmpString);
+        break;
+      case NotificationPluginEnum:
+        NPlugin_ptr[Index](Function, &wrapper.event, tmpString);
+        break;
+      case CommandTimerEnum:
+        {
+          String status = doExecuteCommand(
+              wrapper.cmd.c_str(),
+              &wrapper.event,
+              wrapper.line.c_str());
+          yield();
+          SendStatus(wrapper.event.Source, status);
+          yield();
+          break;
+        }
+    }
+    EventQueue.releaseSlot(slot);
   }
-  EventQueue.pop_front();
+  EventQueue._processing = false;
 }
@@ -129,6 +129,21 @@ String toString(float value, byte decimals)
   return sValue;
 }
 
+// Same as toString(), written to buf of at least FORMAT_VALUE_BUFFER_SIZE bytes.
+void toString(float value, byte decimals, char* buf)
+{
+  // Like String(value, decimals)
+  dtostrf(value, (decimals + 2), decimals, buf);
+  int start = 0;
+  while (buf[start] == ' ')
+    ++start;
+  int end = strlen(buf);
+  while (end > start && buf[end - 1] == ' ')
+    --end;
+  memmove(buf, buf + start, end - start);
+  buf[end - start] = 0;
+}
+
 String toString(WiFiMode_t mode)
 {
   String result = F("Undefinited");
@@ -160,22 +175,34 @@ String toString(bool value) {
    Format a value to the set number of decimals
   \*********************************************************************************************/
 String doFormatUserVar(byte TaskIndex, byte rel_index, bool mustCheck, bool& isvalid) {
-  isvalid = true;
-  const byte BaseVarIndex = TaskIndex * VARS_PER_TASK;
+  char buf[FORMAT_VALUE_BUFFER_SIZE];
+  isvalid = doFormatUserVar(TaskIndex, rel_index, mustCheck, buf);
+  return String(buf);
+}
+
+// Writes the value to buf of at least FORMAT_VALUE_BUFFER_SIZE bytes, returns isvalid.
+bool doFormatUserVar(byte TaskIndex, byte rel_index, bool mustCheck, char* buf) {
+  return doFormatUserVar(&UserVar[TaskIndex * VARS_PER_TASK], TaskIndex, rel_index, mustCheck, buf);
+}
+
+// values holds the VARS_PER_TASK values of the task.
+bool doFormatUserVar(const float* values, byte TaskIndex, byte rel_index, bool mustCheck, char* buf) {
+  buf[0] = 0;
   const byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
   if (Device[DeviceIndex].ValueCount <= rel_index) {
-    isvalid = false;
     String log = F("No sensor value for TaskIndex: ");
     log += TaskIndex;
     log += F(" varnumber: ");
     log += rel_index;
     addLog(LOG_LEVEL_ERROR, log);
-    return "";
+    return false;
   }
   if (Device[DeviceIndex].VType == SENSOR_TYPE_LONG) {
-    return String((unsigned long)UserVar[BaseVarIndex] + ((unsigned long)UserVar[BaseVarIndex + 1] << 16));
+    ultoa((unsigned long)values[0] + ((unsigned long)values[1] << 16), buf, 10);
+    return true;
   }
-  float f(UserVar[BaseVarIndex + rel_index]);
+  bool isvalid = true;
+  float f(values[rel_index]);
   if (mustCheck && !isValidFloat(f)) {
     isvalid = false;
     String log = F("Invalid float value for TaskIndex: ");
@@ -185,7 +212,11 @@ String doFormatUserVar(byte TaskIndex, byte rel_index, bool mustCheck, bool& isv
     addLog(LOG_LEVEL_DEBUG, log);
     f = 0;
   }
-  return toString(f, ExtraTaskSettings.TaskDeviceValueDecimals[rel_index]);
+  if (ExtraTaskSettings.TaskIndex == TaskIndex)
+    toString(f, ExtraTaskSettings.TaskDeviceValueDecimals[rel_index], buf);
+  else
+    toString(f, getTaskSettingsCache(TaskIndex).TaskDeviceValueDecimals[rel_index], buf);
+  return isvalid;
 }
 
 String formatUserVarNoCheck(byte TaskIndex, byte rel_index) {
@@ -199,12 +230,22 @@ String formatUserVar(byte TaskIndex, byte rel_index, bool& isvalid) {
 
 String formatUserVarNoCheck(struct EventStruct *event, byte rel_index)
 {
-  return formatUserVarNoCheck(event->TaskIndex, rel_index);
+  char buf[FORMAT_VALUE_BUFFER_SIZE];
+  doFormatUserVar(getEventValues(event), event->TaskIndex, rel_index, false, buf);
+  return String(buf);
+}
+
+// Without allocating a String, buf must hold FORMAT_VALUE_BUFFER_SIZE bytes.
+void formatUserVarNoCheck(struct EventStruct *event, byte rel_index, char* buf)
+{
+  doFormatUserVar(getEventValues(event), event->TaskIndex, rel_index, false, buf);
 }
 
 String formatUserVar(struct EventStruct *event, byte rel_index, bool& isvalid)
 {
-  return formatUserVar(event->TaskIndex, rel_index, isvalid);
+  char buf[FORMAT_VALUE_BUFFER_SIZE];
+  isvalid = doFormatUserVar(getEventValues(event), event->TaskIndex, rel_index, true, buf);
+  return String(buf);
 }
 
 /*********************************************************************************************\
@@ -472,98 +513,267 @@ void parseSpecialCharacters(String& s, boolean useURLencode)
   }
 }
 
-// Simple macro to create the replacement string only when needed.
-#define SMART_REPL(T,S) if (s.indexOf(T) != -1) { repl((T), (S), s, useURLencode);}
-#define SMART_REPL_T(T,S) if (s.indexOf(T) != -1) { (S((T), s, useURLencode));}
-void parseSystemVariables(String& s, boolean useURLencode)
+/********************************************************************************************\
+  System variables like %sysname%, %systime%, %ip%
+  The names are looked up in a table sorted on name (strcmp order), so the string is
+  scanned only once and a value is only computed for the variables actually used.
+  \*********************************************************************************************/
+#define SYSTEM_VARIABLE_NAME_MAX   12 // Longest name in SystemVariableNames
+#define SYSTEM_VARIABLE_TOKEN_MAX  20 // Longer to allow offsets like %sunrise-30m%
+
+enum SystemVariableId {
+  SV_CR,
+  SV_LF,
+  SV_N_ESC,
+  SV_R_ESC,
+  SV_SP,
+  SV_BSSID,
+  SV_IP,
+  SV_IP4,
+  SV_LCLTIME,
+  SV_LCLTIME_AM,
+  SV_MAC,
+  SV_MAC_INT,
+  SV_RSSI,
+  SV_SSID,
+  SV_SYSDAY,
+  SV_SYSDAY_0,
+  SV_SYSHEAP,
+  SV_SYSHOUR,
+  SV_SYSHOUR_0,
+  SV_SYSLOAD,
+  SV_SYSMIN,
+  SV_SYSMIN_0,
+  SV_SYSMONTH,
+  SV_SYSMONTH_0,
+  SV_SYSNAME,
+  SV_SYSSEC,
+  SV_SYSSEC_0,
+  SV_SYSSEC_D,
+  SV_SYSTIME,
+  SV_SYSTIME_AM,
+  SV_SYSTM_HM,
+  SV_SYSTM_HM_AM,
+  SV_SYSWEEKDAY,
+  SV_SYSWEEKDAY_S,
+  SV_SYSYEAR,
+  SV_SYSYEAR_0,
+  SV_SYSYEARS,
+  SV_UNIT,
+  SV_UNIXTIME,
+  SV_UPTIME,
+  SV_VCC,
+  SV_WI_CH
+};
+
+struct SystemVariableStruct {
+  char name[SYSTEM_VARIABLE_NAME_MAX + 1];
+  byte id;
+};
+
+// Must be kept sorted on name.
+const SystemVariableStruct SystemVariableNames[] PROGMEM = {
+  {"CR",            SV_CR},
+  {"LF",            SV_LF},
+  {"N",             SV_N_ESC},
+  {"R",             SV_R_ESC},
+  {"SP",            SV_SP},
+  {"bssid",         SV_BSSID},
+  {"ip",            SV_IP},
+  {"ip4",           SV_IP4},
+  {"lcltime",       SV_LCLTIME},
+  {"lcltime_am",    SV_LCLTIME_AM},
+  {"mac",           SV_MAC},
+  {"mac_int",       SV_MAC_INT},
+  {"rssi",          SV_RSSI},
+  {"ssid",          SV_SSID},
+  {"sysday",        SV_SYSDAY},
+  {"sysday_0",      SV_SYSDAY_0},
+  {"sysheap",       SV_SYSHEAP},
+  {"syshour",       SV_SYSHOUR},
+  {"syshour_0",     SV_SYSHOUR_0},
+  {"sysload",       SV_SYSLOAD},
+  {"sysmin",        SV_SYSMIN},
+  {"sysmin_0",      SV_SYSMIN_0},
+  {"sysmonth",      SV_SYSMONTH},
+  {"sysmonth_0",    SV_SYSMONTH_0},
+  {"sysname",       SV_SYSNAME},
+  {"syssec",        SV_SYSSEC},
+  {"syssec_0",      SV_SYSSEC_0},
+  {"syssec_d",      SV_SYSSEC_D},
+  {"systime",       SV_SYSTIME},
+  {"systime_am",    SV_SYSTIME_AM},
+  {"systm_hm",      SV_SYSTM_HM},
+  {"systm_hm_am",   SV_SYSTM_HM_AM},
+  {"sysweekday",    SV_SYSWEEKDAY},
+  {"sysweekday_s",  SV_SYSWEEKDAY_S},
+  {"sysyear",       SV_SYSYEAR},
+  {"sysyear_0",     SV_SYSYEAR_0},
+  {"sysyears",      SV_SYSYEARS},
+  {"unit",          SV_UNIT},
+  {"unixtime",      SV_UNIXTIME},
+  {"uptime",        SV_UPTIME},
+  {"vcc",           SV_VCC},
+  {"wi_ch",         SV_WI_CH},
+};
+
+// Returns the id of the system variable, or -1 when not found.
+int findSystemVariable(const char* name)
 {
-  parseSpecialCharacters(s, useURLencode);
-  if (s.indexOf('%') == -1)
-    return; // Nothing to replace
-
-  #if FEATURE_ADC_VCC
-    repl(F("%vcc%"), String(vcc), s, useURLencode);
-  #endif
-  repl(F("%CR%"), F("\r"), s, useURLencode);
-  repl(F("%LF%"), F("\n"), s, useURLencode);
-  repl(F("%SP%"), F(" "), s, useURLencode); //space
-  repl(F("%R%"), F("\\r"), s, useURLencode);
-  repl(F("%N%"), F("\\n"), s, useURLencode);
-  SMART_REPL(F("%ip4%"),WiFi.localIP().toString().substring(WiFi.localIP().toString().lastIndexOf('.')+1)) //4th IP octet
-  SMART_REPL(F("%ip%"),WiFi.localIP().toString())
-  SMART_REPL(F("%rssi%"), String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.RSSI()))
-  SMART_REPL(F("%ssid%"), (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("--") : WiFi.SSID())
-  SMART_REPL(F("%bssid%"), (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("00:00:00:00:00:00") : WiFi.BSSIDstr())
-  SMART_REPL(F("%wi_ch%"), String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.channel()))
-  SMART_REPL(F("%unit%"), String(Settings.Unit))
-  SMART_REPL(F("%mac%"), String(WiFi.macAddress()))
-  #if defined(ESP8266)
-    SMART_REPL(F("%mac_int%"), String(ESP.getChipId()))  // Last 24 bit of MAC address as integer, to be used in rules.
-  #endif
-
-  if (s.indexOf(F("%sys")) != -1) {
-    SMART_REPL(F("%sysload%"), String(getCPUload()))
-    SMART_REPL(F("%sysheap%"), String(ESP.getFreeHeap()));
-    SMART_REPL(F("%systm_hm%"), getTimeString(':', false))
-    SMART_REPL(F("%systm_hm_am%"), getTimeString_ampm(':', false))
-    SMART_REPL(F("%systime%"), getTimeString(':'))
-    SMART_REPL(F("%systime_am%"), getTimeString_ampm(':'))
-    repl(F("%sysname%"), Settings.Name, s, useURLencode);
-
-    // valueString is being used by the macro.
-    char valueString[5];
-    #define SMART_REPL_TIME(T,F,V) if (s.indexOf(T) != -1) { sprintf_P(valueString, (F), (V)); repl((T),valueString, s, useURLencode);}
-    SMART_REPL_TIME(F("%sysyear%"), PSTR("%d"), year())
-    SMART_REPL_TIME(F("%sysmonth%"),PSTR("%d"), month())
-    SMART_REPL_TIME(F("%sysday%"), PSTR("%d"), day())
-    SMART_REPL_TIME(F("%syshour%"), PSTR("%d"), hour())
-    SMART_REPL_TIME(F("%sysmin%"), PSTR("%d"), minute())
-    SMART_REPL_TIME(F("%syssec%"),PSTR("%d"), second())
-    SMART_REPL_TIME(F("%syssec_d%"),PSTR("%d"), ((hour()*60) + minute())*60 + second());
-    SMART_REPL(F("%sysweekday%"), String(weekday()))
-    SMART_REPL(F("%sysweekday_s%"), weekday_str())
+  int first = 0;
+  int last = (sizeof(SystemVariableNames) / sizeof(SystemVariableStruct)) - 1;
+  while (first <= last) {
+    const int mid = (first + last) / 2;
+    const int cmp = strcmp_P(name, SystemVariableNames[mid].name);
+    if (cmp == 0)
+      return pgm_read_byte(&SystemVariableNames[mid].id);
+    if (cmp < 0)
+      last = mid - 1;
+    else
+      first = mid + 1;
+  }
+  return -1;
+}
 
+bool getSystemVariableValue(byte id, String& value)
+{
+  char valueString[5];
+  switch (id) {
+    case SV_CR:          value = F("\r"); break;
+    case SV_LF:          value = F("\n"); break;
+    case SV_SP:          value = F(" "); break;
+    case SV_R_ESC:       value = F("\\r"); break;
+    case SV_N_ESC:       value = F("\\n"); break;
+    case SV_VCC:
+      #if FEATURE_ADC_VCC
+        value = String(vcc);
+        break;
+      #else
+        return false;
+      #endif
+    case SV_IP4:         value = String(WiFi.localIP()[3]); break; //4th IP octet
+    case SV_IP:          value = WiFi.localIP().toString(); break;
+    case SV_RSSI:        value = String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.RSSI()); break;
+    case SV_SSID:        value = (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("--") : WiFi.SSID(); break;
+    case SV_BSSID:       value = (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("00:00:00:00:00:00") : WiFi.BSSIDstr(); break;
+    case SV_WI_CH:       value = String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.channel()); break;
+    case SV_UNIT:        value = String(Settings.Unit); break;
+    case SV_MAC:         value = WiFi.macAddress(); break;
+    case SV_MAC_INT:
+      #if defined(ESP8266)
+        value = String(ESP.getChipId()); // Last 24 bit of MAC address as integer, to be used in rules.
+        break;
+      #else
+        return false;
+      #endif
+    case SV_SYSLOAD:     value = String(getCPUload()); break;
+    case SV_SYSHEAP:     value = String(ESP.getFreeHeap()); break;
+    case SV_SYSTM_HM:    value = getTimeString(':', false); break;
+    case SV_SYSTM_HM_AM: value = getTimeString_ampm(':', false); break;
+    case SV_SYSTIME:     value = getTimeString(':'); break;
+    case SV_SYSTIME_AM:  value = getTimeString_ampm(':'); break;
+    case SV_SYSNAME:     value = Settings.Name; break;
+    case SV_SYSYEAR:     value = String(year()); break;
+    case SV_SYSMONTH:    value = String(month()); break;
+    case SV_SYSDAY:      value = String(day()); break;
+    case SV_SYSHOUR:     value = String(hour()); break;
+    case SV_SYSMIN:      value = String(minute()); break;
+    case SV_SYSSEC:      value = String(second()); break;
+    case SV_SYSSEC_D:    value = String(((hour()*60) + minute())*60 + second()); break;
+    case SV_SYSWEEKDAY:  value = String(weekday()); break;
+    case SV_SYSWEEKDAY_S: value = weekday_str(); break;
     // With leading zero
-    SMART_REPL_TIME(F("%sysyears%"),PSTR("%02d"), year()%100)
-    SMART_REPL_TIME(F("%sysyear_0%"), PSTR("%04d"), year())
-    SMART_REPL_TIME(F("%syshour_0%"), PSTR("%02d"), hour())
-    SMART_REPL_TIME(F("%sysday_0%"), PSTR("%02d"), day())
-    SMART_REPL_TIME(F("%sysmin_0%"), PSTR("%02d"), minute())
-    SMART_REPL_TIME(F("%syssec_0%"),PSTR("%02d"), second())
-    SMART_REPL_TIME(F("%sysmonth_0%"),PSTR("%02d"), month())
-
-    #undef SMART_REPL_TIME
+    case SV_SYSYEARS:    sprintf_P(valueString, PSTR("%02d"), year()%100); value = valueString; break;
+    case SV_SYSYEAR_0:   sprintf_P(valueString, PSTR("%04d"), year()); value = valueString; break;
+    case SV_SYSHOUR_0:   sprintf_P(valueString, PSTR("%02d"), hour()); value = valueString; break;
+    case SV_SYSDAY_0:    sprintf_P(valueString, PSTR("%02d"), day()); value = valueString; break;
+    case SV_SYSMIN_0:    sprintf_P(valueString, PSTR("%02d"), minute()); value = valueString; break;
+    case SV_SYSSEC_0:    sprintf_P(valueString, PSTR("%02d"), second()); value = valueString; break;
+    case SV_SYSMONTH_0:  sprintf_P(valueString, PSTR("%02d"), month()); value = valueString; break;
+    case SV_LCLTIME:     value = getDateTimeString('-',':',' '); break;
+    case SV_LCLTIME_AM:  value = getDateTimeString_ampm('-',':',' '); break;
+    case SV_UPTIME:      value = String(wdcounter / 2); break;
+    case SV_UNIXTIME:    value = String(getUnixTime()); break;
+    default:
+      return false;
   }
-  SMART_REPL(F("%lcltime%"), getDateTimeString('-',':',' '))
-  SMART_REPL(F("%lcltime_am%"), getDateTimeString_ampm('-',':',' '))
-  SMART_REPL(F("%uptime%"), String(wdcounter / 2))
-  SMART_REPL(F("%unixtime%"), String(getUnixTime()))
-  SMART_REPL_T(F("%sunset"), replSunSetTimeString)
-  SMART_REPL_T(F("%sunrise"), replSunRiseTimeString)
+  return true;
 }
 
-String getReplacementString(const String& format, String& s) {
-  int startpos = s.indexOf(format);
-  int endpos = s.indexOf('%', startpos + 1);
-  String R = s.substring(startpos, endpos + 1);
-  String log = F("ReplacementString SunTime: ");
-  log += R;
-  log += F(" offset: ");
-  log += getSecOffset(R);
-  addLog(LOG_LEVEL_DEBUG, log);
-  return R;
+// Value of the variable s[startpos .. endpos], with startpos and endpos pointing at the '%' characters.
+bool getSystemVariable(const String& s, int startpos, int endpos, String& value)
+{
+  const int length = endpos - startpos - 1;
+  if (length <= 0 || length > SYSTEM_VARIABLE_TOKEN_MAX)
+    return false;
+  char name[SYSTEM_VARIABLE_TOKEN_MAX + 1];
+  for (int i = 0; i < length; ++i)
+    name[i] = s[startpos + 1 + i];
+  name[length] = 0;
+
+  // %sunrise% and %sunset% may have an offset, like %sunrise-30m%
+  const bool sunrise = strncmp_P(name, PSTR("sunrise"), 7) == 0;
+  const bool sunset = strncmp_P(name, PSTR("sunset"), 6) == 0;
+  if (sunrise || sunset) {
+    const char next = name[sunrise ? 7 : 6];
+    if (next != 0 && next != '+' && next != '-')
+      return false;
+    const int offset = getSecOffset(s.substring(startpos, endpos + 1));
+    value = sunrise ? getSunriseTimeString(':', offset) : getSunsetTimeString(':', offset);
+    return true;
+  }
+  if (length > SYSTEM_VARIABLE_NAME_MAX)
+    return false;
+  const int id = findSystemVariable(name);
+  if (id < 0)
+    return false;
+  return getSystemVariableValue(id, value);
 }
 
-void replSunRiseTimeString(const String& format, String& s, boolean useURLencode) {
-  String R = getReplacementString(format, s);
-  repl(R, getSunriseTimeString(':', getSecOffset(R)), s, useURLencode);
-}
+void parseSystemVariables(String& s, boolean useURLencode)
+{
+  parseSpecialCharacters(s, useURLencode);
+  int startpos = s.indexOf('%');
+  if (startpos == -1)
+    return; // Nothing to replace
 
-void replSunSetTimeString(const String& format, String& s, boolean useURLencode) {
-  String R = getReplacementString(format, s);
-  repl(R, getSunsetTimeString(':', getSecOffset(R)), s, useURLencode);
+  // Only build a new string when a variable is found, others (e.g. %eventvalue%) are kept.
+  String result;
+  bool replaced = false;
+  int copiedUpTo = 0;
+  String value;
+  while (startpos != -1) {
+    const int endpos = s.indexOf('%', startpos + 1);
+    if (endpos == -1)
+      break;
+    if (getSystemVariable(s, startpos, endpos, value)) {
+      if (!replaced) {
+        result.reserve(s.length() + 32);
+        replaced = true;
+      }
+      for (int i = copiedUpTo; i < startpos; ++i)
+        result += s[i];
+      if (useURLencode)
+        result += URLEncode(value.c_str());
+      else
+        result += value;
+      copiedUpTo = endpos + 1;
+      startpos = s.indexOf('%', copiedUpTo);
+    } else {
+      // The closing '%' may be the start of the next variable.
+      startpos = endpos;
+    }
+  }
+  if (!replaced)
+    return;
+  const int length = s.length();
+  for (int i = copiedUpTo; i < length; ++i)
+    result += s[i];
+  s = result;
 }
 
+// Simple macro to create the replacement string only when needed.
+#define SMART_REPL(T,S) if (s.indexOf(T) != -1) { repl((T), (S), s, useURLencode);}
 void parseEventVariables(String& s, struct EventStruct *event, boolean useURLencode)
 {
   // These replacements use ExtraTaskSettings, so make sure the correct TaskIndex is set in the event.
@@ -571,7 +781,8 @@ void parseEventVariables(String& s, struct EventStruct *event, boolean useURLenc
   SMART_REPL(F("%id%"), String(event->idx))
   if (s.indexOf(F("%val")) != -1) {
     if (event->sensorType == SENSOR_TYPE_LONG) {
-      SMART_REPL(F("%val1%"), String((unsigned long)UserVar[event->BaseVarIndex] + ((unsigned long)UserVar[event->BaseVarIndex + 1] << 16)))
+      const float* values = getEventValues(event);
+      SMART_REPL(F("%val1%"), String((unsigned long)values[0] + ((unsigned long)values[1] << 16)))
     } else {
       SMART_REPL(F("%val1%"), formatUserVarNoCheck(event, 0))
       SMART_REPL(F("%val2%"), formatUserVarNoCheck(event, 1))
@@ -589,9 +800,33 @@ void parseEventVariables(String& s, struct EventStruct *event, boolean useURLenc
   }
 
 }
-#undef SMART_REPL_T
 #undef SMART_REPL
 
+// True when all variables in s only depend on the settings, so the parsed result can be kept.
+bool hasOnlySettingsVariables(const char* s)
+{
+  const char* start = strchr(s, '%');
+  while (start != nullptr) {
+    const char* end = strchr(start + 1, '%');
+    if (end == nullptr)
+      return true;
+    const int length = end - start - 1;
+    if (length <= 0 || length > SYSTEM_VARIABLE_NAME_MAX)
+      return false;
+    char name[SYSTEM_VARIABLE_NAME_MAX + 1];
+    memcpy(name, start + 1, length);
+    name[length] = 0;
+    if (strcmp_P(name, PSTR("tskname")) != 0 && strcmp_P(name, PSTR("valname")) != 0 &&
+        strcmp_P(name, PSTR("id")) != 0 && strncmp_P(name, PSTR("vname"), 5) != 0) {
+      const int id = findSystemVariable(name);
+      if (id != SV_SYSNAME && id != SV_UNIT && id != SV_MAC)
+        return false;
+    }
+    start = strchr(end + 1, '%');
+  }
+  return true;
+}
+
 bool getConvertArgument(const String& marker, const String& s, float& argument, int& startIndex, int& endIndex) {
   String argumentString;
   if (getConvertArgumentString(marker, s, argumentString, startIndex, endIndex)) {
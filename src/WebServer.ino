@@ -7,13 +7,24 @@
 #define _HEAD false
 #define _TAIL true
 #define CHUNKED_BUFFER_SIZE          400
+// A page is aborted when the client does not accept a chunk within this time,
+// so a slow or vanished client cannot hold the loop for long.
+#ifndef WEBSERVER_CLIENT_TIMEOUT_MSEC
+  #define WEBSERVER_CLIENT_TIMEOUT_MSEC  2000
+#endif
 
 void sendContentBlocking(String& data);
-void sendHeaderBlocking(bool json);
+void sendContentBlocking(const char* data, unsigned int length);
+void sendHeaderBlocking(const __FlashStringHelper* contentType, bool allowCORS);
 
+// Collects the page in a fixed size chunk, which is sent as soon as it is full.
+// Strings are copied in blocks (memcpy_P for flash strings), not per character.
 class StreamingBuffer {
 private:
   bool lowMemorySkip;
+  bool clientGone;         // Client disconnected or stalled, the rest of the page is discarded
+  char chunk[CHUNKED_BUFFER_SIZE];
+  unsigned int chunkLength;
 
 public:
   uint32_t initialRam;
@@ -25,98 +36,137 @@ public:
   unsigned int sentBytes;
   uint32_t flashStringCalls;
   uint32_t flashStringData;
+  // Plugins append to this String (String& parameter of the webform calls).
+  // Its content is moved to the chunk before anything else is added.
   String buf;
 
-  StreamingBuffer(void) : lowMemorySkip(false),
+  StreamingBuffer(void) : lowMemorySkip(false), clientGone(false), chunkLength(0),
     initialRam(0), beforeTXRam(0), duringTXRam(0), finalRam(0), maxCoreUsage(0),
     maxServerUsage(0), sentBytes(0), flashStringCalls(0), flashStringData(0)
   {
-    buf.reserve(CHUNKED_BUFFER_SIZE + 50);
     buf = "";
   }
-  StreamingBuffer operator= (String& a)                 { flush(); return addString(a); }
-  StreamingBuffer operator= (const String& a)           { flush(); return addString(a); }
-  StreamingBuffer operator+= (char a)                   { return addString(String(a)); }
-  StreamingBuffer operator+= (long unsigned int  a)     { return addString(String(a)); }
-  StreamingBuffer operator+= (float a)                  { return addString(String(a)); }
-  StreamingBuffer operator+= (int a)                    { return addString(String(a)); }
-  StreamingBuffer operator+= (uint32_t a)               { return addString(String(a)); }
-  StreamingBuffer operator+= (const String& a)          { return addString(a); }
+  StreamingBuffer& operator= (String& a)                 { flush(); return addString(a); }
+  StreamingBuffer& operator= (const String& a)           { flush(); return addString(a); }
+  StreamingBuffer& operator+= (char a)                   { return addData(&a, 1, false); }
+  StreamingBuffer& operator+= (long unsigned int  a)     { return addString(String(a)); }
+  StreamingBuffer& operator+= (float a)                  { return addString(String(a)); }
+  StreamingBuffer& operator+= (int a)                    { return addString(String(a)); }
+  StreamingBuffer& operator+= (uint32_t a)               { return addString(String(a)); }
+  StreamingBuffer& operator+= (const String& a)          { return addString(a); }
+
+  StreamingBuffer& operator+= (const __FlashStringHelper* str) {
+    return operator+=(reinterpret_cast<PGM_P>(str));
+  }
 
-  StreamingBuffer operator+= (PGM_P str) {
+  StreamingBuffer& operator+= (PGM_P str) {
     ++flashStringCalls;
     if (!str) return *this; // return if the pointer is void
-    if (lowMemorySkip) return *this;
-    int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
-    if (flush_step < 1) flush_step = 0;
-    unsigned int pos = 0;
     const unsigned int length = strlen_P((PGM_P)str);
-    if (length == 0) return *this;
     flashStringData += length;
-    while (pos < length) {
-      if (flush_step == 0) {
-        sendContentBlocking(this->buf);
-        flush_step = CHUNKED_BUFFER_SIZE;
-      }
-      this->buf += (char)pgm_read_byte(&str[pos]);
-      ++pos;
-      --flush_step;
-    }
-    checkFull();
-    return *this;
+    return addData(str, length, true);
   }
 
-
-  StreamingBuffer addString(const String& a) {
-    if (lowMemorySkip) return *this;
-    int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
-    if (flush_step < 1) flush_step = 0;
-    int pos = 0;
-    const int length = a.length();
-    while (pos < length) {
-      if (flush_step == 0) {
-        sendContentBlocking(this->buf);
-        flush_step = CHUNKED_BUFFER_SIZE;
-      }
-      this->buf += a[pos];
-      ++pos;
-      --flush_step;
-    }
-    checkFull();
-    return *this;
+  StreamingBuffer& addString(const String& a) {
+    return addData(a.c_str(), a.length(), false);
   }
 
-  void flush() {
-    if (lowMemorySkip) {
-      this->buf = "";
-    } else {
-      sendContentBlocking(this->buf);
-    }
+  StreamingBuffer& addChars(const char* data, unsigned int length) {
+    return addData(data, length, false);
   }
 
-  void checkFull(void) {
-    if (lowMemorySkip) this->buf = "";
-    if (this->buf.length() > CHUNKED_BUFFER_SIZE) {
-      trackTotalMem();
-      sendContentBlocking(this->buf);
+  void flush() {
+    moveStringToChunk();
+    if (!lowMemorySkip) {
+      sendChunk();
     }
+    chunkLength = 0;
   }
 
   void startStream() {
     startStream(false);
   }
 
+  // Stop sending the current page, the page generator runs to its end
+  // but everything added from now on is discarded.
+  void abortStream() {
+    if (clientGone) return;
+    clientGone = true;
+    buf = "";
+    chunkLength = 0;
+    WebServer.client().stop();
+  }
+
+  bool isAborted() const {
+    return lowMemorySkip || clientGone;
+  }
+
   void startJsonStream() {
     startStream(true);
   }
 
+  void startCborStream() {
+    startStream(F("application/cbor"), true);
+  }
+
 private:
+  StreamingBuffer& addData(const char* data, unsigned int length, bool progmem) {
+    if (lowMemorySkip || clientGone) return *this;
+    moveStringToChunk();
+    appendToChunk(data, length, progmem);
+    return *this;
+  }
+
+  void appendToChunk(const char* data, unsigned int length, bool progmem) {
+    while (length > 0) {
+      unsigned int room = CHUNKED_BUFFER_SIZE - chunkLength;
+      if (room == 0) {
+        trackTotalMem();
+        sendChunk();
+        room = CHUNKED_BUFFER_SIZE;
+      }
+      const unsigned int step = length < room ? length : room;
+      if (progmem)
+        memcpy_P(chunk + chunkLength, data, step);
+      else
+        memcpy(chunk + chunkLength, data, step);
+      chunkLength += step;
+      data += step;
+      length -= step;
+    }
+  }
+
+  void moveStringToChunk() {
+    if (buf.length() == 0) return;
+    if (!lowMemorySkip && !clientGone)
+      appendToChunk(buf.c_str(), buf.length(), false);
+    buf = "";
+  }
+
+  void sendChunk() {
+    if (chunkLength == 0) return;
+    if (clientGone) {
+      chunkLength = 0;
+      return;
+    }
+    sendContentBlocking(chunk, chunkLength);
+    chunkLength = 0;
+  }
+
   void startStream(bool json) {
+    startStream(json ? F("application/json") : F("text/html"), json);
+  }
+
+  void startStream(const __FlashStringHelper* contentType, bool allowCORS) {
     maxCoreUsage = maxServerUsage = 0;
     initialRam = ESP.getFreeHeap();
     beforeTXRam = initialRam;
     sentBytes = 0;
     buf = "";
+    chunkLength = 0;
+    clientGone = false;
+    // Limit the time a single write may block on a client not reading.
+    WebServer.client().setTimeout(WEBSERVER_CLIENT_TIMEOUT_MSEC);
     if (beforeTXRam < 3000) {
       lowMemorySkip = true;
       WebServer.send(200, "text/plain", "Low memory. Cannot display webpage :-(");
@@ -125,7 +175,7 @@ private:
        #endif
       return;
     } else
-      sendHeaderBlocking(json);
+      sendHeaderBlocking(contentType, allowCORS);
   }
 
   void trackTotalMem() {
@@ -143,10 +193,16 @@ public:
   }
 
   void endStream(void) {
-    if (!lowMemorySkip) {
-      if (buf.length() > 0) sendContentBlocking(buf);
+    if (clientGone) {
+      addLog(LOG_LEVEL_DEBUG, String(F("Webpage aborted: client disconnected or not reading, sent: ")) + sentBytes);
+      clientGone = false;
       buf = "";
-      sendContentBlocking(buf);
+      chunkLength = 0;
+    } else if (!lowMemorySkip) {
+      moveStringToChunk();
+      sendChunk();
+      // Empty chunk marks the end of the chunked transfer.
+      sendContentBlocking(chunk, 0);
       finalRam = ESP.getFreeHeap();
       /*
       if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
@@ -160,31 +216,41 @@ public:
     } else {
       addLog(LOG_LEVEL_DEBUG, String("Webpage skipped: low memory: ") + finalRam);
       lowMemorySkip = false;
+      buf = "";
+      chunkLength = 0;
     }
   }
 } TXBuffer;
 
 void sendContentBlocking(String& data) {
+  sendContentBlocking(data.c_str(), data.length());
+  data = "";
+}
+
+void sendContentBlocking(const char* data, unsigned int length) {
   checkRAM(F("sendContentBlocking"));
   uint32_t freeBeforeSend = ESP.getFreeHeap();
-  const uint32_t length = data.length();
   addLog(LOG_LEVEL_DEBUG_DEV, String("sendcontent free: ") + freeBeforeSend + " chunk size:" + length);
   freeBeforeSend = ESP.getFreeHeap();
   if (TXBuffer.beforeTXRam > freeBeforeSend)
     TXBuffer.beforeTXRam = freeBeforeSend;
   TXBuffer.duringTXRam = freeBeforeSend;
+  const uint32_t beginSend = millis();
+  // sendContent_P() does not need a String copy of the data and also accepts a pointer to RAM.
 #if defined(ESP8266) && defined(ARDUINO_ESP8266_RELEASE_2_3_0)
   String size = formatToHex(length) + "\r\n";
   // do chunked transfer encoding ourselves (WebServer doesn't support it)
   WebServer.sendContent(size);
-  if (length > 0) WebServer.sendContent(data);
+  if (length > 0) WebServer.sendContent_P(data, length);
   WebServer.sendContent("\r\n");
+  const long sendDuration = timePassedSince(beginSend);
 #else  // ESP8266 2.4.0rc2 and higher and the ESP32 webserver supports chunked http transfer
   unsigned int timeout = 0;
   if (freeBeforeSend < 5000) timeout = 100;
   if (freeBeforeSend < 4000) timeout = 1000;
+  WebServer.sendContent_P(data, length);
+  const long sendDuration = timePassedSince(beginSend);
   const uint32_t beginWait = millis();
-  WebServer.sendContent(data);
   while ((ESP.getFreeHeap() < freeBeforeSend) &&
          !timeOutReached(beginWait + timeout)) {
     if (ESP.getFreeHeap() < TXBuffer.duringTXRam)
@@ -192,25 +258,37 @@ void sendContentBlocking(String& data) {
     ;
     TXBuffer.trackCoreMem();
     checkRAM(F("duringDataTX"));
-    delay(1);
+    backgroundtasksWhileSending();
   }
 #endif
 
   TXBuffer.sentBytes += length;
-  data = "";
+  if (!WebServer.client().connected() ||
+      sendDuration > WEBSERVER_CLIENT_TIMEOUT_MSEC) {
+    TXBuffer.abortStream();
+  }
   yield();
 }
 
-void sendHeaderBlocking(bool json) {
+// Waiting for the TCP stack to release the sent data, keep the I/O running
+// which does not share state with the page generators.
+void backgroundtasksWhileSending() {
+  delay(1);
+  handleEventStreams();
+  if (dnsServerActive)
+    dnsServer.processNextRequest();
+}
+
+void sendHeaderBlocking(const __FlashStringHelper* contentType, bool allowCORS) {
   checkRAM(F("sendHeaderBlocking"));
   WebServer.client().flush();
 #if defined(ESP8266) && defined(ARDUINO_ESP8266_RELEASE_2_3_0)
   WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
-  WebServer.sendHeader(F("Content-Type"), json ? F("application/json") : F("text/html"), true);
+  WebServer.sendHeader(F("Content-Type"), contentType, true);
   WebServer.sendHeader(F("Accept-Ranges"), F("none"));
   WebServer.sendHeader(F("Cache-Control"), F("no-cache"));
   WebServer.sendHeader(F("Transfer-Encoding"), F("chunked"));
-  if (json)
+  if (allowCORS)
     WebServer.sendHeader(F("Access-Control-Allow-Origin"),"*");
   WebServer.send(200);
 #else
@@ -220,16 +298,16 @@ void sendHeaderBlocking(bool json) {
   if (freeBeforeSend < 4000) timeout = 1000;
   const uint32_t beginWait = millis();
   WebServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
-  WebServer.sendHeader(F("Content-Type"), json ? F("application/json") : F("text/html"), true);
+  WebServer.sendHeader(F("Content-Type"), contentType, true);
   WebServer.sendHeader(F("Cache-Control"), F("no-cache"));
-  if (json)
+  if (allowCORS)
     WebServer.sendHeader(F("Access-Control-Allow-Origin"),"*");
   WebServer.send(200);
   // dont wait on 2.3.0. Memory returns just too slow.
   while ((ESP.getFreeHeap() < freeBeforeSend) &&
          !timeOutReached(beginWait + timeout)) {
     checkRAM(F("duringHeaderTX"));
-    delay(1);
+    backgroundtasksWhileSending();
   }
 #endif
   yield();
@@ -461,6 +539,7 @@ void WebServerInit()
   WebServer.on(F("/notifications"), handle_notifications);
   WebServer.on(F("/log"), handle_log);
   WebServer.on(F("/logjson"), handle_log_JSON);
+  WebServer.on(F("/events"), handle_events);
   WebServer.on(F("/tools"), handle_tools);
   WebServer.on(F("/i2cscanner"), handle_i2cscanner);
   WebServer.on(F("/wifiscanner"), handle_wifiscanner);
@@ -477,11 +556,17 @@ void WebServerInit()
   WebServer.on(F("/advanced"), handle_advanced);
   WebServer.on(F("/setup"), handle_setup);
   WebServer.on(F("/json"), handle_json);
+  WebServer.on(F("/timingstats"), handle_timingstats_json);
   WebServer.on(F("/rules"), handle_rules);
   WebServer.on(F("/sysinfo"), handle_sysinfo);
   WebServer.on(F("/pinstates"), handle_pinstates);
   WebServer.on(F("/sysvars"), handle_sysvars);
   WebServer.on(F("/favicon.ico"), handle_favicon);
+  WebServer.on(F("/esp.css"), handle_default_css);
+
+  // Needed for the ETag checks, serving gzip compressed files and the /json encoding
+  const char * headerKeys[] = {"If-None-Match", "Accept-Encoding", "Accept"};
+  WebServer.collectHeaders(headerKeys, 3);
 
   #if defined(ESP8266)
     if (getFlashRealSizeInBytes() > 524288)
@@ -706,18 +791,9 @@ void getWebPageTemplateVar(const String& varName )
 
   else if (varName == F("css"))
   {
-    if (SPIFFS.exists(F("esp.css")))   //now css is written in writeDefaultCSS() to SPIFFS and always present
-    //if (0) //TODO
-    {
-      TXBuffer = F("<link rel=\"stylesheet\" type=\"text/css\" href=\"esp.css\">");
-    }
-   else
-    {
-      TXBuffer += F("<style>");
-      // Send CSS per chunk to avoid sending either too short or too large strings.
-      TXBuffer += pgDefaultCSS;
-      TXBuffer += F("</style>");
-    }
+    // esp.css from SPIFFS, or the default CSS, see handle_default_css()
+    // Cached by the browser, instead of sending it with every page.
+    TXBuffer = F("<link rel=\"stylesheet\" type=\"text/css\" href=\"esp.css\">");
   }
 
 
@@ -1169,6 +1245,8 @@ void handle_controllers() {
   //submitted data
   if (protocol != -1 && !controllerNotSet)
   {
+    // All saves of the form are committed at once.
+    beginSettingsBatch();
     ControllerSettingsStruct ControllerSettings;
     //submitted changed protocol
     if (Settings.Protocol[controllerindex] != protocol)
@@ -1247,6 +1325,7 @@ void handle_controllers() {
     }
     addHtmlError(SaveControllerSettings(controllerindex, (byte*)&ControllerSettings, sizeof(ControllerSettings)));
     addHtmlError(SaveSettings());
+    addHtmlError(commitSettingsBatch());
   }
 
   TXBuffer += F("<form name='frmselect' method='post'>");
@@ -1256,10 +1335,8 @@ void handle_controllers() {
     TXBuffer += F("<table class='multirow' border=1px frame='box' rules='all'><TR><TH style='width:70px;'>");
     TXBuffer += F("<TH style='width:50px;'>Nr<TH style='width:100px;'>Enabled<TH>Protocol<TH>Host<TH>Port");
 
-    ControllerSettingsStruct ControllerSettings;
     for (byte x = 0; x < CONTROLLER_MAX; x++)
     {
-      LoadControllerSettings(x, (byte*)&ControllerSettings, sizeof(ControllerSettings));
       html_TR_TD();
       TXBuffer += F("<a class='button link' href=\"controllers?index=");
       TXBuffer += x + 1;
@@ -1277,6 +1354,8 @@ void handle_controllers() {
         CPlugin_ptr[ProtocolIndex](CPLUGIN_GET_DEVICENAME, 0, ProtocolName);
         TXBuffer += ProtocolName;
 
+        // Only for controllers in use, the cache allocates the settings of each controller loaded.
+        const ControllerSettingsStruct& ControllerSettings = getControllerSettings(x);
         html_TD();
         TXBuffer += ControllerSettings.getHost();
         html_TD();
@@ -1314,8 +1393,7 @@ void handle_controllers() {
 
     if (Settings.Protocol[controllerindex])
     {
-      ControllerSettingsStruct ControllerSettings;
-      LoadControllerSettings(controllerindex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+      ControllerSettingsStruct& ControllerSettings = getControllerSettings(controllerindex);
       byte choice = ControllerSettings.UseDNS;
       String options[2];
       options[0] = F("Use IP address");
@@ -1875,6 +1953,8 @@ void handle_devices() {
   // FIXME TD-er: Might have to clear any caches here.
   if (edit != 0  && !taskIndexNotSet) // when form submitted
   {
+    // All saves of the form are committed at once.
+    beginSettingsBatch();
     if (Settings.TaskDeviceNumber[taskIndex] != taskdevicenumber) // change of device: cleanup old device and reset default settings
     {
       //let the plugin do its cleanup by calling PLUGIN_EXIT with this TaskIndex
@@ -1974,6 +2054,7 @@ void handle_devices() {
     addHtmlError(SaveTaskSettings(taskIndex));
 
     addHtmlError(SaveSettings());
+    addHtmlError(commitSettingsBatch());
 
     if (taskdevicenumber != 0 && Settings.TaskDeviceEnabled[taskIndex])
       PluginCall(PLUGIN_INIT, &TempEvent, dummyString);
@@ -2008,6 +2089,8 @@ void handle_devices() {
 
     for (byte x = (page - 1) * TASKS_PER_PAGE; x < ((page) * TASKS_PER_PAGE); x++)
     {
+      if (TXBuffer.isAborted())
+        break;
       html_TR_TD();
       TXBuffer += F("<a class='button link' href=\"devices?index=");
       TXBuffer += x + 1;
@@ -3085,6 +3168,30 @@ void handle_log() {
 //********************************************************************************
 // Web Interface JSON log page
 //********************************************************************************
+// Add a log line as JSON object, returns the length of the line.
+// The line is changed in place to fit in a JSON string.
+unsigned int stream_log_json_entry(unsigned long timestamp, byte logLevel, char* line) {
+  unsigned int length = 0;
+  for (; line[length] != 0; ++length) {
+    switch (line[length]) {
+      case '\n': line[length] = '^';  break;
+      case '"':  line[length] = '\''; break;
+      case '\\': line[length] = '/';  break;
+      default:
+        if (static_cast<uint8_t>(line[length]) < 0x20) line[length] = ' ';
+        break;
+    }
+  }
+  TXBuffer += F("{\"timestamp\":");
+  TXBuffer += timestamp;
+  TXBuffer += F(",\n\"text\":\"");
+  TXBuffer.addChars(line, length);
+  TXBuffer += F("\",\n\"level\":");
+  TXBuffer += static_cast<int>(logLevel);
+  TXBuffer += '}';
+  return length;
+}
+
 void handle_log_JSON() {
   TXBuffer.startJsonStream();
   String webrequest = WebServer.arg(F("view"));
@@ -3102,20 +3209,20 @@ void handle_log_JSON() {
     TXBuffer += F("],\n");
   }
   TXBuffer += F("\"Entries\": [");
-  bool logLinesAvailable = true;
   int nrEntries = 0;
+  unsigned long entriesSize = 0; // Bytes used in the log buffer by the entries sent
   unsigned long firstTimeStamp = 0;
   unsigned long lastTimeStamp = 0;
-  while (logLinesAvailable) {
-    String reply = Logging.get_logjson_formatted(logLinesAvailable, lastTimeStamp);
-    if (reply.length() > 0) {
-      TXBuffer += reply;
-      if (nrEntries == 0) {
-        firstTimeStamp = lastTimeStamp;
-      }
-      ++nrEntries;
+  byte logLevel;
+  char line[LOG_STRUCT_MESSAGE_SIZE];
+  while (Logging.read(LOG_TO_WEBLOG, lastTimeStamp, logLevel, line, sizeof(line))) {
+    if (nrEntries == 0) {
+      firstTimeStamp = lastTimeStamp;
+    } else {
+      TXBuffer += F(",\n");
     }
-    // Do we need to do something here and maybe limit number of lines at once?
+    entriesSize += LOG_RECORD_HEADER_SIZE + stream_log_json_entry(lastTimeStamp, logLevel, line);
+    ++nrEntries;
   }
   TXBuffer += F("],\n");
   long logTimeSpan = timeDiff(firstTimeStamp, lastTimeStamp);
@@ -3124,8 +3231,9 @@ void handle_log_JSON() {
   if (nrEntries > 2 && logTimeSpan > 1) {
     // May need to lower the TTL for refresh when time needed
     // to fill half the log is lower than current TTL
-    newOptimum = logTimeSpan * (LOG_STRUCT_MESSAGE_LINES / 2);
-    newOptimum = newOptimum / (nrEntries - 1);
+    const long bufferEntries = (LOG_RING_SIZE * nrEntries) / entriesSize; // Estimate of the lines fitting in the web log ring
+    newOptimum = logTimeSpan / (nrEntries - 1);
+    newOptimum = newOptimum * (bufferEntries / 2);
   }
   if (newOptimum < refreshSuggestion) refreshSuggestion = newOptimum;
   if (refreshSuggestion < 100) {
@@ -3141,6 +3249,358 @@ void handle_log_JSON() {
   TXBuffer.endStream();
 }
 
+//********************************************************************************
+// Push channel for live task values and log lines (Server-Sent Events)
+// The connection is taken over from the web server and kept open.
+// Each client has its own buffer of pending events, written from the loop as
+// fast as the client accepts them. When it cannot keep up, new events are dropped
+// for that client only and a client not accepting any data is disconnected.
+//********************************************************************************
+void handle_events() {
+  if (!isLoggedIn()) return;
+  int slot = -1;
+  for (byte i = 0; i < EVENT_STREAM_CLIENTS_MAX && slot < 0; ++i) {
+    if (!eventStreamClients[i].active)
+      slot = i;
+  }
+  if (slot < 0 || ESP.getFreeHeap() < EVENT_STREAM_MIN_FREE_HEAP) {
+    WebServer.send(503, "text/plain", F("Too many subscribers"));
+    return;
+  }
+  EventStreamClientStruct& subscriber = eventStreamClients[slot];
+  subscriber.client = WebServer.client();
+  subscriber.client.setNoDelay(true);
+  subscriber.client.print(F(
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 5000\n\n"));
+  subscriber.pending = "";
+  subscriber.lastWrite = millis();
+  subscriber.stalledSince = 0;
+  subscriber.sent = 0;
+  subscriber.dropped = 0;
+  subscriber.active = true;
+  ++eventStreamClientCount;
+}
+
+void closeEventStream(byte index) {
+  EventStreamClientStruct& subscriber = eventStreamClients[index];
+  if (!subscriber.active) return;
+  subscriber.client.stop();
+  subscriber.client = WiFiClient();
+  subscriber.pending = String(); // Release the buffer
+  subscriber.active = false;
+  --eventStreamClientCount;
+}
+
+// Queue an event for all subscribers. The data must be a single line.
+void eventStreamPush(const String& event, const String& data) {
+  if (eventStreamClientCount == 0) return;
+  const unsigned eventLength = event.length() + data.length() + 16;
+  for (byte i = 0; i < EVENT_STREAM_CLIENTS_MAX; ++i) {
+    EventStreamClientStruct& subscriber = eventStreamClients[i];
+    if (!subscriber.active) continue;
+    if (subscriber.pending.length() + eventLength > EVENT_STREAM_BUFFER_MAX) {
+      ++subscriber.dropped;
+      continue;
+    }
+    subscriber.pending += F("event: ");
+    subscriber.pending += event;
+    subscriber.pending += F("\ndata: ");
+    subscriber.pending += data;
+    subscriber.pending += F("\n\n");
+    ++subscriber.sent;
+  }
+}
+
+// Called from sendData()
+void eventStreamTaskValues(byte TaskIndex) {
+  if (eventStreamClientCount == 0) return;
+  #ifdef ESP32
+    if (!isMainLoopTask()) {
+      // Other RTOS tasks only keep the values, handleEventStreams() pushes them.
+      portENTER_CRITICAL(&eventStreamPendingMux);
+      for (byte x = 0; x < VARS_PER_TASK; ++x)
+        eventStreamPendingValues[TaskIndex][x] = UserVar[TaskIndex * VARS_PER_TASK + x];
+      eventStreamPendingTasks |= (1UL << TaskIndex);
+      portEXIT_CRITICAL(&eventStreamPendingMux);
+      return;
+    }
+  #endif
+  eventStreamTaskValues(TaskIndex, &UserVar[TaskIndex * VARS_PER_TASK]);
+}
+
+#ifdef ESP32
+void eventStreamPendingTaskValues() {
+  for (byte TaskIndex = 0; TaskIndex < TASKS_MAX && eventStreamPendingTasks != 0; ++TaskIndex) {
+    float values[VARS_PER_TASK];
+    portENTER_CRITICAL(&eventStreamPendingMux);
+    const bool pending = eventStreamPendingTasks & (1UL << TaskIndex);
+    eventStreamPendingTasks &= ~(1UL << TaskIndex);
+    memcpy(values, eventStreamPendingValues[TaskIndex], sizeof(values));
+    portEXIT_CRITICAL(&eventStreamPendingMux);
+    if (pending)
+      eventStreamTaskValues(TaskIndex, values);
+  }
+}
+#endif
+
+void eventStreamTaskValues(byte TaskIndex, const float* values) {
+  const byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
+  const byte valueCount = Device[DeviceIndex].ValueCount;
+  const TaskSettingsCacheStruct& taskSettings = getTaskSettingsCache(TaskIndex);
+  char value[FORMAT_VALUE_BUFFER_SIZE];
+  String data;
+  data.reserve(48 + 48 * valueCount);
+  data += '{';
+  data += to_json_object_value(F("TaskNumber"), String(TaskIndex + 1));
+  data += ',';
+  data += to_json_object_value(F("TaskName"), taskSettings.TaskDeviceName);
+  data += F(",\"TaskValues\":[");
+  for (byte x = 0; x < valueCount; ++x) {
+    if (x != 0)
+      data += ',';
+    data += '{';
+    data += to_json_object_value(F("ValueNumber"), String(x + 1));
+    data += ',';
+    data += to_json_object_value(F("Name"), taskSettings.TaskDeviceValueNames[x]);
+    data += ',';
+    doFormatUserVar(values, TaskIndex, x, false, value);
+    data += to_json_object_value(F("Value"), value);
+    data += '}';
+  }
+  data += F("]}");
+  eventStreamPush(F("taskvalues"), data);
+}
+
+// Called from processLogReaders() for lines logged to the web log
+void eventStreamLog(unsigned long timestamp, byte logLevel, const char *line) {
+  if (eventStreamClientCount == 0) return;
+  String data;
+  data.reserve(LOG_STRUCT_MESSAGE_SIZE + 48);
+  data += '{';
+  data += to_json_object_value(F("timestamp"), String(timestamp));
+  data += ',';
+  data += to_json_object_value(F("text"), line);
+  data += ',';
+  data += to_json_object_value(F("level"), String(logLevel));
+  data += '}';
+  eventStreamPush(F("log"), data);
+}
+
+// Write pending events to the subscribers, called from the loop.
+void handleEventStreams() {
+  if (eventStreamClientCount == 0 || !isMainLoopTask()) return;
+  #ifdef ESP32
+    if (eventStreamPendingTasks != 0)
+      eventStreamPendingTaskValues();
+  #endif
+  for (byte i = 0; i < EVENT_STREAM_CLIENTS_MAX; ++i) {
+    EventStreamClientStruct& subscriber = eventStreamClients[i];
+    if (!subscriber.active) continue;
+    if (!subscriber.client.connected()) {
+      closeEventStream(i);
+      continue;
+    }
+    if (subscriber.pending.length() == 0) {
+      if (timePassedSince(subscriber.lastWrite) < EVENT_STREAM_KEEPALIVE_MSEC)
+        continue;
+      // Comment line, to detect closed connections and keep proxies from closing it.
+      subscriber.pending = F(":\n\n");
+    }
+    const size_t written = writeWithoutBlocking(subscriber.client,
+      reinterpret_cast<const uint8_t*>(subscriber.pending.c_str()), subscriber.pending.length());
+    if (written > 0) {
+      subscriber.pending.remove(0, written);
+      subscriber.lastWrite = millis();
+      subscriber.stalledSince = 0;
+    } else if (subscriber.stalledSince == 0) {
+      subscriber.stalledSince = millis();
+    } else if (timePassedSince(subscriber.stalledSince) > EVENT_STREAM_STALL_TIMEOUT_MSEC) {
+      closeEventStream(i);
+    }
+  }
+}
+
+// Bytes of length the client accepts right now, as far as the core can tell.
+size_t getClientWriteRoom(WiFiClient& client, size_t length) {
+#if defined(ESP8266) && !defined(ARDUINO_ESP8266_RELEASE_2_3_0)
+  // Do not block on a slow client, only write what fits in the TCP send buffer.
+  const size_t room = client.availableForWrite();
+  if (length > room) length = room;
+#endif
+  return length;
+}
+
+// Returns the number of bytes written, without waiting for a slow client.
+size_t writeWithoutBlocking(WiFiClient& client, const uint8_t* data, size_t length) {
+#if defined(ESP32)
+  // WiFiClient::write() waits for a slow client, only write what the socket accepts right now.
+  const int sent = send(client.fd(), data, length, MSG_DONTWAIT);
+  return (sent > 0) ? sent : 0;
+#else
+  length = getClientWriteRoom(client, length);
+  if (length == 0)
+    return 0;
+  return client.write(data, length);
+#endif
+}
+
+//********************************************************************************
+// Responses of /json and files sent from the loop
+// The connection is taken over from the web server, like the /events push channel.
+// handleWebStreams() writes what each client accepts right now and only then reads or
+// generates the next part, so a slow client holds neither the loop nor the other streams.
+// /json is generated per section when it is sent, see addJsonPageSection().
+// When all WEB_STREAMS_MAX streams are in use or the heap is low, the handlers send
+// the response blocking.
+// The web server takes the next request once a stream is complete, or when it stops
+// waiting for the client to close the connection (2 seconds).
+//********************************************************************************
+int getFreeWebStream() {
+  if (ESP.getFreeHeap() < WEB_STREAM_MIN_FREE_HEAP)
+    return -1;
+  for (byte i = 0; i < WEB_STREAMS_MAX; ++i) {
+    if (webStreams[i].type == WEB_STREAM_NONE)
+      return i;
+  }
+  return -1;
+}
+
+// Take over the connection of the current request, the response (or its headers)
+// is in 'pending' and the source of the type is set.
+void startWebStream(byte index, byte type) {
+  WebStreamStruct& stream = webStreams[index];
+  stream.client = WebServer.client();
+  stream.client.setNoDelay(true);
+  stream.lastWrite = millis();
+  stream.stalledSince = 0;
+  ++webStreamCount;
+  // Last, handleWebStreams() may run on another RTOS task.
+  stream.type = type;
+}
+
+// The headers are sent by the web server, the body from the loop.
+// The stream takes over the file, false when no stream is free.
+bool startFileWebStream(fs::File& dataFile, const String& contentType, bool gzip) {
+  const int index = getFreeWebStream();
+  if (index < 0)
+    return false;
+  if (gzip)
+    WebServer.sendHeader(F("Content-Encoding"), F("gzip"));
+  WebServer.setContentLength(dataFile.size());
+  WebServer.send(200, contentType, "");
+  WebStreamStruct& stream = webStreams[index];
+  stream.file = dataFile;
+  dataFile = fs::File();
+  startWebStream(index, WEB_STREAM_FILE);
+  return true;
+}
+
+// The data must stay valid until sent, e.g. mapped flash.
+bool startDataWebStream(const uint8_t* data, size_t size, const String& contentType) {
+  const int index = getFreeWebStream();
+  if (index < 0)
+    return false;
+  WebServer.setContentLength(size);
+  WebServer.send(200, contentType, "");
+  WebStreamStruct& stream = webStreams[index];
+  stream.data = data;
+  stream.remaining = size;
+  startWebStream(index, WEB_STREAM_DATA);
+  return true;
+}
+
+void closeWebStream(byte index) {
+  WebStreamStruct& stream = webStreams[index];
+  if (stream.type == WEB_STREAM_NONE) return;
+  stream.client.stop();
+  stream.client = WiFiClient();
+  stream.pending = String(); // Release the buffer
+  if (stream.file)
+    stream.file.close();
+  stream.file = fs::File();
+  stream.data = nullptr;
+  stream.remaining = 0;
+  --webStreamCount;
+  // Last, a new stream may be started on another RTOS task.
+  stream.type = WEB_STREAM_NONE;
+}
+
+// Returns the number of bytes written, -1 when the response is complete.
+int writeWebStream(WebStreamStruct& stream) {
+  switch (stream.type) {
+    case WEB_STREAM_JSON:
+    {
+      // Tasks not changed since the version of the client add nothing.
+      while (stream.pending.length() == 0) {
+        if (!addJsonPageSection(stream.json, stream.pending))
+          return -1;
+      }
+      const size_t written = writeWithoutBlocking(stream.client,
+        reinterpret_cast<const uint8_t*>(stream.pending.c_str()), stream.pending.length());
+      stream.pending.remove(0, written);
+      return written;
+    }
+    case WEB_STREAM_FILE:
+    {
+      const int available = stream.file.available();
+      if (available <= 0)
+        return -1;
+      uint8_t block[WEB_STREAM_BLOCK_SIZE];
+      const size_t length = getClientWriteRoom(stream.client, std::min(sizeof(block), (size_t)available));
+      if (length == 0)
+        return 0;
+      const int read = stream.file.read(block, length);
+      if (read <= 0)
+        return -1;
+      const size_t written = writeWithoutBlocking(stream.client, block, read);
+      if (written < static_cast<size_t>(read))
+        stream.file.seek(stream.file.position() - (read - written), fs::SeekSet);
+      return written;
+    }
+    case WEB_STREAM_DATA:
+    {
+      if (stream.remaining == 0)
+        return -1;
+      const size_t written = writeWithoutBlocking(stream.client, stream.data,
+        std::min(stream.remaining, (size_t)WEB_STREAM_BLOCK_SIZE));
+      stream.data += written;
+      stream.remaining -= written;
+      return written;
+    }
+  }
+  return -1;
+}
+
+void handleWebStreams() {
+  if (webStreamCount == 0 || !isMainLoopTask()) return;
+  for (byte i = 0; i < WEB_STREAMS_MAX; ++i) {
+    WebStreamStruct& stream = webStreams[i];
+    if (stream.type == WEB_STREAM_NONE) continue;
+    if (!stream.client.connected()) {
+      closeWebStream(i);
+      continue;
+    }
+    const int written = writeWebStream(stream);
+    if (written < 0) {
+      // Complete, closing the connection marks the end of a /json response.
+      closeWebStream(i);
+    } else if (written > 0) {
+      stream.lastWrite = millis();
+      stream.stalledSince = 0;
+    } else if (stream.stalledSince == 0) {
+      stream.stalledSince = millis();
+    } else if (timePassedSince(stream.stalledSince) > WEB_STREAM_STALL_TIMEOUT_MSEC) {
+      closeWebStream(i);
+    }
+  }
+}
+
 //********************************************************************************
 // Web Interface debug page
 //********************************************************************************
@@ -3680,128 +4140,558 @@ void stream_last_json_object_value(const String& object, const String& value) {
   TXBuffer += "\n}";
 }
 
+/*********************************************************************************************\
+   CBOR (RFC 7049) encoding, written directly to the TXBuffer.
+   Maps and arrays use indefinite length, so the number of items is not needed in advance.
+  \*********************************************************************************************/
+#define CBOR_UINT          0x00
+#define CBOR_NEGINT        0x20
+#define CBOR_TEXT          0x60
+#define CBOR_ARRAY         0x80
+#define CBOR_MAP           0xa0
+#define CBOR_FALSE         0xf4
+#define CBOR_TRUE          0xf5
+#define CBOR_FLOAT32       0xfa
+#define CBOR_INDEFINITE    0x1f
+#define CBOR_BREAK         0xff
+
+// Major type with its argument in the shortest form.
+void stream_cbor_head(byte majorType, uint32_t value) {
+  uint8_t head[5];
+  unsigned int length = 1;
+  if (value < 24) {
+    head[0] = majorType | value;
+  } else if (value <= 0xff) {
+    head[0] = majorType | 24;
+    head[length++] = value;
+  } else if (value <= 0xffff) {
+    head[0] = majorType | 25;
+    head[length++] = value >> 8;
+    head[length++] = value;
+  } else {
+    head[0] = majorType | 26;
+    head[length++] = value >> 24;
+    head[length++] = value >> 16;
+    head[length++] = value >> 8;
+    head[length++] = value;
+  }
+  TXBuffer.addChars(reinterpret_cast<const char*>(head), length);
+}
+
+void stream_cbor_begin(byte majorType) {
+  TXBuffer += static_cast<char>(majorType | CBOR_INDEFINITE);
+}
+
+void stream_cbor_end() {
+  TXBuffer += static_cast<char>(CBOR_BREAK);
+}
+
+void stream_cbor_uint(uint32_t value) {
+  stream_cbor_head(CBOR_UINT, value);
+}
+
+void stream_cbor_int(long value) {
+  if (value < 0)
+    stream_cbor_head(CBOR_NEGINT, -1 - value);
+  else
+    stream_cbor_head(CBOR_UINT, value);
+}
+
+void stream_cbor_float(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  TXBuffer += static_cast<char>(CBOR_FLOAT32);
+  const uint8_t data[4] = { (uint8_t)(bits >> 24), (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits };
+  TXBuffer.addChars(reinterpret_cast<const char*>(data), 4);
+}
+
+void stream_cbor_bool(bool value) {
+  TXBuffer += static_cast<char>(value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void stream_cbor_text(const char* text) {
+  const unsigned int length = text == NULL ? 0 : strlen(text);
+  stream_cbor_head(CBOR_TEXT, length);
+  TXBuffer.addChars(text, length);
+}
+
+void stream_cbor_text(const String& text) {
+  stream_cbor_head(CBOR_TEXT, text.length());
+  TXBuffer.addChars(text.c_str(), text.length());
+}
+
+void stream_cbor_text(const __FlashStringHelper* text) {
+  stream_cbor_head(CBOR_TEXT, strlen_P(reinterpret_cast<PGM_P>(text)));
+  TXBuffer += text;
+}
+
+// Map entries, the key is a flash string.
+void stream_cbor_uint_value(const __FlashStringHelper* key, uint32_t value) {
+  stream_cbor_text(key);
+  stream_cbor_uint(value);
+}
+
+void stream_cbor_int_value(const __FlashStringHelper* key, long value) {
+  stream_cbor_text(key);
+  stream_cbor_int(value);
+}
+
+void stream_cbor_float_value(const __FlashStringHelper* key, float value) {
+  stream_cbor_text(key);
+  stream_cbor_float(value);
+}
+
+void stream_cbor_bool_value(const __FlashStringHelper* key, bool value) {
+  stream_cbor_text(key);
+  stream_cbor_bool(value);
+}
+
+void stream_cbor_text_value(const __FlashStringHelper* key, const String& value) {
+  stream_cbor_text(key);
+  stream_cbor_text(value);
+}
+
+void stream_cbor_text_value(const __FlashStringHelper* key, const char* value) {
+  stream_cbor_text(key);
+  stream_cbor_text(value);
+}
+
+
+String getNodeTypeDisplayString(byte nodeType) {
+  switch (nodeType)
+  {
+    case NODE_TYPE_ID_ESP_EASY_STD:     return F("ESP Easy");
+    case NODE_TYPE_ID_ESP_EASYM_STD:    return F("ESP Easy Mega");
+    case NODE_TYPE_ID_ESP_EASY32_STD:   return F("ESP Easy 32");
+    case NODE_TYPE_ID_ARDUINO_EASY_STD: return F("Arduino Easy");
+    case NODE_TYPE_ID_NANO_EASY_STD:    return F("Nano Easy");
+  }
+  return "";
+}
 
 //********************************************************************************
 // Web Interface JSON page (no password!)
+// With format=cbor or "Accept: application/cbor" the same data is sent CBOR encoded.
+// The JSON is sent from the loop when a stream is free, see handleWebStreams().
 //********************************************************************************
 void handle_json()
 {
+  JsonPageStruct page;
   const int taskNr = getFormItemInt(F("tasknr"), -1);
-  const bool showSpecificTask = taskNr > 0;
-  bool showSystem = true;
-  bool showWifi = true;
-  bool showDataAcquisition = true;
-  bool showTaskDetails = true;
-  bool showNodes = true;
+  page.showSpecificTask = taskNr > 0;
   {
     String view = WebServer.arg("view");
     if (view.length() != 0) {
       if (view == F("sensorupdate")) {
-        showSystem = false;
-        showWifi = false;
-        showDataAcquisition = false;
-        showTaskDetails = false;
-        showNodes =false;
+        page.showSystem = false;
+        page.showWifi = false;
+        page.showDataAcquisition = false;
+        page.showTaskDetails = false;
+        page.showNodes =false;
       }
     }
   }
+  // Only task values and settings can be cached, System, WiFi and Nodes always change.
+  const bool cacheable = page.showSpecificTask ? taskNr <= TASKS_MAX : (!page.showSystem && !page.showWifi && !page.showNodes);
+  unsigned long since = cacheable && !page.showSpecificTask ? getFormItemInt(F("since"), 0) : 0;
+  updateTaskDataVersions();
+  if (since > dataVersion) since = 0; // Version of before a reboot, send all tasks.
+  page.since = since;
+  const bool useCbor = WebServer.arg(F("format")) == F("cbor") ||
+                       WebServer.header(F("Accept")).indexOf(F("application/cbor")) != -1;
+  String etag;
+  if (cacheable) {
+    static long bootId = 0; // Different ETag values after a reboot.
+    if (bootId == 0) bootId = random(1, 0x7FFFFFFF);
+    etag = F("\"");
+    etag += String(bootId, HEX);
+    etag += '-';
+    etag += page.showSpecificTask ? taskDataVersion[taskNr - 1] : dataVersion;
+    if (useCbor) etag += F("-cbor");
+    etag += '\"';
+    if (WebServer.header(F("If-None-Match")) == etag) {
+      WebServer.sendHeader(F("ETag"), etag);
+      WebServer.sendHeader(F("Vary"), F("Accept"));
+      WebServer.sendHeader(F("Cache-Control"), F("no-cache"));
+      WebServer.send(304);
+      return;
+    }
+  }
+  if (page.showSpecificTask)
+  {
+    page.nextTask = taskNr - 1;
+    page.lastTask = taskNr - 1;
+  }
+
+  const int streamIndex = useCbor ? -1 : getFreeWebStream();
+  if (streamIndex >= 0) {
+    // Sent from the loop, the headers are the first part of the response.
+    WebStreamStruct& stream = webStreams[streamIndex];
+    stream.pending = F(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Access-Control-Allow-Origin: *\r\n"
+      "Connection: close\r\n");
+    if (etag.length() != 0) {
+      stream.pending += F("ETag: ");
+      stream.pending += etag;
+      stream.pending += F("\r\nVary: Accept\r\n");
+    }
+    stream.pending += F("\r\n");
+    stream.json = page;
+    startWebStream(streamIndex, WEB_STREAM_JSON);
+    return;
+  }
+  if (etag.length() != 0) {
+    WebServer.sendHeader(F("ETag"), etag);
+    WebServer.sendHeader(F("Vary"), F("Accept"));
+  }
+  if (useCbor) {
+    handle_json_cbor(taskNr, since, page.showSystem, page.showWifi, page.showNodes, page.showDataAcquisition, page.showTaskDetails);
+    return;
+  }
   TXBuffer.startJsonStream();
+  String json;
+  while (!TXBuffer.isAborted() && addJsonPageSection(page, json)) {
+    TXBuffer += json;
+    json = "";
+  }
+  TXBuffer.endStream();
+}
+
+void add_next_json_object_value(String& json, const String& object, const String& value) {
+  json += to_json_object_value(object, value);
+  json += F(",\n");
+}
+
+void add_last_json_object_value(String& json, const String& object, const String& value) {
+  json += to_json_object_value(object, value);
+  json += F("\n}");
+}
+
+// Add the next section of the /json page, false when the page is complete.
+// Values are read when their section is added, so a page sent to a slow client
+// from the loop does not show old values.
+bool addJsonPageSection(JsonPageStruct& page, String& json)
+{
+  switch (page.section) {
+    case JSON_PAGE_SYSTEM:
+      page.section = page.showSpecificTask ? JSON_PAGE_TASKS : JSON_PAGE_WIFI;
+      if (page.showSpecificTask)
+        return true;
+      json += '{';
+      if (page.showSystem) {
+        json += F("\"System\":{\n");
+        add_next_json_object_value(json, F("Build"), String(BUILD));
+        add_next_json_object_value(json, F("Git Build"), String(BUILD_GIT));
+        add_next_json_object_value(json, F("System libraries"), getSystemLibraryString());
+        add_next_json_object_value(json, F("Plugins"), String(deviceCount + 1));
+        add_next_json_object_value(json, F("Plugin description"), getPluginDescriptionString());
+        add_next_json_object_value(json, F("Local time"), getDateTimeString('-',':',' '));
+        add_next_json_object_value(json, F("Unit"), String(Settings.Unit));
+        add_next_json_object_value(json, F("Name"), String(Settings.Name));
+        add_next_json_object_value(json, F("Uptime"), String(wdcounter / 2));
+        add_next_json_object_value(json, F("Last boot cause"), getLastBootCauseString());
+        add_next_json_object_value(json, F("Reset Reason"), getResetReasonString());
+
+        if (wdcounter > 0)
+        {
+            add_next_json_object_value(json, F("Load"), String(getCPUload()));
+            add_next_json_object_value(json, F("Load LC"), String(getLoopCountPerSec()));
+        }
+        add_next_json_object_value(json, F("Event queue length"), String(EventQueue.size()));
+        add_next_json_object_value(json, F("Event queue max length"), String(EventQueue.max_length));
+        add_next_json_object_value(json, F("Event queue dropped"), String(EventQueue.dropped));
+        add_next_json_object_value(json, F("Event queue coalesced"), String(EventQueue.coalesced));
+
+        add_last_json_object_value(json, F("Free RAM"), String(ESP.getFreeHeap()));
+        json += F(",\n");
+
+        json += F("\"Controllers\":[\n");
+        bool comma_between = false;
+        for (byte x = 0; x < CONTROLLER_MAX; x++)
+        {
+          if (!Settings.ControllerEnabled[x] || !Settings.Protocol[x])
+            continue;
+          if (comma_between)
+            json += F(",\n");
+          comma_between = true;
+          json += '{';
+          add_next_json_object_value(json, F("Nr"), String(x + 1));
+          add_next_json_object_value(json, F("Queued"), String(getSendDataQueueDepth(x)));
+          add_next_json_object_value(json, F("Sent"), String(ControllerQueue[x].sent));
+          add_next_json_object_value(json, F("Dropped"), String(ControllerQueue[x].dropped));
+          add_next_json_object_value(json, F("Retries"), String(ControllerQueue[x].retries));
+          add_next_json_object_value(json, F("Failures"), String(ControllerQueue[x].failures));
+          add_last_json_object_value(json, F("Settings loads"), String(ControllerSettingsCache[x].loads));
+        }
+        json += F("],\n");
+      }
+      return true;
+
+    case JSON_PAGE_WIFI:
+      page.section = JSON_PAGE_NODES;
+      if (page.showWifi) {
+        json += F("\"WiFi\":{\n");
+        #if defined(ESP8266)
+          add_next_json_object_value(json, F("Hostname"), WiFi.hostname());
+        #endif
+        add_next_json_object_value(json, F("IP config"), useStaticIP() ? F("Static") : F("DHCP"));
+        add_next_json_object_value(json, F("IP"), WiFi.localIP().toString());
+        add_next_json_object_value(json, F("Subnet Mask"), WiFi.subnetMask().toString());
+        add_next_json_object_value(json, F("Gateway IP"), WiFi.gatewayIP().toString());
+        add_next_json_object_value(json, F("MAC address"), WiFi.macAddress());
+        add_next_json_object_value(json, F("DNS 1"), WiFi.dnsIP(0).toString());
+        add_next_json_object_value(json, F("DNS 2"), WiFi.dnsIP(1).toString());
+        add_next_json_object_value(json, F("SSID"), WiFi.SSID());
+        add_next_json_object_value(json, F("BSSID"), WiFi.BSSIDstr());
+        add_next_json_object_value(json, F("Channel"), String(WiFi.channel()));
+        add_next_json_object_value(json, F("Connected msec"), String(timeDiff(lastConnectMoment, millis())));
+        add_next_json_object_value(json, F("Last Disconnect Reason"), String(lastDisconnectReason));
+        add_next_json_object_value(json, F("Last Disconnect Reason str"), getLastDisconnectReason());
+        add_next_json_object_value(json, F("Number reconnects"), String(wifi_reconnects));
+        add_last_json_object_value(json, F("RSSI"), String(WiFi.RSSI()));
+        json += F(",\n");
+      }
+      return true;
+
+    case JSON_PAGE_NODES:
+      page.section = JSON_PAGE_TASKS;
+      if (page.showNodes) {
+        bool comma_between=false;
+        for (byte x = 0; x < UNIT_MAX; x++)
+        {
+          if (Nodes[x].ip[0] != 0)
+          {
+
+            char ip[20];
+
+            sprintf_P(ip, PSTR("%u.%u.%u.%u"), Nodes[x].ip[0], Nodes[x].ip[1], Nodes[x].ip[2], Nodes[x].ip[3]);
+
+            if( comma_between ) {
+              json += F(",");
+            } else {
+              comma_between=true;
+              json += F("\"nodes\":[\n"); // open json array if >0 nodes
+            }
+
+            json += F("{");
+            add_next_json_object_value(json, F("nr"), String(x));
+            add_next_json_object_value(json, F("name"),
+                (x != Settings.Unit) ? Nodes[x].nodeName : Settings.Name);
+
+            if (Nodes[x].build) {
+              add_next_json_object_value(json, F("build"), String(Nodes[x].build));
+            }
+
+            if (Nodes[x].nodeType) {
+              const String platform = getNodeTypeDisplayString(Nodes[x].nodeType);
+              if (platform.length() > 0)
+                add_next_json_object_value(json, F("platform"), platform);
+            }
+            add_next_json_object_value(json, F("ip"), ip);
+            add_last_json_object_value(json, F("age"),  String( Nodes[x].age ));
+          } // if node info exists
+        } // for loop
+        if(comma_between) {
+          json += F("],\n"); // close array if >0 nodes
+        }
+      }
+      json += F("\"Sensors\":[\n");
+      return true;
+
+    case JSON_PAGE_TASKS:
+      if (page.nextTask > page.lastTask) {
+        page.section = JSON_PAGE_END;
+        return true;
+      }
+      addJsonPageTask(page, page.nextTask++, json);
+      return true;
+
+    case JSON_PAGE_END:
+      page.section = JSON_PAGE_DONE;
+      if (page.commaBetween)
+        json += F("\n");
+      if (!page.showSpecificTask) {
+        json += F("],\n");
+        add_next_json_object_value(json, F("Version"), String(dataVersion));
+        add_last_json_object_value(json, F("TTL"), String(page.ttl * 1000));
+      }
+      return true;
+  }
+  return false;
+}
+
+void addJsonPageTask(JsonPageStruct& page, byte TaskIndex, String& json)
+{
+  if (!Settings.TaskDeviceNumber[TaskIndex])
+    return;
+  byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
+  const unsigned long taskInterval = Settings.TaskDeviceTimer[TaskIndex];
+  if (Device[DeviceIndex].ValueCount != 0) {
+    if (page.ttl > taskInterval && taskInterval > 0 && Settings.TaskDeviceEnabled[TaskIndex]) {
+      page.ttl = taskInterval;
+    }
+  }
+  // Only the tasks changed after the version the client already has.
+  if (page.since != 0 && taskDataVersion[TaskIndex] <= page.since)
+    return;
+  const TaskSettingsCacheStruct& taskSettings = getTaskSettingsCache(TaskIndex);
+  if (page.commaBetween)
+    json += F(",\n");
+  page.commaBetween = true;
+  json += F("{\n");
+  // For simplicity, do the optional values first.
+  if (Device[DeviceIndex].ValueCount != 0) {
+    json += F("\"TaskValues\": [\n");
+    for (byte x = 0; x < Device[DeviceIndex].ValueCount; x++)
+    {
+      json += F("{");
+      add_next_json_object_value(json, F("ValueNumber"), String(x + 1));
+      add_next_json_object_value(json, F("Name"), taskSettings.TaskDeviceValueNames[x]);
+      add_next_json_object_value(json, F("NrDecimals"), String(taskSettings.TaskDeviceValueDecimals[x]));
+      add_last_json_object_value(json, F("Value"), formatUserVarNoCheck(TaskIndex, x));
+      if (x < (Device[DeviceIndex].ValueCount - 1))
+        json += F(",\n");
+    }
+    json += F("],\n");
+  }
+  if (page.showSpecificTask) {
+    add_next_json_object_value(json, F("TTL"), String(page.ttl * 1000));
+  }
+  if (page.showDataAcquisition) {
+    json += F("\"DataAcquisition\": [\n");
+    for (byte x = 0; x < CONTROLLER_MAX; x++)
+    {
+      json += F("{");
+      add_next_json_object_value(json, F("Controller"), String(x + 1));
+      add_next_json_object_value(json, F("IDX"), String(Settings.TaskDeviceID[x][TaskIndex]));
+      add_last_json_object_value(json, F("Enabled"), jsonBool(Settings.TaskDeviceSendData[x][TaskIndex]));
+      if (x < (CONTROLLER_MAX - 1))
+        json += F(",\n");
+    }
+    json += F("],\n");
+  }
+  if (page.showTaskDetails) {
+    add_next_json_object_value(json, F("TaskInterval"), String(taskInterval));
+    add_next_json_object_value(json, F("Type"), getPluginNameFromDeviceIndex(DeviceIndex));
+    add_next_json_object_value(json, F("TaskName"), taskSettings.TaskDeviceName);
+  }
+  add_next_json_object_value(json, F("TaskEnabled"), jsonBool(Settings.TaskDeviceEnabled[TaskIndex]));
+  add_last_json_object_value(json, F("TaskNumber"), String(TaskIndex + 1));
+}
+
+// Same structure and keys as the JSON version, numbers are sent binary.
+// Task values are sent as float (or unsigned for SENSOR_TYPE_LONG), not rounded
+// to NrDecimals, which is included so the client can do the rounding.
+void handle_json_cbor(int taskNr, unsigned long since, bool showSystem, bool showWifi,
+                      bool showNodes, bool showDataAcquisition, bool showTaskDetails)
+{
+  const bool showSpecificTask = taskNr > 0;
+  TXBuffer.startCborStream();
   if (!showSpecificTask)
   {
-    TXBuffer += '{';
+    stream_cbor_begin(CBOR_MAP);
     if (showSystem) {
-      TXBuffer += F("\"System\":{\n");
-      stream_next_json_object_value(F("Build"), String(BUILD));
-      stream_next_json_object_value(F("Git Build"), String(BUILD_GIT));
-      stream_next_json_object_value(F("System libraries"), getSystemLibraryString());
-      stream_next_json_object_value(F("Plugins"), String(deviceCount + 1));
-      stream_next_json_object_value(F("Plugin description"), getPluginDescriptionString());
-      stream_next_json_object_value(F("Local time"), getDateTimeString('-',':',' '));
-      stream_next_json_object_value(F("Unit"), String(Settings.Unit));
-      stream_next_json_object_value(F("Name"), String(Settings.Name));
-      stream_next_json_object_value(F("Uptime"), String(wdcounter / 2));
-      stream_next_json_object_value(F("Last boot cause"), getLastBootCauseString());
-      stream_next_json_object_value(F("Reset Reason"), getResetReasonString());
-
+      stream_cbor_text(F("System"));
+      stream_cbor_begin(CBOR_MAP);
+      stream_cbor_uint_value(F("Build"), BUILD);
+      stream_cbor_text_value(F("Git Build"), BUILD_GIT);
+      stream_cbor_text_value(F("System libraries"), getSystemLibraryString());
+      stream_cbor_uint_value(F("Plugins"), deviceCount + 1);
+      stream_cbor_text_value(F("Plugin description"), getPluginDescriptionString());
+      stream_cbor_text_value(F("Local time"), getDateTimeString('-',':',' '));
+      stream_cbor_uint_value(F("Unit"), Settings.Unit);
+      stream_cbor_text_value(F("Name"), Settings.Name);
+      stream_cbor_uint_value(F("Uptime"), wdcounter / 2);
+      stream_cbor_text_value(F("Last boot cause"), getLastBootCauseString());
+      stream_cbor_text_value(F("Reset Reason"), getResetReasonString());
       if (wdcounter > 0)
       {
-          stream_next_json_object_value(F("Load"), String(getCPUload()));
-          stream_next_json_object_value(F("Load LC"), String(getLoopCountPerSec()));
+        stream_cbor_float_value(F("Load"), getCPUload());
+        stream_cbor_uint_value(F("Load LC"), getLoopCountPerSec());
       }
-
-      stream_last_json_object_value(F("Free RAM"), String(ESP.getFreeHeap()));
-      TXBuffer += F(",\n");
+      stream_cbor_uint_value(F("Event queue length"), EventQueue.size());
+      stream_cbor_uint_value(F("Event queue max length"), EventQueue.max_length);
+      stream_cbor_uint_value(F("Event queue dropped"), EventQueue.dropped);
+      stream_cbor_uint_value(F("Event queue coalesced"), EventQueue.coalesced);
+      stream_cbor_uint_value(F("Free RAM"), ESP.getFreeHeap());
+      stream_cbor_end();
+
+      stream_cbor_text(F("Controllers"));
+      stream_cbor_begin(CBOR_ARRAY);
+      for (byte x = 0; x < CONTROLLER_MAX; x++)
+      {
+        if (!Settings.ControllerEnabled[x] || !Settings.Protocol[x])
+          continue;
+        stream_cbor_begin(CBOR_MAP);
+        stream_cbor_uint_value(F("Nr"), x + 1);
+        stream_cbor_uint_value(F("Queued"), getSendDataQueueDepth(x));
+        stream_cbor_uint_value(F("Sent"), ControllerQueue[x].sent);
+        stream_cbor_uint_value(F("Dropped"), ControllerQueue[x].dropped);
+        stream_cbor_uint_value(F("Retries"), ControllerQueue[x].retries);
+        stream_cbor_uint_value(F("Failures"), ControllerQueue[x].failures);
+        stream_cbor_uint_value(F("Settings loads"), ControllerSettingsCache[x].loads);
+        stream_cbor_end();
+      }
+      stream_cbor_end();
     }
     if (showWifi) {
-      TXBuffer += F("\"WiFi\":{\n");
+      stream_cbor_text(F("WiFi"));
+      stream_cbor_begin(CBOR_MAP);
       #if defined(ESP8266)
-        stream_next_json_object_value(F("Hostname"), WiFi.hostname());
+        stream_cbor_text_value(F("Hostname"), WiFi.hostname());
       #endif
-      stream_next_json_object_value(F("IP config"), useStaticIP() ? F("Static") : F("DHCP"));
-      stream_next_json_object_value(F("IP"), WiFi.localIP().toString());
-      stream_next_json_object_value(F("Subnet Mask"), WiFi.subnetMask().toString());
-      stream_next_json_object_value(F("Gateway IP"), WiFi.gatewayIP().toString());
-      stream_next_json_object_value(F("MAC address"), WiFi.macAddress());
-      stream_next_json_object_value(F("DNS 1"), WiFi.dnsIP(0).toString());
-      stream_next_json_object_value(F("DNS 2"), WiFi.dnsIP(1).toString());
-      stream_next_json_object_value(F("SSID"), WiFi.SSID());
-      stream_next_json_object_value(F("BSSID"), WiFi.BSSIDstr());
-      stream_next_json_object_value(F("Channel"), String(WiFi.channel()));
-      stream_next_json_object_value(F("Connected msec"), String(timeDiff(lastConnectMoment, millis())));
-      stream_next_json_object_value(F("Last Disconnect Reason"), String(lastDisconnectReason));
-      stream_next_json_object_value(F("Last Disconnect Reason str"), getLastDisconnectReason());
-      stream_next_json_object_value(F("Number reconnects"), String(wifi_reconnects));
-      stream_last_json_object_value(F("RSSI"), String(WiFi.RSSI()));
-      TXBuffer += F(",\n");
+      stream_cbor_text_value(F("IP config"), useStaticIP() ? F("Static") : F("DHCP"));
+      stream_cbor_text_value(F("IP"), WiFi.localIP().toString());
+      stream_cbor_text_value(F("Subnet Mask"), WiFi.subnetMask().toString());
+      stream_cbor_text_value(F("Gateway IP"), WiFi.gatewayIP().toString());
+      stream_cbor_text_value(F("MAC address"), WiFi.macAddress());
+      stream_cbor_text_value(F("DNS 1"), WiFi.dnsIP(0).toString());
+      stream_cbor_text_value(F("DNS 2"), WiFi.dnsIP(1).toString());
+      stream_cbor_text_value(F("SSID"), WiFi.SSID());
+      stream_cbor_text_value(F("BSSID"), WiFi.BSSIDstr());
+      stream_cbor_uint_value(F("Channel"), WiFi.channel());
+      stream_cbor_uint_value(F("Connected msec"), timeDiff(lastConnectMoment, millis()));
+      stream_cbor_uint_value(F("Last Disconnect Reason"), lastDisconnectReason);
+      stream_cbor_text_value(F("Last Disconnect Reason str"), getLastDisconnectReason());
+      stream_cbor_uint_value(F("Number reconnects"), wifi_reconnects);
+      stream_cbor_int_value(F("RSSI"), WiFi.RSSI());
+      stream_cbor_end();
     }
-    if(showNodes) {
-      bool comma_between=false;
+    if (showNodes) {
+      bool nodesStarted = false;
       for (byte x = 0; x < UNIT_MAX; x++)
       {
-        if (Nodes[x].ip[0] != 0)
-        {
-
-          char ip[20];
-
-          sprintf_P(ip, PSTR("%u.%u.%u.%u"), Nodes[x].ip[0], Nodes[x].ip[1], Nodes[x].ip[2], Nodes[x].ip[3]);
-
-          if( comma_between ) {
-            TXBuffer += F(",");
-          } else {
-            comma_between=true;
-            TXBuffer += F("\"nodes\":[\n"); // open json array if >0 nodes
-          }
-
-          TXBuffer += F("{");
-          stream_next_json_object_value(F("nr"), String(x));
-          stream_next_json_object_value(F("name"),
-              (x != Settings.Unit) ? Nodes[x].nodeName : Settings.Name);
-
-          if (Nodes[x].build) {
-            stream_next_json_object_value(F("build"), String(Nodes[x].build));
-          }
-
-          if (Nodes[x].nodeType) {
-            String platform;
-            switch (Nodes[x].nodeType)
-            {
-              case NODE_TYPE_ID_ESP_EASY_STD:     platform = F("ESP Easy");      break;
-              case NODE_TYPE_ID_ESP_EASYM_STD:    platform = F("ESP Easy Mega"); break;
-              case NODE_TYPE_ID_ESP_EASY32_STD:   platform = F("ESP Easy 32");   break;
-              case NODE_TYPE_ID_ARDUINO_EASY_STD: platform = F("Arduino Easy");  break;
-              case NODE_TYPE_ID_NANO_EASY_STD:    platform = F("Nano Easy");     break;
-            }
-            if (platform.length() > 0)
-              stream_next_json_object_value(F("platform"), platform);
-          }
-          stream_next_json_object_value(F("ip"), ip);
-          stream_last_json_object_value(F("age"),  String( Nodes[x].age ));
-        } // if node info exists
-      } // for loop
-      if(comma_between) {
-        TXBuffer += F("],\n"); // close array if >0 nodes
+        if (Nodes[x].ip[0] == 0)
+          continue;
+        if (!nodesStarted) {
+          stream_cbor_text(F("nodes"));
+          stream_cbor_begin(CBOR_ARRAY);
+          nodesStarted = true;
+        }
+        char ip[20];
+        sprintf_P(ip, PSTR("%u.%u.%u.%u"), Nodes[x].ip[0], Nodes[x].ip[1], Nodes[x].ip[2], Nodes[x].ip[3]);
+        stream_cbor_begin(CBOR_MAP);
+        stream_cbor_uint_value(F("nr"), x);
+        stream_cbor_text_value(F("name"), (x != Settings.Unit) ? Nodes[x].nodeName : Settings.Name);
+        if (Nodes[x].build)
+          stream_cbor_uint_value(F("build"), Nodes[x].build);
+        if (Nodes[x].nodeType) {
+          const String platform = getNodeTypeDisplayString(Nodes[x].nodeType);
+          if (platform.length() > 0)
+            stream_cbor_text_value(F("platform"), platform);
+        }
+        stream_cbor_text_value(F("ip"), ip);
+        stream_cbor_uint_value(F("age"), Nodes[x].age);
+        stream_cbor_end();
       }
+      if (nodesStarted)
+        stream_cbor_end();
     }
+    stream_cbor_text(F("Sensors"));
+    stream_cbor_begin(CBOR_ARRAY);
   }
 
   byte firstTaskIndex = 0;
@@ -3811,73 +4701,129 @@ void handle_json()
     firstTaskIndex = taskNr - 1;
     lastTaskIndex = taskNr - 1;
   }
-  byte lastActiveTaskIndex = 0;
-  for (byte TaskIndex = firstTaskIndex; TaskIndex <= lastTaskIndex; TaskIndex++) {
-    if (Settings.TaskDeviceNumber[TaskIndex])
-      lastActiveTaskIndex = TaskIndex;
-  }
-
-  if (!showSpecificTask) TXBuffer += F("\"Sensors\":[\n");
   unsigned long ttl_json = 60; // The shortest interval per enabled task (with output values) in seconds
-  for (byte TaskIndex = firstTaskIndex; TaskIndex <= lastActiveTaskIndex; TaskIndex++)
+  for (byte TaskIndex = firstTaskIndex; TaskIndex <= lastTaskIndex; TaskIndex++)
   {
-    if (Settings.TaskDeviceNumber[TaskIndex])
-    {
-      byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
-      const unsigned long taskInterval = Settings.TaskDeviceTimer[TaskIndex];
-      LoadTaskSettings(TaskIndex);
-      TXBuffer += F("{\n");
-      // For simplicity, do the optional values first.
-      if (Device[DeviceIndex].ValueCount != 0) {
-        if (ttl_json > taskInterval && taskInterval > 0 && Settings.TaskDeviceEnabled[TaskIndex]) {
-          ttl_json = taskInterval;
-        }
-        TXBuffer += F("\"TaskValues\": [\n");
-        for (byte x = 0; x < Device[DeviceIndex].ValueCount; x++)
-        {
-          TXBuffer += F("{");
-          stream_next_json_object_value(F("ValueNumber"), String(x + 1));
-          stream_next_json_object_value(F("Name"), String(ExtraTaskSettings.TaskDeviceValueNames[x]));
-          stream_next_json_object_value(F("NrDecimals"), String(ExtraTaskSettings.TaskDeviceValueDecimals[x]));
-          stream_last_json_object_value(F("Value"), formatUserVarNoCheck(TaskIndex, x));
-          if (x < (Device[DeviceIndex].ValueCount - 1))
-            TXBuffer += F(",\n");
-        }
-        TXBuffer += F("],\n");
-      }
-      if (showSpecificTask) {
-        stream_next_json_object_value(F("TTL"), String(ttl_json * 1000));
+    if (TXBuffer.isAborted())
+      break;
+    if (!Settings.TaskDeviceNumber[TaskIndex])
+      continue;
+    const byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[TaskIndex]);
+    const byte valueCount = Device[DeviceIndex].ValueCount;
+    const unsigned long taskInterval = Settings.TaskDeviceTimer[TaskIndex];
+    if (valueCount != 0) {
+      if (ttl_json > taskInterval && taskInterval > 0 && Settings.TaskDeviceEnabled[TaskIndex]) {
+        ttl_json = taskInterval;
       }
-      if (showDataAcquisition) {
-        TXBuffer += F("\"DataAcquisition\": [\n");
-        for (byte x = 0; x < CONTROLLER_MAX; x++)
-        {
-          TXBuffer += F("{");
-          stream_next_json_object_value(F("Controller"), String(x + 1));
-          stream_next_json_object_value(F("IDX"), String(Settings.TaskDeviceID[x][TaskIndex]));
-          stream_last_json_object_value(F("Enabled"), jsonBool(Settings.TaskDeviceSendData[x][TaskIndex]));
-          if (x < (CONTROLLER_MAX - 1))
-            TXBuffer += F(",\n");
+    }
+    if (since != 0 && taskDataVersion[TaskIndex] <= since)
+      continue;
+    const TaskSettingsCacheStruct& taskSettings = getTaskSettingsCache(TaskIndex);
+    stream_cbor_begin(CBOR_MAP);
+    if (valueCount != 0) {
+      stream_cbor_text(F("TaskValues"));
+      stream_cbor_begin(CBOR_ARRAY);
+      const byte BaseVarIndex = TaskIndex * VARS_PER_TASK;
+      for (byte x = 0; x < valueCount; x++)
+      {
+        stream_cbor_begin(CBOR_MAP);
+        stream_cbor_uint_value(F("ValueNumber"), x + 1);
+        stream_cbor_text_value(F("Name"), taskSettings.TaskDeviceValueNames[x]);
+        stream_cbor_uint_value(F("NrDecimals"), taskSettings.TaskDeviceValueDecimals[x]);
+        if (Device[DeviceIndex].VType == SENSOR_TYPE_LONG) {
+          stream_cbor_uint_value(F("Value"), (unsigned long)UserVar[BaseVarIndex] + ((unsigned long)UserVar[BaseVarIndex + 1] << 16));
+        } else {
+          stream_cbor_float_value(F("Value"), UserVar[BaseVarIndex + x]);
         }
-        TXBuffer += F("],\n");
+        stream_cbor_end();
       }
-      if (showTaskDetails) {
-        stream_next_json_object_value(F("TaskInterval"), String(taskInterval));
-        stream_next_json_object_value(F("Type"), getPluginNameFromDeviceIndex(DeviceIndex));
-        stream_next_json_object_value(F("TaskName"), String(ExtraTaskSettings.TaskDeviceName));
+      stream_cbor_end();
+    }
+    if (showSpecificTask) {
+      stream_cbor_uint_value(F("TTL"), ttl_json * 1000);
+    }
+    if (showDataAcquisition) {
+      stream_cbor_text(F("DataAcquisition"));
+      stream_cbor_begin(CBOR_ARRAY);
+      for (byte x = 0; x < CONTROLLER_MAX; x++)
+      {
+        stream_cbor_begin(CBOR_MAP);
+        stream_cbor_uint_value(F("Controller"), x + 1);
+        stream_cbor_uint_value(F("IDX"), Settings.TaskDeviceID[x][TaskIndex]);
+        stream_cbor_bool_value(F("Enabled"), Settings.TaskDeviceSendData[x][TaskIndex]);
+        stream_cbor_end();
       }
-      stream_next_json_object_value(F("TaskEnabled"), jsonBool(Settings.TaskDeviceEnabled[TaskIndex]));
-      stream_last_json_object_value(F("TaskNumber"), String(TaskIndex + 1));
-      if (TaskIndex != lastActiveTaskIndex)
-        TXBuffer += F(",");
-      TXBuffer += F("\n");
+      stream_cbor_end();
+    }
+    if (showTaskDetails) {
+      stream_cbor_uint_value(F("TaskInterval"), taskInterval);
+      stream_cbor_text_value(F("Type"), getPluginNameFromDeviceIndex(DeviceIndex));
+      stream_cbor_text_value(F("TaskName"), taskSettings.TaskDeviceName);
     }
+    stream_cbor_bool_value(F("TaskEnabled"), Settings.TaskDeviceEnabled[TaskIndex]);
+    stream_cbor_uint_value(F("TaskNumber"), TaskIndex + 1);
+    stream_cbor_end();
   }
   if (!showSpecificTask) {
-    TXBuffer += F("],\n");
-    stream_last_json_object_value(F("TTL"), String(ttl_json * 1000));
+    stream_cbor_end();
+    stream_cbor_uint_value(F("Version"), dataVersion);
+    stream_cbor_uint_value(F("TTL"), ttl_json * 1000);
+    stream_cbor_end();
   }
+  TXBuffer.endStream();
+}
 
+//********************************************************************************
+// Web Interface JSON timing statistics (latency histograms per task and plugin function)
+//********************************************************************************
+void handle_timingstats_json() {
+  if (!isLoggedIn()) return;
+  TXBuffer.startJsonStream();
+  TXBuffer += F("{\"Plugins\":[\n");
+  bool comma_between = false;
+  for (byte slot = 0; slot < pluginStats.nrUsed; ++slot) {
+    const TimingHistogram& stats = pluginStats.stats[slot];
+    if (stats.isEmpty()) continue;
+    if (comma_between) {
+      TXBuffer += F(",\n");
+    }
+    comma_between = true;
+    const byte taskIndex = pluginStats.taskIndex[slot];
+    String functionName = getPluginFunctionName(pluginStats.pluginFunction[slot]);
+    functionName.trim();
+    TXBuffer += '{';
+    stream_next_json_object_value(F("TaskNumber"), String(taskIndex + 1));
+    stream_next_json_object_value(F("TaskName"), getTaskDeviceName(taskIndex));
+    stream_next_json_object_value(F("Type"), getPluginNameFromDeviceIndex(getDeviceIndex(Settings.TaskDeviceNumber[taskIndex])));
+    stream_next_json_object_value(F("Function"), functionName);
+    stream_next_json_object_value(F("Count"), String(stats.getCount()));
+    stream_next_json_object_value(F("Avg"), String(stats.getAvg()));
+    stream_next_json_object_value(F("P50"), String(stats.getPercentile(50)));
+    stream_next_json_object_value(F("P90"), String(stats.getPercentile(90)));
+    stream_next_json_object_value(F("P99"), String(stats.getPercentile(99)));
+    stream_last_json_object_value(F("Max"), String(stats.getMax()));
+  }
+  TXBuffer += F("],\n\"Misc\":[\n");
+  comma_between = false;
+  for (auto& x: miscStats) {
+    if (x.second.isEmpty()) continue;
+    if (comma_between) {
+      TXBuffer += F(",\n");
+    }
+    comma_between = true;
+    unsigned long minVal, maxVal;
+    const unsigned int count = x.second.getMinMax(minVal, maxVal);
+    String name = getMiscStatsName(x.first);
+    name.trim();
+    TXBuffer += '{';
+    stream_next_json_object_value(F("Name"), name);
+    stream_next_json_object_value(F("Count"), String(count));
+    stream_next_json_object_value(F("Avg"), String(x.second.getAvg()));
+    stream_next_json_object_value(F("Min"), String(minVal));
+    stream_last_json_object_value(F("Max"), String(maxVal));
+  }
+  TXBuffer += F("],\n");
+  stream_last_json_object_value(F("Dropped"), String(pluginStats.dropped));
   TXBuffer.endStream();
 }
 
@@ -3943,6 +4889,7 @@ void handle_advanced() {
     Settings.MQTTUseUnitNameAsClientId = isFormItemChecked(F("mqttuseunitnameasclientid"));
     Settings.Latitude = getFormItemFloat(F("latitude"));
     Settings.Longitude = getFormItemFloat(F("longitude"));
+    Settings.EventQueueBatchSize = getFormItemInt(F("eventqueuebatch"));
 
     addHtmlError(SaveSettings());
     if (Settings.UseNTP)
@@ -4020,6 +4967,9 @@ void handle_advanced() {
 
   addFormNumericBox(F("Connection Failure Threshold"), F("cft"), Settings.ConnectionFailuresThreshold, 0, 100);
 
+  addFormNumericBox(F("Event Queue Batch Size"), F("eventqueuebatch"), Settings.EventQueueBatchSize, 0, EVENT_QUEUE_MAX);
+  TXBuffer += F(" (0 = default)");
+
   addFormNumericBox(F("I2C ClockStretchLimit"), F("wireclockstretchlimit"), Settings.WireClockStretchLimit);   //TODO define limits
   #if defined(FEATURE_ARDUINO_OTA)
   addFormCheckBox(F("Enable Arduino OTA"), F("arduinootaenable"), Settings.ArduinoOTAEnable);
@@ -4137,9 +5087,17 @@ void handle_download()
 //  sendHeadandTail(F("TmplStd"));
 
 
-  fs::File dataFile = SPIFFS.open(F(FILE_CONFIG), "r");
-  if (!dataFile)
-    return;
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+  const bool fromPartition = settingsPartition.data != nullptr;
+#else
+  const bool fromPartition = false;
+#endif
+  fs::File dataFile;
+  if (!fromPartition) {
+    dataFile = SPIFFS.open(F(FILE_CONFIG), "r");
+    if (!dataFile)
+      return;
+  }
 
   String str = F("attachment; filename=config_");
   str += Settings.Name;
@@ -4155,7 +5113,21 @@ void handle_download()
   str += F(".dat");
 
   WebServer.sendHeader(F("Content-Disposition"), str);
-  WebServer.streamFile(dataFile, F("application/octet-stream"));
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+  if (fromPartition) {
+    // Sent straight from the mapped flash.
+    if (startDataWebStream(settingsPartition.data, CONFIG_FILE_SIZE, F("application/octet-stream")))
+      return;
+    WebServer.setContentLength(CONFIG_FILE_SIZE);
+    WebServer.send(200, F("application/octet-stream"), "");
+    WiFiClient client = WebServer.client();
+    for (int pos = 0; pos < CONFIG_FILE_SIZE && client.connected(); pos += 1024)
+      client.write(settingsPartition.data + pos, 1024);
+    return;
+  }
+#endif
+  if (!startFileWebStream(dataFile, F("application/octet-stream"), false))
+    WebServer.streamFile(dataFile, F("application/octet-stream"));
 }
 
 
@@ -4286,6 +5258,17 @@ void handleFileUpload() {
       log += upload.totalSize;
       addLog(LOG_LEVEL_INFO, log);
     }
+#if defined(ESP32) && defined(USE_SETTINGS_PARTITION)
+    // The uploaded config.dat is moved from SPIFFS into the settings partition.
+    if (valid && settingsPartition.data != nullptr && strcasecmp(upload.filename.c_str(), FILE_CONFIG) == 0)
+      settingsPartitionImport();
+#endif
+    // Uploaded file may be a rules set or a config.dat with other task or controller settings.
+    checkRuleSets();
+    clearTaskSettingsCache();
+    clearTaskFormulas();
+    invalidateControllerSettingsCache();
+    clearWebFileCaches();
   }
 
   if (valid)
@@ -4328,18 +5311,31 @@ bool loadFromFS(boolean spiffs, String path) {
   path = path.substring(1);
   if (spiffs)
   {
-    fs::File dataFile = SPIFFS.open(path.c_str(), "r");
+    // Use a gzip compressed copy (file.gz) when present.
+    // streamFile() adds the "Content-Encoding: gzip" header for .gz files, startFileWebStream() when told so.
+    fs::File dataFile;
+    const String gzPath = path + F(".gz");
+    const bool gzip = clientAcceptsGzip() && SPIFFS.exists(gzPath);
+    if (gzip)
+      dataFile = SPIFFS.open(gzPath.c_str(), "r");
+    else if (SPIFFS.exists(path))
+      dataFile = SPIFFS.open(path.c_str(), "r");
     if (!dataFile)
       return false;
 
     //prevent reloading stuff on every click
     WebServer.sendHeader(F("Cache-Control"), F("max-age=3600, public"));
-    WebServer.sendHeader(F("Vary"),"*");
-    WebServer.sendHeader(F("ETag"), F("\"2.0.0\""));
+    WebServer.sendHeader(F("Vary"), F("Accept-Encoding"));
+    if (sendETagNotModified(getFileETag(dataFile))) {
+      dataFile.close();
+      statusLED(true);
+      return true;
+    }
 
     if (path.endsWith(F(".dat")))
       WebServer.sendHeader(F("Content-Disposition"), F("attachment;"));
-    WebServer.streamFile(dataFile, dataType);
+    if (!startFileWebStream(dataFile, dataType, gzip))
+      WebServer.streamFile(dataFile, dataType);
     dataFile.close();
   }
   else
@@ -4358,6 +5354,103 @@ bool loadFromFS(boolean spiffs, String path) {
   return true;
 }
 
+bool clientAcceptsGzip() {
+  return WebServer.header(F("Accept-Encoding")).indexOf(F("gzip")) != -1;
+}
+
+// Send the ETag header, when it matches If-None-Match also send "304 Not Modified" and return true.
+bool sendETagNotModified(const String& etag) {
+  WebServer.sendHeader(F("ETag"), etag);
+  if (WebServer.header(F("If-None-Match")) != etag)
+    return false;
+  WebServer.send(304);
+  return true;
+}
+
+// FNV-1a hash, to be used for content based ETags.
+uint32_t contentHash(uint32_t hash, const uint8_t* data, size_t length, bool progmem) {
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= progmem ? pgm_read_byte(data + i) : data[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+void clearFileETagCache() {
+  for (byte i = 0; i < FILE_ETAG_CACHE_MAX; ++i) {
+    fileETagCache[i].path = String();
+    fileETagCache[i].size = 0;
+  }
+}
+
+// Files on SPIFFS were added, changed or removed.
+void clearWebFileCaches() {
+  clearCustomPageCache();
+  clearFileETagCache();
+}
+
+// ETag based on the file content. Hashes are cached, so the file is only read once.
+String getFileETag(fs::File& dataFile) {
+  const String path = dataFile.name();
+  const size_t size = dataFile.size();
+  uint32_t hash = 0;
+  bool found = false;
+  for (byte i = 0; i < FILE_ETAG_CACHE_MAX && !found; ++i) {
+    if (fileETagCache[i].path == path && fileETagCache[i].size == size) {
+      hash = fileETagCache[i].hash;
+      found = true;
+    }
+  }
+  if (!found) {
+    hash = 2166136261UL;
+    uint8_t buffer[128];
+    int read;
+    while ((read = dataFile.read(buffer, sizeof(buffer))) > 0)
+      hash = contentHash(hash, buffer, read, false);
+    dataFile.seek(0, fs::SeekSet);
+    FileETagCacheStruct& entry = fileETagCache[fileETagCacheNext];
+    fileETagCacheNext = (fileETagCacheNext + 1) % FILE_ETAG_CACHE_MAX;
+    entry.path = path;
+    entry.size = size;
+    entry.hash = hash;
+  }
+  char etag[24];
+  sprintf_P(etag, PSTR("\"%08x-%x\""), (unsigned int)hash, (unsigned int)size);
+  return etag;
+}
+
+//********************************************************************************
+// Default CSS, when there is no esp.css on SPIFFS
+//********************************************************************************
+void handle_default_css() {
+  checkRAM(F("handle_default_css"));
+  if (SPIFFS.exists(F("esp.css")) || SPIFFS.exists(F("esp.css.gz"))) {
+    loadFromFS(true, F("/esp.css"));
+    return;
+  }
+  // The gzip copy is generated by gzip_static_data.py, only use it when made from this pgDefaultCSS.
+  static uint32_t hash = 0;
+  static bool gzipValid = false;
+  if (hash == 0) {
+    const size_t length = strlen_P(pgDefaultCSS);
+    hash = contentHash(2166136261UL, (const uint8_t*)pgDefaultCSS, length, true);
+    gzipValid = length == pgDefaultCSS_gz_source_len && hash == pgDefaultCSS_gz_source_hash;
+  }
+  const bool gzip = gzipValid && clientAcceptsGzip();
+  char etag[24];
+  sprintf_P(etag, gzip ? PSTR("\"%08x-gz\"") : PSTR("\"%08x\""), (unsigned int)hash);
+  WebServer.sendHeader(F("Cache-Control"), F("max-age=3600, public"));
+  WebServer.sendHeader(F("Vary"), F("Accept-Encoding"));
+  if (sendETagNotModified(etag))
+    return;
+  if (gzip) {
+    WebServer.sendHeader(F("Content-Encoding"), F("gzip"));
+    WebServer.send_P(200, PSTR("text/css"), pgDefaultCSS_gz, pgDefaultCSS_gz_len);
+  } else {
+    WebServer.send_P(200, PSTR("text/css"), pgDefaultCSS);
+  }
+}
+
 //********************************************************************************
 // Web Interface custom page handler
 //********************************************************************************
@@ -4457,12 +5550,17 @@ boolean handle_custom(String path) {
 
   if (dataFile)
   {
-    String page = "";
-    page.reserve(dataFile.size());
-    while (dataFile.available())
-      page += ((char)dataFile.read());
+    const CustomPageCacheStruct* cache = getCustomPageCache(path, dataFile);
+    if (cache != nullptr) {
+      streamCustomPage(dataFile, *cache);
+    } else {
+      String page = "";
+      page.reserve(dataFile.size());
+      while (dataFile.available())
+        page += ((char)dataFile.read());
 
-    TXBuffer += parseTemplate(page,0);
+      TXBuffer += parseTemplate(page,0);
+    }
     dataFile.close();
   }
   else // if the requestef file does not exist, create a default action in case the page is named "dashboard*"
@@ -4503,6 +5601,140 @@ boolean handle_custom(String path) {
 
 
 
+//********************************************************************************
+// Compiled custom pages
+// A page is split in placeholders ([task#value], %sysvar%, {D}, &deg; ...) and the
+// literal text in between, which is streamed from the file without parsing.
+//********************************************************************************
+void clearCustomPageCache() {
+  for (byte i = 0; i < CUSTOM_PAGE_CACHE_MAX; ++i)
+    customPageCache[i].clear();
+}
+
+bool isPlaceholderChar(char c) {
+  return isAlphaNumeric(c) || c == '_' || c == '-' || c == '+' || c == '.';
+}
+
+// Returns the end (inclusive) of the placeholder starting at pos, or -1 if none starts there.
+int findPlaceholderEnd(const String& page, int pos) {
+  const int length = page.length();
+  const int maxEnd = std::min(length, pos + CUSTOM_PAGE_PLACEHOLDER_MAX);
+  switch (page[pos]) {
+    case '[':
+      // Same as parseTemplate(): up to the next ']', whatever is in between.
+      return page.indexOf(']', pos + 1);
+    case '%':
+    {
+      int end = pos + 1;
+      while (end < maxEnd && isPlaceholderChar(page[end])) ++end;
+      if (end == pos + 1 || end >= maxEnd || page[end] != '%')
+        return -1;
+      // Standard conversions have arguments, e.g. %c_dew_th%([task#temp],[task#hum])
+      if (end + 1 < length && page[end + 1] == '(') {
+        const int close = page.indexOf(')', end + 2);
+        if (close != -1 && page.indexOf('\n', end + 2) > close)
+          end = close;
+      }
+      return end;
+    }
+    case '{':
+    case '&':
+    {
+      // Special characters like {D}, {<<}, &deg;
+      const char close = page[pos] == '{' ? '}' : ';';
+      for (int end = pos + 1; end < maxEnd; ++end) {
+        const char c = page[end];
+        if (c == close)
+          return end == pos + 1 ? -1 : end;
+        if (isSpace(c) || c == '{' || c == '&')
+          return -1;
+      }
+      return -1;
+    }
+  }
+  return -1;
+}
+
+void compileCustomPage(fs::File& dataFile, CustomPageCacheStruct& cache) {
+  String page;
+  page.reserve(dataFile.size());
+  while (dataFile.available())
+    page += ((char)dataFile.read());
+  dataFile.seek(0, fs::SeekSet);
+
+  cache.placeholders.clear();
+  const int length = page.length();
+  for (int pos = 0; pos < length; ++pos) {
+    const int end = findPlaceholderEnd(page, pos);
+    if (end != -1) {
+      cache.placeholders.push_back(CustomPagePlaceholderStruct(pos, end - pos + 1));
+      pos = end;
+    }
+  }
+  if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+    String log = F("Custom page: ");
+    log += cache.path;
+    log += F(" compiled, placeholders: ");
+    log += cache.placeholders.size();
+    addLog(LOG_LEVEL_DEBUG, log);
+  }
+}
+
+// Get the compiled page, compile when not cached or changed.
+// Returns nullptr when the page is too big to be cached.
+const CustomPageCacheStruct* getCustomPageCache(const String& path, fs::File& dataFile) {
+  const size_t size = dataFile.size();
+  if (size > 0xFFFF)
+    return nullptr;
+  byte slot = 0;
+  for (byte i = 0; i < CUSTOM_PAGE_CACHE_MAX; ++i) {
+    CustomPageCacheStruct& cache = customPageCache[i];
+    if (cache.path == path && cache.size == size) {
+      cache.lastUsed = millis();
+      return &cache;
+    }
+    // Replace the least recently used one.
+    if (timeDiff(cache.lastUsed, customPageCache[slot].lastUsed) > 0)
+      slot = i;
+  }
+  CustomPageCacheStruct& cache = customPageCache[slot];
+  cache.clear();
+  cache.path = path;
+  cache.size = size;
+  cache.lastUsed = millis();
+  compileCustomPage(dataFile, cache);
+  return &cache;
+}
+
+void streamFileBlock(fs::File& dataFile, size_t length) {
+  char buffer[128];
+  while (length > 0 && !TXBuffer.isAborted()) {
+    const int read = dataFile.read((uint8_t*)buffer, std::min(length, sizeof(buffer)));
+    if (read <= 0)
+      return;
+    TXBuffer.addChars(buffer, read);
+    length -= read;
+  }
+}
+
+void streamCustomPage(fs::File& dataFile, const CustomPageCacheStruct& cache) {
+  size_t pos = 0;
+  for (auto& placeholder : cache.placeholders) {
+    streamFileBlock(dataFile, placeholder.start - pos);
+    if (TXBuffer.isAborted())
+      return;
+    String value;
+    value.reserve(placeholder.length);
+    for (uint16_t i = 0; i < placeholder.length && dataFile.available(); ++i)
+      value += ((char)dataFile.read());
+    TXBuffer += parseTemplate(value, 0);
+    pos = placeholder.start + placeholder.length;
+  }
+  if (cache.size > pos)
+    streamFileBlock(dataFile, cache.size - pos);
+}
+
+
 //********************************************************************************
 // Web Interface file list
 //********************************************************************************
@@ -4521,6 +5753,7 @@ void handle_filelist() {
   {
     SPIFFS.remove(fdelete);
     checkRuleSets();
+    clearWebFileCaches();
   }
 
 
@@ -4559,6 +5792,8 @@ void handle_filelist() {
   {
     SPIFFS.remove(fdelete);
     // flashCount();
+    checkRuleSets();
+    clearWebFileCaches();
   }
 
 
@@ -5346,6 +6581,16 @@ void handle_sysinfo() {
    TXBuffer += RTC.flashCounter;
    TXBuffer += F(" boot");
 
+   html_TR_TD(); TXBuffer += F("Settings Saved<TD>");
+   TXBuffer += flashWriteStats.saves;
+   TXBuffer += F(" (");
+   TXBuffer += flashWriteStats.unchanged;
+   TXBuffer += F(" unchanged) / ");
+   TXBuffer += flashWriteStats.lastWritten;
+   TXBuffer += F(" bytes last / ");
+   TXBuffer += flashWriteStats.totalWritten;
+   TXBuffer += F(" bytes boot");
+
    html_TR_TD(); TXBuffer += F("Sketch Size<TD>");
   #if defined(ESP8266)
    TXBuffer += ESP.getSketchSize() / 1024;
@@ -5365,6 +6610,8 @@ void handle_sysinfo() {
     TXBuffer += F("(offset / size per item / index)");
 
     for (int st = 0; st < SettingsType_MAX; ++st) {
+      if (TXBuffer.isAborted())
+        break;
       SettingsType settingsType = static_cast<SettingsType>(st);
       html_TR_TD();
       TXBuffer += getSettingsTypeString(settingsType);
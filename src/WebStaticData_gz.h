@@ -0,0 +1,155 @@
+#ifndef WEBSTATICDATA_GZ_h
+#define WEBSTATICDATA_GZ_h
+
+// Generated using gzip_static_data.py from WebStaticData.h, do not edit.
+
+// pgDefaultCSS: 6470 bytes, gzip 1702 bytes
+#define pgDefaultCSS_gz_source_len 6470
+#define pgDefaultCSS_gz_source_hash 0x0c90953fUL
+static const char pgDefaultCSS_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xd5, 0x58,
+  0x59, 0x6f, 0xdb, 0x38, 0x10, 0x7e, 0xce, 0xbf, 0x20, 0x10, 0x14, 0x69,
+  0x17, 0x96, 0x20, 0xcb, 0x47, 0x7c, 0xbc, 0xb4, 0x9b, 0xc4, 0x4f, 0xbb,
+  0xbf, 0xa1, 0xa0, 0x24, 0xca, 0x22, 0x2c, 0x89, 0x02, 0x45, 0x1f, 0xa9,
+  0xe1, 0xfd, 0xed, 0x3b, 0x24, 0x75, 0x90, 0x3a, 0xda, 0xf4, 0x5a, 0x60,
+  0x61, 0xa4, 0x95, 0x38, 0xd4, 0xdc, 0xdf, 0x70, 0x86, 0x7f, 0xa0, 0x6b,
+  0xcc, 0x72, 0xe1, 0xc4, 0x38, 0xa3, 0xe9, 0xeb, 0x06, 0x95, 0x38, 0x2f,
+  0x9d, 0x92, 0x70, 0x1a, 0x6f, 0x91, 0x22, 0x94, 0xf4, 0x0b, 0xd9, 0xa0,
+  0xa9, 0x5f, 0x88, 0x2d, 0xca, 0x30, 0xdf, 0xd3, 0x7c, 0x83, 0xbc, 0xe2,
+  0xb2, 0x45, 0x05, 0x8e, 0x22, 0x9a, 0xef, 0xab, 0xb7, 0x80, 0x5d, 0xe4,
+  0x56, 0xb5, 0x10, 0x30, 0x1e, 0x11, 0xee, 0xc0, 0xd2, 0x16, 0xdd, 0x92,
+  0x69, 0x25, 0xa1, 0x62, 0xb4, 0x94, 0x8c, 0x42, 0x96, 0x32, 0xbe, 0x41,
+  0xf7, 0xde, 0xe3, 0x73, 0xcb, 0x75, 0x55, 0x5c, 0x90, 0x57, 0x49, 0x3d,
+  0x13, 0xba, 0x4f, 0x84, 0x64, 0x95, 0x46, 0x92, 0x89, 0x6f, 0x33, 0xb1,
+  0xb5, 0x41, 0xce, 0xdc, 0x52, 0x68, 0xa9, 0x14, 0xc2, 0xe1, 0x61, 0xcf,
+  0xd9, 0x31, 0x8f, 0x9c, 0x5a, 0xda, 0x7c, 0x3e, 0x6f, 0x45, 0xef, 0x76,
+  0xbb, 0x11, 0x59, 0xb3, 0xaf, 0xc8, 0x02, 0xf5, 0x2f, 0x4a, 0x5c, 0x5f,
+  0xea, 0x7c, 0x44, 0xea, 0xcb, 0xcb, 0x4b, 0x2b, 0x55, 0xa9, 0x30, 0x28,
+  0x75, 0x69, 0x4b, 0xf5, 0x7a, 0x6e, 0xba, 0x15, 0x9c, 0x4c, 0xd0, 0x25,
+  0x2b, 0x26, 0xb0, 0x1e, 0xc1, 0xe3, 0x21, 0x88, 0x26, 0x10, 0x2f, 0xb9,
+  0x20, 0xc4, 0x15, 0x99, 0x61, 0xcc, 0x58, 0xce, 0xca, 0x02, 0x87, 0x64,
+  0xd2, 0x3c, 0x99, 0xe1, 0x9c, 0x92, 0x0c, 0xf8, 0xb9, 0xc1, 0x51, 0x08,
+  0x96, 0xa3, 0x6b, 0x6d, 0x5c, 0xcf, 0x1e, 0x65, 0xee, 0xa0, 0x51, 0x4a,
+  0x23, 0xcb, 0x95, 0x82, 0x5c, 0x84, 0x13, 0x91, 0x90, 0x71, 0x2c, 0x28,
+  0x03, 0x6e, 0x39, 0xcb, 0xc9, 0xb6, 0xce, 0x05, 0x8e, 0x23, 0x7a, 0x2c,
+  0x6b, 0x27, 0xa9, 0xb5, 0x6a, 0x47, 0xad, 0x86, 0x9b, 0xd2, 0xfc, 0x80,
+  0xae, 0xc8, 0x7a, 0x77, 0xcf, 0x34, 0x22, 0xe8, 0x1a, 0xd1, 0xb2, 0x48,
+  0x31, 0x64, 0x27, 0xcd, 0x61, 0x95, 0x38, 0x41, 0xca, 0xc2, 0xc3, 0x16,
+  0x01, 0x51, 0x24, 0xd2, 0x57, 0xde, 0xbb, 0x4a, 0x3e, 0x4e, 0xe9, 0x1e,
+  0x44, 0x87, 0x24, 0x17, 0x84, 0xdb, 0xac, 0x5d, 0x4e, 0x22, 0x74, 0xed,
+  0x9b, 0x02, 0xcb, 0xed, 0xc6, 0x84, 0xa4, 0x05, 0xba, 0x36, 0x2e, 0xf0,
+  0xc1, 0x05, 0x86, 0xc6, 0x4e, 0x29, 0x5e, 0x53, 0x08, 0x4e, 0xc9, 0x52,
+  0x1a, 0x35, 0x8b, 0xb5, 0x16, 0xc6, 0xbe, 0x8a, 0xf5, 0x9e, 0xe3, 0xd7,
+  0x9e, 0x07, 0x16, 0x52, 0xd9, 0x5a, 0xe0, 0x26, 0x61, 0x27, 0xc2, 0x4d,
+  0xb5, 0xc0, 0x9d, 0xb3, 0xe5, 0x1a, 0x76, 0xd0, 0xbc, 0x38, 0x0a, 0x88,
+  0x2f, 0x49, 0x49, 0x08, 0xff, 0x4b, 0xf3, 0x30, 0x27, 0xf8, 0x6b, 0xd1,
+  0x5a, 0x19, 0x2a, 0xd8, 0x0e, 0xef, 0x07, 0x90, 0x10, 0xf2, 0x53, 0x66,
+  0x69, 0xfd, 0xfa, 0xfa, 0x37, 0x02, 0xc2, 0x30, 0xac, 0xad, 0xa8, 0xa2,
+  0x98, 0xe1, 0x4b, 0xcd, 0x75, 0xe1, 0xa9, 0xa2, 0xa1, 0xdf, 0x56, 0xca,
+  0x23, 0xed, 0xce, 0xfc, 0x98, 0x05, 0x92, 0xe9, 0xd8, 0xfe, 0xa9, 0x7e,
+  0xb9, 0xdd, 0x6b, 0xdf, 0xa8, 0xc5, 0x6f, 0x70, 0xef, 0xb9, 0xe9, 0xa6,
+  0xbf, 0xfd, 0xa6, 0xfe, 0x6e, 0x08, 0xa0, 0xc1, 0x90, 0x73, 0xdc, 0xc8,
+  0xc2, 0x2a, 0xfd, 0x2a, 0xa6, 0x4e, 0x4a, 0x62, 0xc0, 0xf1, 0x6c, 0x21,
+  0x65, 0xea, 0xe0, 0x54, 0x4b, 0x73, 0x63, 0x45, 0xb0, 0xa2, 0xae, 0x9b,
+  0xac, 0xa4, 0x1a, 0x21, 0x9c, 0xa4, 0x80, 0x95, 0x13, 0x04, 0x22, 0x3c,
+  0xf2, 0x52, 0x4a, 0x2d, 0x18, 0x55, 0x99, 0xdb, 0x2f, 0xbd, 0x50, 0x2f,
+  0x82, 0x03, 0x15, 0xce, 0xb1, 0x94, 0x01, 0xd3, 0xca, 0x57, 0x10, 0x73,
+  0x32, 0xf6, 0x65, 0x78, 0xbd, 0x1c, 0x5a, 0x1e, 0x58, 0x32, 0xcd, 0x54,
+  0x71, 0x00, 0x0c, 0x34, 0x5a, 0xe2, 0x00, 0x12, 0xe3, 0x28, 0x60, 0x1b,
+  0x83, 0x3a, 0x42, 0x05, 0x38, 0xc0, 0x1b, 0xd0, 0x58, 0x32, 0x49, 0x48,
+  0x78, 0x00, 0x7b, 0x0f, 0xc3, 0x9f, 0x6b, 0x17, 0x6c, 0x91, 0x76, 0x0e,
+  0x3c, 0x24, 0x55, 0x09, 0xf4, 0x95, 0xeb, 0x6a, 0x38, 0x57, 0x6f, 0xbf,
+  0x21, 0x67, 0xd1, 0x10, 0x38, 0x0c, 0xdb, 0xab, 0x6c, 0xd0, 0x1e, 0xf8,
+  0x07, 0x99, 0xf6, 0xbc, 0x25, 0x41, 0x34, 0x22, 0xd4, 0x47, 0x50, 0x6a,
+  0xec, 0xef, 0x47, 0x6b, 0xa8, 0xe1, 0xb5, 0x0d, 0x8e, 0x85, 0xcc, 0x33,
+  0xc9, 0x11, 0x0a, 0xd8, 0x06, 0x3d, 0x3c, 0x98, 0xd9, 0xd2, 0x3a, 0xb2,
+  0x49, 0xc4, 0x91, 0xe8, 0x0d, 0xea, 0x50, 0x73, 0xef, 0x66, 0xb1, 0xf9,
+  0x75, 0x7f, 0xb7, 0x8e, 0xd5, 0xa3, 0x74, 0xa8, 0x0a, 0xdf, 0xac, 0x05,
+  0x16, 0x52, 0x71, 0xaa, 0x63, 0x38, 0xf5, 0xcc, 0xca, 0xae, 0xc2, 0x82,
+  0xce, 0x09, 0x15, 0xa4, 0x1b, 0x1c, 0x4f, 0xf2, 0x50, 0x7f, 0x5e, 0x9b,
+  0xd5, 0x82, 0x43, 0xdb, 0x11, 0x33, 0x9e, 0x01, 0x28, 0x98, 0xc0, 0x82,
+  0xbc, 0x9f, 0x2f, 0x22, 0xb2, 0xff, 0xa0, 0x93, 0x78, 0x9c, 0x3a, 0x4e,
+  0x31, 0xcc, 0xf2, 0x7f, 0x00, 0xba, 0x6b, 0x63, 0x25, 0x60, 0x50, 0xaa,
+  0x41, 0x82, 0xff, 0x3f, 0x80, 0xaf, 0xff, 0x33, 0xf8, 0x8d, 0x98, 0xf8,
+  0x11, 0xf4, 0x2e, 0x2d, 0xf4, 0x2e, 0x7f, 0x1b, 0x7a, 0x07, 0x0e, 0x52,
+  0xd3, 0xf2, 0x2e, 0x7a, 0x1b, 0x6b, 0xde, 0x80, 0x5d, 0xbf, 0x0f, 0x9c,
+  0xe6, 0xf3, 0x31, 0xe8, 0x36, 0xfe, 0xfa, 0x05, 0xb8, 0x1d, 0x97, 0xff,
+  0x06, 0xd8, 0xfa, 0xbd, 0xcd, 0x2a, 0x56, 0xaa, 0x1b, 0xd0, 0xd1, 0x5a,
+  0x19, 0xa8, 0x5d, 0x99, 0xa8, 0x95, 0x2f, 0x77, 0x03, 0x7e, 0xbd, 0x33,
+  0x1b, 0x92, 0x0a, 0xc6, 0xb7, 0x7b, 0xc1, 0x70, 0x29, 0x32, 0x52, 0x96,
+  0x78, 0x0f, 0xc7, 0xf9, 0x89, 0x96, 0x34, 0xa0, 0xa9, 0x4a, 0xa8, 0x84,
+  0x46, 0x70, 0x6e, 0x03, 0x62, 0x00, 0x2e, 0x4d, 0x19, 0xf7, 0x7a, 0xa8,
+  0x72, 0xa6, 0xba, 0xb8, 0x8f, 0x78, 0xb4, 0x7e, 0x8e, 0x63, 0x18, 0x3e,
+  0x86, 0x1a, 0xba, 0xc1, 0x02, 0x8e, 0xda, 0xd3, 0x5d, 0xb7, 0xab, 0x86,
+  0xef, 0x63, 0x7a, 0x81, 0xf6, 0xee, 0x8b, 0x43, 0xf3, 0x88, 0x5c, 0x80,
+  0x5e, 0x3b, 0xc4, 0x5f, 0xf9, 0x3a, 0xcb, 0x34, 0xb2, 0x67, 0xb2, 0x47,
+  0xb0, 0x40, 0xfb, 0xa8, 0xb3, 0xf8, 0x27, 0xfa, 0x23, 0xcb, 0x5b, 0x6e,
+  0x99, 0xb0, 0xb3, 0xed, 0x32, 0xf5, 0x9c, 0x92, 0xb6, 0x34, 0xe0, 0x9c,
+  0x66, 0x55, 0xeb, 0x1c, 0xe3, 0x88, 0xd0, 0x1c, 0x79, 0xee, 0xa2, 0x9c,
+  0xa8, 0x17, 0x06, 0x29, 0x2d, 0xdf, 0x90, 0x0f, 0xff, 0x6c, 0xd1, 0x77,
+  0x6c, 0xbd, 0x7d, 0xac, 0xf9, 0x1f, 0xc8, 0x6b, 0xcc, 0x31, 0x28, 0x54,
+  0x7f, 0x73, 0x8d, 0x39, 0xcb, 0x00, 0x1e, 0x4d, 0x79, 0x7b, 0x67, 0x95,
+  0x88, 0x1b, 0x40, 0xbe, 0xa5, 0xce, 0x6c, 0xaa, 0xbb, 0x06, 0xfa, 0xed,
+  0xe3, 0xef, 0xe0, 0x39, 0xac, 0xaf, 0x34, 0xab, 0xc3, 0x7c, 0xe8, 0x73,
+  0x93, 0xbd, 0xd7, 0x11, 0xdd, 0x55, 0xf7, 0x57, 0xb0, 0x74, 0x53, 0x72,
+  0x22, 0xe9, 0x67, 0x0f, 0xca, 0x44, 0x33, 0x0d, 0x4d, 0xe5, 0x6f, 0xdb,
+  0xd0, 0xa6, 0x26, 0xed, 0x69, 0xb7, 0x5b, 0x2f, 0x5a, 0x9a, 0x6f, 0xd0,
+  0xd6, 0xcf, 0x4f, 0x2f, 0xbb, 0x97, 0x96, 0x36, 0x33, 0x68, 0x9f, 0xe6,
+  0xbb, 0xa7, 0xc7, 0x75, 0x4b, 0x9b, 0x9b, 0x3c, 0xfd, 0x4f, 0x7f, 0xce,
+  0x0c, 0xda, 0xda, 0xa4, 0xed, 0x16, 0xd0, 0x0c, 0x2b, 0x1a, 0xdb, 0x9f,
+  0x28, 0x39, 0xcb, 0xea, 0x70, 0xd7, 0xd5, 0x74, 0x00, 0x8e, 0xfe, 0xa3,
+  0xfc, 0x6d, 0xd1, 0x9d, 0x75, 0x39, 0xf0, 0xf0, 0xd7, 0x31, 0xa4, 0x11,
+  0x46, 0x4f, 0x2c, 0x07, 0x30, 0x90, 0x87, 0x09, 0xfa, 0x9b, 0xe5, 0x38,
+  0x64, 0x13, 0x64, 0x8c, 0x99, 0x4d, 0x71, 0x41, 0x8b, 0x59, 0x55, 0x02,
+  0x9a, 0xce, 0x1c, 0x5a, 0x77, 0xcf, 0xac, 0x45, 0x83, 0xbd, 0x39, 0x42,
+  0xb2, 0x90, 0xc7, 0x29, 0x3b, 0x43, 0xf1, 0x3c, 0x0a, 0x06, 0x0b, 0x5f,
+  0x45, 0xa2, 0x75, 0x48, 0xdc, 0xcc, 0x41, 0x69, 0x44, 0xee, 0x88, 0xd8,
+  0xef, 0x37, 0xb5, 0x11, 0xf6, 0xcd, 0x39, 0x42, 0x60, 0xc0, 0xba, 0x9b,
+  0x43, 0xa7, 0x82, 0x53, 0x24, 0xc7, 0x95, 0x1f, 0xb8, 0xac, 0xb0, 0xcd,
+  0xbd, 0x5f, 0xad, 0x56, 0xc3, 0x57, 0x09, 0xb6, 0xac, 0xc8, 0x90, 0x35,
+  0x37, 0x6b, 0xbf, 0x0a, 0x4e, 0x67, 0x33, 0xef, 0x6e, 0xb6, 0xe9, 0xd7,
+  0xa6, 0x5a, 0xcb, 0xa4, 0xb2, 0xc6, 0x6f, 0xa3, 0xf2, 0xcf, 0x7d, 0xcf,
+  0x2e, 0x8a, 0x29, 0x2e, 0x4a, 0x88, 0x5a, 0xfd, 0xd4, 0x70, 0xcd, 0x8e,
+  0xa9, 0xa0, 0x1c, 0x0a, 0xe3, 0x7f, 0xe2, 0x90, 0x56, 0x5a, 0xcf, 0x25,
+  0x83, 0x47, 0xcd, 0x90, 0x9f, 0x5a, 0x1e, 0x63, 0x9e, 0x32, 0x76, 0x6c,
+  0x72, 0x91, 0x38, 0x61, 0x42, 0xd3, 0xe8, 0x3d, 0x00, 0x33, 0xff, 0x30,
+  0x94, 0x1d, 0xcf, 0x2f, 0x2f, 0x4b, 0x69, 0x4a, 0xf7, 0xeb, 0x5f, 0xe6,
+  0x69, 0x08, 0x9d, 0x20, 0x2d, 0xbb, 0xf6, 0xfe, 0xa9, 0x82, 0x12, 0x15,
+  0x60, 0xb7, 0x6a, 0x86, 0x12, 0x02, 0x35, 0x91, 0x67, 0x30, 0x7e, 0x9b,
+  0x0d, 0xa0, 0x3e, 0x41, 0xfb, 0xdd, 0x1f, 0xd7, 0xce, 0x31, 0xfa, 0xc0,
+  0xb5, 0x7d, 0x2b, 0x28, 0x6f, 0xf3, 0xa6, 0xfe, 0x48, 0x2c, 0x77, 0x2b,
+  0xf9, 0xdb, 0xb6, 0x37, 0x85, 0xba, 0xbc, 0xc2, 0x61, 0x5a, 0x8d, 0x0e,
+  0xf7, 0xcf, 0xcf, 0x30, 0x1c, 0x19, 0x07, 0xf7, 0xcd, 0xc5, 0x85, 0xd6,
+  0xd0, 0x70, 0xfc, 0x5b, 0x64, 0xdc, 0xdc, 0x80, 0x45, 0xaf, 0xda, 0x2c,
+  0x73, 0x16, 0x5f, 0x2f, 0xd5, 0xf0, 0x27, 0x09, 0x01, 0xe6, 0xa6, 0xc9,
+  0x34, 0x4f, 0x08, 0xa7, 0xa2, 0x32, 0x7a, 0xa1, 0x3a, 0x16, 0xbd, 0x11,
+  0x8e, 0x8b, 0x94, 0x61, 0xb0, 0x55, 0xba, 0x61, 0xe0, 0xaa, 0x4c, 0x2b,
+  0xa4, 0x12, 0xd8, 0x72, 0xb8, 0xea, 0xa0, 0x1c, 0x55, 0x34, 0x64, 0xf3,
+  0x77, 0xe6, 0xb8, 0xe8, 0xce, 0x4a, 0x6a, 0x92, 0x29, 0xa0, 0x96, 0xe4,
+  0xa2, 0xdb, 0x62, 0x28, 0xee, 0xfa, 0x6f, 0xe8, 0x7a, 0x07, 0xe9, 0xdb,
+  0x48, 0x6f, 0xf4, 0x0a, 0x4e, 0xeb, 0xee, 0xe2, 0x50, 0x0e, 0x2b, 0x9d,
+  0xcc, 0x1a, 0xf2, 0xdb, 0x00, 0xb4, 0xa0, 0x3b, 0x53, 0x21, 0xa9, 0xa8,
+  0x9a, 0x63, 0x5d, 0xf4, 0x46, 0x18, 0xaa, 0xec, 0x6e, 0x36, 0x7f, 0xae,
+  0x2f, 0x1b, 0xed, 0x26, 0xf8, 0xe6, 0xca, 0xb5, 0xa6, 0x82, 0x13, 0xd9,
+  0x44, 0xc2, 0x5a, 0x1c, 0x37, 0x8b, 0xf2, 0x7e, 0x4e, 0xce, 0x26, 0xf4,
+  0xf4, 0x39, 0xed, 0xf8, 0x5f, 0xaf, 0xf2, 0x66, 0x55, 0xe5, 0x64, 0x7b,
+  0x57, 0xeb, 0x5b, 0xf9, 0xa8, 0x3c, 0xe8, 0x7d, 0xc7, 0x0d, 0x99, 0xb7,
+  0xf2, 0x9a, 0x30, 0xd6, 0x2d, 0xb0, 0x12, 0x18, 0x48, 0x9b, 0x53, 0x82,
+  0xb9, 0x2c, 0x30, 0x22, 0x91, 0xcb, 0x38, 0x25, 0x5c, 0x98, 0x17, 0x87,
+  0xde, 0x08, 0xd3, 0x78, 0x3e, 0x9f, 0xcd, 0x96, 0x5d, 0xbe, 0x9d, 0x41,
+  0x73, 0x5a, 0xa5, 0xdc, 0x19, 0xf3, 0x1c, 0xd8, 0xbd, 0x89, 0x6f, 0x1c,
+  0xe2, 0xe9, 0xe3, 0x1b, 0xf9, 0x86, 0x29, 0x2b, 0x49, 0x20, 0x9a, 0x9b,
+  0xdf, 0xaa, 0x3b, 0xd7, 0x64, 0x9b, 0xc3, 0x40, 0x39, 0xb5, 0x9d, 0x6d,
+  0x34, 0xcd, 0xbe, 0x72, 0xb8, 0xba, 0xa0, 0x6d, 0x66, 0x43, 0xa5, 0x6f,
+  0x6f, 0xd6, 0x54, 0xc9, 0x5e, 0xa1, 0xcd, 0x73, 0x67, 0xa5, 0xa9, 0x54,
+  0x27, 0xab, 0x82, 0x14, 0xab, 0x71, 0xa7, 0x84, 0x79, 0x17, 0xf6, 0x5f,
+  0xeb, 0xd6, 0xc0, 0xb9, 0xd4, 0xcd, 0x81, 0x55, 0x1c, 0x6f, 0x1f, 0x33,
+  0x12, 0x51, 0x8c, 0xca, 0x50, 0xe6, 0x12, 0x34, 0xca, 0x11, 0x7a, 0x6f,
+  0xf4, 0x01, 0xeb, 0x25, 0x28, 0xf4, 0x01, 0x5d, 0x01, 0x69, 0xb9, 0xea,
+  0xc9, 0x65, 0x6a, 0xa6, 0x38, 0x20, 0x90, 0x5a, 0xfd, 0xf1, 0x4c, 0x43,
+  0xde, 0xea, 0x5f, 0xa6, 0xa7, 0xb3, 0xd5, 0xd0, 0xcc, 0x55, 0xe7, 0x70,
+  0xfb, 0x17, 0xee, 0x4a, 0xe4, 0xf9, 0x46, 0x19, 0x00, 0x00,
+};
+const unsigned int pgDefaultCSS_gz_len = 1702;
+
+#endif // WEBSTATICDATA_GZ_h
@@ -39,8 +39,7 @@ boolean CPlugin_001(byte function, struct EventStruct *event, String& string)
             success = false;
             break;
           }
-          ControllerSettingsStruct ControllerSettings;
-          LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof (ControllerSettings));
+          ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
           String authHeader = "";
           if ((SecuritySettings.ControllerUser[event->ControllerIndex][0] != 0) && (SecuritySettings.ControllerPassword[event->ControllerIndex][0] != 0))
@@ -81,7 +80,7 @@ boolean CPlugin_001(byte function, struct EventStruct *event, String& string)
               url = F("/json.htm?type=command&param=switchlight&idx=");
               url += event->idx;
               url += F("&switchcmd=");
-              if (UserVar[event->BaseVarIndex] == 0)
+              if (getEventValues(event)[0] == 0)
                 url += F("Off");
               else
                 url += F("On");
@@ -90,11 +89,11 @@ boolean CPlugin_001(byte function, struct EventStruct *event, String& string)
               url = F("/json.htm?type=command&param=switchlight&idx=");
               url += event->idx;
               url += F("&switchcmd=");
-              if (UserVar[event->BaseVarIndex] == 0) {
+              if (getEventValues(event)[0] == 0) {
                 url += ("Off");
               } else {
                 url += F("Set%20Level&level=");
-                url += UserVar[event->BaseVarIndex];
+                url += getEventValues(event)[0];
               }
               break;
 
@@ -161,6 +160,8 @@ boolean CPlugin_001(byte function, struct EventStruct *event, String& string)
         else
         {
           addLog(LOG_LEVEL_ERROR, F("HTTP : IDX cannot be zero!"));
+          // Not sent to Domoticz on purpose, nothing to retry.
+          success = true;
         }
         break;
       }
@@ -137,8 +137,7 @@ boolean CPlugin_002(byte function, struct EventStruct *event, String& string)
       {
         if (event->idx != 0)
         {
-          ControllerSettingsStruct ControllerSettings;
-          LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+          ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
           if (!ControllerSettings.checkHostReachable(true)) {
             success = false;
             break;
@@ -156,17 +155,17 @@ boolean CPlugin_002(byte function, struct EventStruct *event, String& string)
           {
             case SENSOR_TYPE_SWITCH:
               root[F("command")] = String(F("switchlight"));
-              if (UserVar[event->BaseVarIndex] == 0)
+              if (getEventValues(event)[0] == 0)
                 root[F("switchcmd")] = String(F("Off"));
               else
                 root[F("switchcmd")] = String(F("On"));
               break;
             case SENSOR_TYPE_DIMMER:
               root[F("command")] = String(F("switchlight"));
-              if (UserVar[event->BaseVarIndex] == 0)
+              if (getEventValues(event)[0] == 0)
                 root[F("switchcmd")] = String(F("Off"));
               else
-                root[F("Set%20Level")] = UserVar[event->BaseVarIndex];
+                root[F("Set%20Level")] = getEventValues(event)[0];
               break;
 
             case SENSOR_TYPE_SINGLE:
@@ -185,15 +184,22 @@ boolean CPlugin_002(byte function, struct EventStruct *event, String& string)
               break;
           }
 
-          String json;
-          root.printTo(json);
-          String log = F("MQTT : ");
-          log += json;
-          addLog(LOG_LEVEL_DEBUG, log);
+          if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+            String log = F("MQTT : ");
+            root.printTo(log);
+            addLog(LOG_LEVEL_DEBUG, log);
+          }
 
-          String pubname = ControllerSettings.Publish;
-          parseControllerVariables(pubname, event, false);
-          if (!MQTTpublish(event->ControllerIndex, pubname.c_str(), json.c_str(), Settings.MQTTRetainFlag))
+          // The JSON is printed straight into the MQTT packet buffer.
+          String topic;
+          const String& pubname = getMQTTTopic(event, 0, topic);
+          bool published = false;
+          if (MQTTbeginPublish(pubname.c_str(), Settings.MQTTRetainFlag)) {
+            root.printTo(MQTTclient);
+            published = MQTTendPublish();
+          }
+          success = published;
+          if (!published)
           {
             connectionFailures++;
           }
@@ -205,6 +211,8 @@ boolean CPlugin_002(byte function, struct EventStruct *event, String& string)
         {
           String log = F("MQTT : IDX cannot be zero!");
           addLog(LOG_LEVEL_ERROR, log);
+          // Not sent to Domoticz on purpose, nothing to retry.
+          success = true;
         }
         break;
       }
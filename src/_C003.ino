@@ -32,10 +32,9 @@ boolean CPlugin_003(byte function, struct EventStruct *event, String& string)
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-        ControllerSettingsStruct ControllerSettings;
-        LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+        ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
-        boolean success = false;
+        boolean passwordRequest = false;
         char log[80];
         addLog(LOG_LEVEL_DEBUG, String(F("TELNT : connecting to ")) + ControllerSettings.getHostPortString());
         // Use WiFiClient class to create TCP connections
@@ -67,7 +66,7 @@ boolean CPlugin_003(byte function, struct EventStruct *event, String& string)
           delay(1);
 
         timer = millis() + 1000;
-        while (client.available() && !timeOutReached(timer) && !success)
+        while (client.available() && !timeOutReached(timer) && !passwordRequest)
         {
 
           //   String line = client.readStringUntil('\n');
@@ -76,7 +75,7 @@ boolean CPlugin_003(byte function, struct EventStruct *event, String& string)
 
           if (line.startsWith(F("Enter your password:")))
           {
-            success = true;
+            passwordRequest = true;
             strcpy_P(log, PSTR("TELNT: Password request ok"));
             addLog(LOG_LEVEL_DEBUG, log);
           }
@@ -92,7 +91,7 @@ boolean CPlugin_003(byte function, struct EventStruct *event, String& string)
 
         strcpy_P(log, PSTR("TELNT: Sending cmd"));
         addLog(LOG_LEVEL_DEBUG, log);
-        client.print(url);
+        success = client.print(url) == url.length();
         delay(10);
         while (client.available())
           client.read();
@@ -7,6 +7,8 @@
 #define CPLUGIN_ID_004         4
 #define CPLUGIN_NAME_004       "ThingSpeak"
 
+String C004_batch; // Fields collected for the next update
+
 boolean CPlugin_004(byte function, struct EventStruct *event, String& string)
 {
   boolean success = false;
@@ -21,6 +23,7 @@ boolean CPlugin_004(byte function, struct EventStruct *event, String& string)
         Protocol[protocolCount].usesPassword = true;
         Protocol[protocolCount].defaultPort = 80;
         Protocol[protocolCount].usesID = true;
+        Protocol[protocolCount].usesBatchSend = true;
         break;
       }
 
@@ -44,12 +47,29 @@ boolean CPlugin_004(byte function, struct EventStruct *event, String& string)
             success = false;
             break;
         }
+        break;
       }
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-        ControllerSettingsStruct ControllerSettings;
-        LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+        // Collect the values, all tasks are sent in one update on CPLUGIN_FLUSH.
+        byte valueCount = getValueCountFromSensorType(event->sensorType);
+        for (byte x = 0; x < valueCount; x++)
+        {
+          C004_batch += F("&field");
+          C004_batch += event->idx + x;
+          C004_batch += "=";
+          C004_batch += formatUserVarNoCheck(event, x);
+        }
+        success = true;
+        break;
+      }
+
+    case CPLUGIN_FLUSH:
+      {
+        if (C004_batch.length() == 0)
+          break;
+        ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
         // boolean success = false;
         addLog(LOG_LEVEL_DEBUG, String(F("HTTP : connecting to "))+ControllerSettings.getHostPortString());
@@ -58,6 +78,7 @@ boolean CPlugin_004(byte function, struct EventStruct *event, String& string)
         WiFiClient client;
         if (!ControllerSettings.connectToHost(client))
         {
+          C004_batch = "";
           connectionFailures++;
           if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
             strcpy_P(log, PSTR("HTTP : connection failed"));
@@ -71,15 +92,9 @@ boolean CPlugin_004(byte function, struct EventStruct *event, String& string)
 
         String postDataStr = F("api_key=");
         postDataStr += SecuritySettings.ControllerPassword[event->ControllerIndex]; // used for API key
+        postDataStr += C004_batch;
+        C004_batch = "";
 
-        byte valueCount = getValueCountFromSensorType(event->sensorType);
-        for (byte x = 0; x < valueCount; x++)
-        {
-          postDataStr += F("&field");
-          postDataStr += event->idx + x;
-          postDataStr += "=";
-          postDataStr += formatUserVarNoCheck(event, x);
-        }
         String hostName = F("api.thingspeak.com"); // PM_CZ: HTTP requests must contain host headers.
         if (ControllerSettings.UseDNS)
           hostName = ControllerSettings.HostName;
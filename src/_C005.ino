@@ -84,8 +84,7 @@ boolean CPlugin_005(byte function, struct EventStruct *event, String& string)
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-        ControllerSettingsStruct ControllerSettings;
-        LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+        ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
         if (!ControllerSettings.checkHostReachable(true)) {
             success = false;
             break;
@@ -95,24 +94,24 @@ boolean CPlugin_005(byte function, struct EventStruct *event, String& string)
         if (ExtraTaskSettings.TaskDeviceValueNames[0][0] == 0)
           PluginCall(PLUGIN_GET_DEVICEVALUENAMES, event, dummyString);
 
-        String pubname = ControllerSettings.Publish;
-        parseControllerVariables(pubname, event, false);
-
-        String value = "";
-        // byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[event->TaskIndex]);
+        // Topics are kept per task and the value is formatted in a buffer, a publish allocates no String.
+        String topic;
+        char value[FORMAT_VALUE_BUFFER_SIZE];
         byte valueCount = getValueCountFromSensorType(event->sensorType);
+        success = true;
         for (byte x = 0; x < valueCount; x++)
         {
-          String tmppubname = pubname;
-          tmppubname.replace(F("%valname%"), ExtraTaskSettings.TaskDeviceValueNames[x]);
-          value = formatUserVarNoCheck(event, x);
-
-          MQTTpublish(event->ControllerIndex, tmppubname.c_str(), value.c_str(), Settings.MQTTRetainFlag);
-          String log = F("MQTT : ");
-          log += tmppubname;
-          log += " ";
-          log += value;
-          addLog(LOG_LEVEL_DEBUG, log);
+          const String& pubname = getMQTTTopic(event, x, topic);
+          formatUserVarNoCheck(event, x, value);
+          if (!MQTTpublish(event->ControllerIndex, pubname.c_str(), value, Settings.MQTTRetainFlag))
+            success = false;
+          if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+            String log = F("MQTT : ");
+            log += pubname;
+            log += ' ';
+            log += value;
+            addLog(LOG_LEVEL_DEBUG, log);
+          }
         }
         break;
       }
@@ -82,26 +82,22 @@ boolean CPlugin_006(byte function, struct EventStruct *event, String& string)
           success = false;
           break;
         }
-        ControllerSettingsStruct ControllerSettings;
-        LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
-
         statusLED(true);
 
         if (ExtraTaskSettings.TaskDeviceValueNames[0][0] == 0)
           PluginCall(PLUGIN_GET_DEVICEVALUENAMES, event, dummyString);
 
-        String pubname = ControllerSettings.Publish;
-        parseControllerVariables(pubname, event, false);
-
-        String value = "";
-        // byte DeviceIndex = getDeviceIndex(Settings.TaskDeviceNumber[event->TaskIndex]);
+        // Topics are kept per task and the value is formatted in a buffer, a publish allocates no String.
+        String topic;
+        char value[FORMAT_VALUE_BUFFER_SIZE];
         byte valueCount = getValueCountFromSensorType(event->sensorType);
+        success = true;
         for (byte x = 0; x < valueCount; x++)
         {
-          String tmppubname = pubname;
-          tmppubname.replace(F("%valname%"), ExtraTaskSettings.TaskDeviceValueNames[x]);
-          value = formatUserVarNoCheck(event, x);
-          MQTTpublish(event->ControllerIndex, tmppubname.c_str(), value.c_str(), Settings.MQTTRetainFlag);
+          const String& pubname = getMQTTTopic(event, x, topic);
+          formatUserVarNoCheck(event, x, value);
+          if (!MQTTpublish(event->ControllerIndex, pubname.c_str(), value, Settings.MQTTRetainFlag))
+            success = false;
         }
         break;
       }
@@ -7,6 +7,8 @@
 #define CPLUGIN_ID_007         7
 #define CPLUGIN_NAME_007       "Emoncms"
 
+String C007_batch; // JSON fields collected for the next post
+
 boolean CPlugin_007(byte function, struct EventStruct *event, String& string)
 {
   boolean success = false;
@@ -21,6 +23,7 @@ boolean CPlugin_007(byte function, struct EventStruct *event, String& string)
         Protocol[protocolCount].usesPassword = true;
         Protocol[protocolCount].defaultPort = 80;
         Protocol[protocolCount].usesID = true;
+        Protocol[protocolCount].usesBatchSend = true;
         break;
       }
 
@@ -32,18 +35,34 @@ boolean CPlugin_007(byte function, struct EventStruct *event, String& string)
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-        if (!WiFiConnected(100)) {
-          success = false;
-          break;
-        }
+        // Collect the values, all tasks are posted in one request on CPLUGIN_FLUSH.
         const byte valueCount = getValueCountFromSensorType(event->sensorType);
         if (valueCount == 0 || valueCount > 3) {
           addLog(LOG_LEVEL_ERROR, F("emoncms : Unknown sensortype or too many sensor values"));
           break;
         }
+        for (byte i = 0; i < valueCount; ++i) {
+          C007_batch += (C007_batch.length() == 0) ? F("{") : F(",");
+          C007_batch += F("field");
+          C007_batch += event->idx + i;
+          C007_batch += ":";
+          C007_batch += formatUserVarNoCheck(event, i);
+        }
+        success = true;
+        break;
+      }
+
+    case CPLUGIN_FLUSH:
+      {
+        if (C007_batch.length() == 0)
+          break;
+        if (!WiFiConnected(100)) {
+          C007_batch = "";
+          success = false;
+          break;
+        }
 
-        ControllerSettingsStruct ControllerSettings;
-        LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+        ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
         // boolean success = false;
         addLog(LOG_LEVEL_DEBUG, String(F("HTTP : connecting to "))+ControllerSettings.getHostPortString());
@@ -52,6 +71,7 @@ boolean CPlugin_007(byte function, struct EventStruct *event, String& string)
         WiFiClient client;
         if (!ControllerSettings.connectToHost(client))
         {
+          C007_batch = "";
           connectionFailures++;
           strcpy_P(log, PSTR("HTTP : connection failed"));
           addLog(LOG_LEVEL_ERROR, log);
@@ -66,14 +86,9 @@ boolean CPlugin_007(byte function, struct EventStruct *event, String& string)
         postDataStr += Settings.Unit;
         postDataStr += F("&json=");
 
-        for (byte i = 0; i < valueCount; ++i) {
-          postDataStr += (i == 0) ? F("{") : F(",");
-          postDataStr += F("field");
-          postDataStr += event->idx + i;
-          postDataStr += ":";
-          postDataStr += formatUserVarNoCheck(event, i);
-        }
+        postDataStr += C007_batch;
         postDataStr += "}";
+        C007_batch = "";
         postDataStr += F("&apikey=");
         postDataStr += SecuritySettings.ControllerPassword[event->ControllerIndex]; // "0UDNN17RW6XAS2E5" // api key
 
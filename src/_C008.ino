@@ -42,12 +42,13 @@ boolean CPlugin_008(byte function, struct EventStruct *event, String& string)
     case CPLUGIN_PROTOCOL_SEND:
       {
         byte valueCount = getValueCountFromSensorType(event->sensorType);
+        success = true;
         for (byte x = 0; x < valueCount; x++)
         {
           bool isvalid;
           String formattedValue = formatUserVar(event, x, isvalid);
-          if (isvalid)
-            HTTPSend(event, x, formattedValue);
+          if (isvalid && !HTTPSend(event, x, formattedValue))
+            success = false;
           if (valueCount > 1)
           {
             delayBackground(Settings.MessageDelay);
@@ -72,8 +73,7 @@ boolean HTTPSend(struct EventStruct *event, byte varIndex, const String& formatt
   if (!WiFiConnected(100)) {
     return false;
   }
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
   String authHeader = "";
   if ((SecuritySettings.ControllerUser[event->ControllerIndex][0] != 0) && (SecuritySettings.ControllerPassword[event->ControllerIndex][0] != 0))
@@ -86,7 +86,7 @@ boolean HTTPSend(struct EventStruct *event, byte varIndex, const String& formatt
     authHeader += encoder.encode(auth) + " \r\n";
   }
 
-  // boolean success = false;
+  boolean success = false;
   addLog(LOG_LEVEL_DEBUG, String(F("HTTP : connecting to "))+ControllerSettings.getHostPortString());
 
   // Use WiFiClient class to create TCP connections
@@ -136,7 +136,7 @@ boolean HTTPSend(struct EventStruct *event, byte varIndex, const String& formatt
       // strcpy_P(log, PSTR("HTTP : Success!"));
       // addLog(LOG_LEVEL_DEBUG, log);
       addLog(LOG_LEVEL_DEBUG, F("HTTP : Success!"));
-      // success = true;
+      success = true;
     }
     delay(1);
   }
@@ -147,6 +147,6 @@ boolean HTTPSend(struct EventStruct *event, byte varIndex, const String& formatt
   client.flush();
   client.stop();
 
-  return(true);
+  return success;
 }
 #endif
@@ -112,7 +112,7 @@ boolean CPlugin_009(byte function, struct EventStruct *event, String& string)
         String jsonString;
         root.printTo(jsonString);
         // Push data to server
-        FHEMHTTPsend(url, jsonString, event->ControllerIndex);
+        success = FHEMHTTPsend(url, jsonString, event->ControllerIndex);
         break;
       }
   }
@@ -124,12 +124,11 @@ boolean CPlugin_009(byte function, struct EventStruct *event, String& string)
 // FHEM HTTP request
 //********************************************************************************
 //TODO: create a generic HTTPSend function that we use in all the controllers. lots of code duplication here
-void FHEMHTTPsend(String & url, String & buffer, byte index)
+boolean FHEMHTTPsend(String & url, String & buffer, byte index)
 {
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(index, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(index);
 
-  // boolean success = false;
+  boolean success = false;
 
   String authHeader = "";
   if ((SecuritySettings.ControllerUser[index][0] != 0) && (SecuritySettings.ControllerPassword[index][0] != 0)) {
@@ -148,7 +147,7 @@ void FHEMHTTPsend(String & url, String & buffer, byte index)
     connectionFailures++;
     // strcpy_P(log, PSTR("HTTP : connection failed"));
     addLog(LOG_LEVEL_ERROR, F("HTTP : connection failed"));
-    return;
+    return false;
   }
 
   statusLED(true);
@@ -180,7 +179,7 @@ void FHEMHTTPsend(String & url, String & buffer, byte index)
     if (line.startsWith(F("HTTP/1.1 200 OK"))) {
       // strcpy_P(log, PSTR("HTTP : Success"));
       addLog(LOG_LEVEL_DEBUG_MORE, F("HTTP : Success"));
-      // success = true;
+      success = true;
     }
     else if (line.startsWith(F("HTTP/1.1 4"))) {
       addLog(LOG_LEVEL_ERROR, String(F("HTTP : Error: "))+line);
@@ -191,5 +190,6 @@ void FHEMHTTPsend(String & url, String & buffer, byte index)
   addLog(LOG_LEVEL_DEBUG, F("HTTP : closing connection"));
   client.flush();
   client.stop();
+  return success;
 }
 #endif
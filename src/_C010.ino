@@ -41,12 +41,13 @@ boolean CPlugin_010(byte function, struct EventStruct *event, String& string)
     case CPLUGIN_PROTOCOL_SEND:
       {
         byte valueCount = getValueCountFromSensorType(event->sensorType);
+        success = true;
         for (byte x = 0; x < valueCount; x++)
         {
           bool isvalid;
           String formattedValue = formatUserVar(event, x, isvalid);
-          if (isvalid)
-            C010_Send(event, x, formattedValue);
+          if (isvalid && !C010_Send(event, x, formattedValue))
+            success = false;
           if (valueCount > 1)
           {
             delayBackground(Settings.MessageDelay);
@@ -66,12 +67,11 @@ boolean CPlugin_010(byte function, struct EventStruct *event, String& string)
 //********************************************************************************
 // Generic UDP message
 //********************************************************************************
-void C010_Send(struct EventStruct *event, byte varIndex, const String& formattedValue)
+boolean C010_Send(struct EventStruct *event, byte varIndex, const String& formattedValue)
 {
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
-  // boolean success = false;
+  boolean success = false;
   addLog(LOG_LEVEL_DEBUG, String(F("UDP  : sending to ")) + ControllerSettings.getHostPortString());
   statusLED(true);
 
@@ -85,9 +85,10 @@ void C010_Send(struct EventStruct *event, byte varIndex, const String& formatted
   msg.replace(F("%value%"), formattedValue);
 
   if (wifiStatus == ESPEASY_WIFI_SERVICES_INITIALIZED) {
-    ControllerSettings.beginPacket(portUDP);
-    portUDP.write((uint8_t*)msg.c_str(),msg.length());
-    portUDP.endPacket();
+    if (ControllerSettings.beginPacket(portUDP)) {
+      portUDP.write((uint8_t*)msg.c_str(),msg.length());
+      success = portUDP.endPacket();
+    }
   }
 
   if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
@@ -95,5 +96,6 @@ void C010_Send(struct EventStruct *event, byte varIndex, const String& formatted
     msg.toCharArray(log, 80);
     addLog(LOG_LEVEL_DEBUG_MORE, log);
   }
+  return success;
 }
 #endif
@@ -117,7 +117,8 @@ boolean CPlugin_011(byte function, struct EventStruct *event, String& string)
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-      	HTTPSend011(event);
+        success = HTTPSend011(event);
+        break;
       }
 
   }
@@ -133,8 +134,7 @@ boolean HTTPSend011(struct EventStruct *event)
   if (!WiFiConnected(100)) {
     return false;
   }
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
 
   String authHeader = "";
   if ((SecuritySettings.ControllerUser[event->ControllerIndex][0] != 0) && (SecuritySettings.ControllerPassword[event->ControllerIndex][0] != 0))
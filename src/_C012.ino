@@ -68,8 +68,7 @@ boolean Blynk_get(const String& command, byte controllerIndex, float *data )
     return false;
   }
 
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(controllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(controllerIndex);
   // Use WiFiClient class to create TCP connections
   WiFiClient client;
   if ((SecuritySettings.ControllerPassword[controllerIndex][0] == 0) || !ControllerSettings.connectToHost(client))
@@ -80,7 +80,7 @@ boolean CPlugin_013(byte function, struct EventStruct *event, String& string)
 
     case CPLUGIN_PROTOCOL_SEND:
       {
-        C013_Send(event, 0, UserVar[event->BaseVarIndex], 0);
+        success = C013_Send(event, 0, getEventValues(event)[0], 0);
         break;
       }
 
@@ -98,12 +98,11 @@ boolean CPlugin_013(byte function, struct EventStruct *event, String& string)
 //********************************************************************************
 // Generic UDP message
 //********************************************************************************
-void C013_Send(struct EventStruct *event, byte varIndex, float value, unsigned long longValue)
+boolean C013_Send(struct EventStruct *event, byte varIndex, float value, unsigned long longValue)
 {
-  ControllerSettingsStruct ControllerSettings;
-  LoadControllerSettings(event->ControllerIndex, (byte*)&ControllerSettings, sizeof(ControllerSettings));
+  ControllerSettingsStruct& ControllerSettings = getControllerSettings(event->ControllerIndex);
   statusLED(true);
-  C013_SendUDPTaskData(0, event->TaskIndex, event->TaskIndex);
+  return C013_SendUDPTaskData(0, event->TaskIndex, event->TaskIndex, getEventValues(event));
 }
 
 void C013_SendUDPTaskInfo(byte destUnit, byte sourceTaskIndex, byte destTaskIndex)
@@ -139,17 +138,17 @@ void C013_SendUDPTaskInfo(byte destUnit, byte sourceTaskIndex, byte destTaskInde
   delay(50);
 }
 
-void C013_SendUDPTaskData(byte destUnit, byte sourceTaskIndex, byte destTaskIndex)
+boolean C013_SendUDPTaskData(byte destUnit, byte sourceTaskIndex, byte destTaskIndex, const float* values)
 {
   if (!WiFiConnected(100)) {
-    return;
+    return false;
   }
   struct dataStruct dataReply;
   dataReply.sourcelUnit = Settings.Unit;
   dataReply.sourceTaskIndex = sourceTaskIndex;
   dataReply.destTaskIndex = destTaskIndex;
   for (byte x = 0; x < VARS_PER_TASK; x++)
-    dataReply.Values[x] = UserVar[dataReply.sourceTaskIndex * VARS_PER_TASK + x];
+    dataReply.Values[x] = values[x];
 
   byte firstUnit = 1;
   byte lastUnit = UNIT_MAX - 1;
@@ -158,28 +157,32 @@ void C013_SendUDPTaskData(byte destUnit, byte sourceTaskIndex, byte destTaskInde
     firstUnit = destUnit;
     lastUnit = destUnit;
   }
+  boolean success = true;
   for (byte x = firstUnit; x <= lastUnit; x++)
   {
     if (x != Settings.Unit){
       dataReply.destUnit = x;
-      C013_sendUDP(x, (byte*) &dataReply, sizeof(dataStruct));
+      if (!C013_sendUDP(x, (byte*) &dataReply, sizeof(dataStruct)))
+        success = false;
       delay(10);
     }
   }
   delay(50);
+  return success;
 }
 
 /*********************************************************************************************\
    Send UDP message (unit 255=broadcast)
+   Returns false only when a message to a known node could not be sent.
   \*********************************************************************************************/
-void C013_sendUDP(byte unit, byte* data, byte size)
+boolean C013_sendUDP(byte unit, byte* data, byte size)
 {
   if (!WiFiConnected(100)) {
-    return;
+    return false;
   }
   if (unit != 255)
     if (Nodes[unit].ip[0] == 0)
-      return;
+      return true;
   if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
     String log = F("C013 : Send UDP message to ");
     log += unit;
@@ -193,11 +196,12 @@ void C013_sendUDP(byte unit, byte* data, byte size)
     remoteNodeIP = {255, 255, 255, 255};
   else
     remoteNodeIP = Nodes[unit].ip;
-  if (!beginWiFiUDP_randomPort(C013_portUDP)) return;
-  if (C013_portUDP.beginPacket(remoteNodeIP, Settings.UDPPort) == 0) return;
+  if (!beginWiFiUDP_randomPort(C013_portUDP)) return false;
+  if (C013_portUDP.beginPacket(remoteNodeIP, Settings.UDPPort) == 0) return false;
   C013_portUDP.write(data, size);
-  C013_portUDP.endPacket();
+  const boolean success = C013_portUDP.endPacket();
   C013_portUDP.stop();
+  return success;
 }
 
 void C013_Receive(struct EventStruct *event) {
@@ -4,7 +4,7 @@
 // 2=Dry
 // 3=Wet
 String humStatDomoticz(struct EventStruct *event, byte rel_index){
-  const int hum = UserVar[event->BaseVarIndex + rel_index];
+  const int hum = getEventValues(event)[rel_index];
   if (hum < 30) { return formatUserVarDomoticz(2); }
   if (hum < 40) { return formatUserVarDomoticz(0); }
   if (hum < 59) { return formatUserVarDomoticz(1); }
@@ -52,7 +52,7 @@ String formatDomoticzSensorType(struct EventStruct *event) {
       values  = formatUserVarDomoticz(event, 0);
       break;
     case SENSOR_TYPE_LONG:                      // single LONG value, stored in two floats (rfid tags)
-      values  = (unsigned long)UserVar[event->BaseVarIndex] + ((unsigned long)UserVar[event->BaseVarIndex + 1] << 16);
+      values  = (unsigned long)getEventValues(event)[0] + ((unsigned long)getEventValues(event)[1] << 16);
       break;
     case SENSOR_TYPE_DUAL:                       // any sensor that uses two simple values
       values  = formatUserVarDomoticz(event, 0);
@@ -105,12 +105,12 @@ String formatDomoticzSensorType(struct EventStruct *event) {
       // WindDir in degrees; WindDir as text; Wind speed average ; Wind speed gust; 0
       // http://www.domoticz.com/wiki/Domoticz_API/JSON_URL%27s#Wind
       values  = formatUserVarDomoticz(event, 0);           // WB = Wind bearing (0-359)
-      values += getBearing(UserVar[event->BaseVarIndex]);  // WD = Wind direction (S, SW, NNW, etc.)
+      values += getBearing(getEventValues(event)[0]);  // WD = Wind direction (S, SW, NNW, etc.)
       values += ";";  // Needed after getBearing
       // Domoticz expects the wind speed in (m/s * 10)
-      values += toString((UserVar[event->BaseVarIndex + 1] * 10),ExtraTaskSettings.TaskDeviceValueDecimals[1]);
+      values += toString((getEventValues(event)[1] * 10),ExtraTaskSettings.TaskDeviceValueDecimals[1]);
       values += ";"; // WS = 10 * Wind speed [m/s]
-      values += toString((UserVar[event->BaseVarIndex + 2] * 10),ExtraTaskSettings.TaskDeviceValueDecimals[2]);
+      values += toString((getEventValues(event)[2] * 10),ExtraTaskSettings.TaskDeviceValueDecimals[2]);
       values += ";"; // WG = 10 * Gust [m/s]
       values += formatUserVarDomoticz(0);  // Temperature
       values += formatUserVarDomoticz(0);  // Temperature Windchill
@@ -1113,9 +1113,7 @@ byte PluginCall(byte Function, struct EventStruct *event, String& str)
     case PLUGIN_UNCONDITIONAL_POLL:
       for (byte x = 0; x < PLUGIN_MAX; x++) {
         if (Plugin_id[x] != 0){
-          START_TIMER;
           Plugin_ptr[x](Function, event, str);
-          STOP_TIMER_TASK(x,Function);
         }
       }
       return true;
@@ -1140,7 +1138,7 @@ byte PluginCall(byte Function, struct EventStruct *event, String& str)
                 checkRAM(F("PluginCall_s"),x);
                 START_TIMER;
                 bool retval = (Plugin_ptr[x](Function, &TempEvent, str));
-                STOP_TIMER_TASK(x,Function);
+                STOP_TIMER_TASK(y,Function);
                 if (retval) return true;
               }
             }
@@ -1171,7 +1169,7 @@ byte PluginCall(byte Function, struct EventStruct *event, String& str)
               TempEvent.sensorType = Device[DeviceIndex].VType;
               START_TIMER;
               bool retval =  (Plugin_ptr[x](Function, &TempEvent, str));
-              STOP_TIMER_TASK(x,Function);
+              STOP_TIMER_TASK(y,Function);
               if (retval){
                 checkRAM(F("PluginCallUDP"),x);
                 return true;
@@ -1214,7 +1212,7 @@ byte PluginCall(byte Function, struct EventStruct *event, String& str)
                 }
                 START_TIMER;
                 Plugin_ptr[x](Function, &TempEvent, str);
-                STOP_TIMER_TASK(x,Function);
+                STOP_TIMER_TASK(y,Function);
               }
             }
           }
@@ -1255,7 +1253,7 @@ byte PluginCall(byte Function, struct EventStruct *event, String& str)
           if (Function == PLUGIN_GET_DEVICEVALUENAMES) {
             ExtraTaskSettings.TaskIndex = event->TaskIndex;
           }
-          STOP_TIMER_TASK(x,Function);
+          STOP_TIMER_TASK(event->TaskIndex,Function);
           return retval;
         }
       }
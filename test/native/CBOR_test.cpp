@@ -0,0 +1,90 @@
+// The CBOR encoder of the /json?format=cbor output (src/WebServer.ino),
+// checked with the examples of RFC 7049 appendix A.
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+// Collects what would be sent to the client.
+struct {
+  std::string data;
+
+  void operator+=(char c) { data += c; }
+  void operator+=(const __FlashStringHelper *s) { data += reinterpret_cast<const char *>(s); }
+  void addChars(const char *s, unsigned int length) { data.append(s, length); }
+} TXBuffer;
+
+#include "CBOR.h"
+
+namespace {
+
+std::string toHex(const std::string& data) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  for (unsigned char c : data) {
+    hex += digits[c >> 4];
+    hex += digits[c & 0x0f];
+  }
+  return hex;
+}
+
+std::string encoded() {
+  const std::string hex = toHex(TXBuffer.data);
+  TXBuffer.data.clear();
+  return hex;
+}
+
+}  // namespace
+
+TEST(CBOR, Integers) {
+  stream_cbor_uint(0);          EXPECT_EQ("00", encoded());
+  stream_cbor_uint(23);         EXPECT_EQ("17", encoded());
+  stream_cbor_uint(24);         EXPECT_EQ("1818", encoded());
+  stream_cbor_uint(100);        EXPECT_EQ("1864", encoded());
+  stream_cbor_uint(1000);       EXPECT_EQ("1903e8", encoded());
+  stream_cbor_uint(1000000);    EXPECT_EQ("1a000f4240", encoded());
+  stream_cbor_uint(4294967295); EXPECT_EQ("1affffffff", encoded());
+  stream_cbor_int(-1);          EXPECT_EQ("20", encoded());
+  stream_cbor_int(-100);        EXPECT_EQ("3863", encoded());
+  stream_cbor_int(-1000);       EXPECT_EQ("3903e7", encoded());
+  stream_cbor_int(10);          EXPECT_EQ("0a", encoded());
+}
+
+TEST(CBOR, FloatsAndBooleans) {
+  stream_cbor_float(100000.0);  EXPECT_EQ("fa47c35000", encoded());
+  stream_cbor_float(-4.1);      EXPECT_EQ("fac0833333", encoded());
+  stream_cbor_bool(false);      EXPECT_EQ("f4", encoded());
+  stream_cbor_bool(true);       EXPECT_EQ("f5", encoded());
+}
+
+TEST(CBOR, Text) {
+  stream_cbor_text("");         EXPECT_EQ("60", encoded());
+  stream_cbor_text("a");        EXPECT_EQ("6161", encoded());
+  stream_cbor_text(String("IETF")); EXPECT_EQ("6449455446", encoded());
+  stream_cbor_text(F("\"\\"));  EXPECT_EQ("62225c", encoded());
+  stream_cbor_text(static_cast<const char *>(NULL)); EXPECT_EQ("60", encoded());
+  const std::string longText(300, 'x');
+  stream_cbor_text(longText.c_str());
+  EXPECT_EQ("79012c" + toHex(longText), encoded());
+}
+
+TEST(CBOR, IndefiniteLengthContainers) {
+  // {_ "a": 1, "b": [_ 2, 3]}
+  stream_cbor_begin(CBOR_MAP);
+  stream_cbor_uint_value(F("a"), 1);
+  stream_cbor_text(F("b"));
+  stream_cbor_begin(CBOR_ARRAY);
+  stream_cbor_uint(2);
+  stream_cbor_uint(3);
+  stream_cbor_end();
+  stream_cbor_end();
+  EXPECT_EQ("bf61610161629f0203ffff", encoded());
+
+  stream_cbor_begin(CBOR_MAP);
+  stream_cbor_int_value(F("i"), -2);
+  stream_cbor_bool_value(F("b"), true);
+  stream_cbor_text_value(F("t"), "x");
+  stream_cbor_text_value(F("s"), String("y"));
+  stream_cbor_float_value(F("f"), 1.5);
+  stream_cbor_end();
+  EXPECT_EQ("bf6169216162f561746178617361796166fa3fc00000ff", encoded());
+}
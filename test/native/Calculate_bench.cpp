@@ -0,0 +1,26 @@
+// Calculate() of typical task value formulas (src/Misc.ino).
+
+#include "Arduino.h"
+#include "bench.h"
+
+void checkRAM(const __FlashStringHelper* flashString) {}
+
+#include "Calculate.h"
+
+int main() {
+  const char *formulas[] = {
+    "21.50",
+    "21.50*1.8+32",
+    "(1013.25-1000.00)/10",
+    "((21.50+0.30)*1.8+32)/2^2",
+  };
+  benchHeader("Calculate()");
+  for (const char *formula : formulas) {
+    bench(formula, [formula]() {
+      float result;
+      benchKeep(Calculate(formula, &result));
+      benchKeep(result);
+    });
+  }
+  return 0;
+}
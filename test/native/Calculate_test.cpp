@@ -0,0 +1,59 @@
+// Calculate() of simple expressions (src/Misc.ino), as used for task value formulas and rules.
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+void checkRAM(const __FlashStringHelper* flashString) {}
+
+#include "Calculate.h"
+
+namespace {
+
+float calculate(const char *input, int expectedError = CALCULATE_OK) {
+  float result = -12345;
+  EXPECT_EQ(expectedError, Calculate(input, &result)) << input;
+  return result;
+}
+
+}  // namespace
+
+TEST(Calculate, Numbers) {
+  EXPECT_EQ(42, calculate("42"));
+  EXPECT_EQ(1.5, calculate("1.5"));
+  EXPECT_EQ(-3, calculate("-3"));
+  EXPECT_EQ(7, calculate(" 7 "));
+}
+
+TEST(Calculate, OperatorPrecedence) {
+  EXPECT_EQ(7, calculate("1+2*3"));
+  EXPECT_EQ(9, calculate("(1+2)*3"));
+  EXPECT_EQ(2.5, calculate("10/4"));
+  EXPECT_EQ(1, calculate("8-4-3"));
+  EXPECT_EQ(1, calculate("8/4/2"));
+  EXPECT_EQ(19, calculate("3+2^4"));
+  // All operators are left associative, also ^
+  EXPECT_EQ(64, calculate("2^3^2"));
+  EXPECT_EQ(-6, calculate("3*-2"));
+  EXPECT_EQ(5, calculate("((((5))))"));
+}
+
+TEST(Calculate, FormulaWithValue) {
+  // As SensorSendTask() does for "%value%*1.8+32" with a value of 21.50
+  EXPECT_FLOAT_EQ(70.7, calculate("21.50*1.8+32"));
+  EXPECT_FLOAT_EQ(0.5, calculate("(21.50-20.50)/2"));
+}
+
+TEST(Calculate, Errors) {
+  calculate("(1+2", CALCULATE_ERROR_PARENTHESES_MISMATCHED);
+  calculate("1+2)", CALCULATE_ERROR_PARENTHESES_MISMATCHED);
+  calculate("a+1", CALCULATE_ERROR_UNKNOWN_TOKEN);
+  calculate("1%2", CALCULATE_ERROR_UNKNOWN_TOKEN);
+  // More than STACK_SIZE values waiting for their operator.
+  calculate("1+(2+(3+(4+(5+(6+(7+(8+(9+(10+(11+12))))))))))", CALCULATE_ERROR_STACK_OVERFLOW);
+}
+
+TEST(Calculate, StackIsResetOnEveryCall) {
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(3, calculate("1+2"));
+  }
+}
@@ -0,0 +1,125 @@
+// The log ring buffer (LogStruct in src/ESPEasy-Globals.h), with a small buffer to test the wrap around.
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define LOG_BUFFER_SIZE         1024
+#define LOG_STRUCT_MESSAGE_SIZE 128
+#define LOG_BUFFER_LOCK()
+#define LOG_BUFFER_UNLOCK()
+
+#include "LogBuffer.h"
+
+namespace {
+
+bool readLine(LogStruct& log, byte destination, String& line, byte& logLevel, unsigned long& timestamp) {
+  char buf[LOG_LINE_MAX_SIZE + 1];
+  timestamp = 0;
+  if (!log.read(destination, timestamp, logLevel, buf, sizeof(buf))) return false;
+  line = buf;
+  return true;
+}
+
+String readLine(LogStruct& log, byte destination) {
+  String line;
+  byte logLevel;
+  unsigned long timestamp;
+  readLine(log, destination, line, logLevel, timestamp);
+  return line;
+}
+
+}  // namespace
+
+TEST(LogBuffer, EachDestinationReadsItsOwnLines) {
+  LogStruct log;
+  shim_millis = 1234;
+  log.add(1, (1 << LOG_TO_SERIAL) | (1 << LOG_TO_WEBLOG), "first");
+  log.add(2, (1 << LOG_TO_SYSLOG), "second");
+  log.add(3, (1 << LOG_TO_SERIAL), "third");
+
+  String line;
+  byte logLevel = 0;
+  unsigned long timestamp = 0;
+  ASSERT_TRUE(readLine(log, LOG_TO_SERIAL, line, logLevel, timestamp));
+  EXPECT_EQ("first", line);
+  EXPECT_EQ(1, logLevel);
+  EXPECT_EQ(1234UL, timestamp);
+  EXPECT_EQ("third", readLine(log, LOG_TO_SERIAL));
+  EXPECT_FALSE(readLine(log, LOG_TO_SERIAL, line, logLevel, timestamp));
+
+  EXPECT_EQ("second", readLine(log, LOG_TO_SYSLOG));
+  EXPECT_EQ("first", readLine(log, LOG_TO_WEBLOG));
+  EXPECT_FALSE(readLine(log, LOG_TO_EVENTSTREAM, line, logLevel, timestamp));
+  EXPECT_TRUE(log.isEmpty(LOG_TO_SERIAL));
+}
+
+TEST(LogBuffer, LongLinesAreCutForTheWebLogOnly) {
+  LogStruct log;
+  const std::string longLine(200, 'x');
+  log.add(1, (1 << LOG_TO_SERIAL) | (1 << LOG_TO_SYSLOG) | (1 << LOG_TO_WEBLOG), longLine.c_str());
+  EXPECT_EQ(longLine, readLine(log, LOG_TO_SERIAL));
+  EXPECT_EQ(longLine, readLine(log, LOG_TO_SYSLOG));
+  EXPECT_EQ(longLine.substr(0, LOG_STRUCT_MESSAGE_SIZE - 1), readLine(log, LOG_TO_WEBLOG));
+
+  const std::string tooLong(LOG_LINE_MAX_SIZE + 10, 'y');
+  log.add(1, (1 << LOG_TO_SERIAL), tooLong.c_str());
+  EXPECT_EQ(tooLong.substr(0, LOG_LINE_MAX_SIZE), readLine(log, LOG_TO_SERIAL));
+}
+
+TEST(LogBuffer, ReadIsCutToTheBufferSize) {
+  LogStruct log;
+  log.add(1, (1 << LOG_TO_SERIAL), "first line");
+  log.add(1, (1 << LOG_TO_SERIAL), "second");
+  char buf[6];
+  unsigned long timestamp;
+  byte logLevel;
+  ASSERT_TRUE(log.read(LOG_TO_SERIAL, timestamp, logLevel, buf, sizeof(buf)));
+  EXPECT_STREQ("first", buf);
+  // The rest of the line is skipped.
+  EXPECT_EQ("second", readLine(log, LOG_TO_SERIAL));
+}
+
+TEST(LogBuffer, SerialLinesDoNotPushOutTheWebLog) {
+  LogStruct log;
+  log.add(1, (1 << LOG_TO_SERIAL) | (1 << LOG_TO_WEBLOG), "web");
+  const std::string debugLine(100, 'd');
+  for (int i = 0; i < 100; ++i) {
+    log.add(4, (1 << LOG_TO_SERIAL), debugLine.c_str());
+  }
+  EXPECT_EQ("web", readLine(log, LOG_TO_WEBLOG));
+  EXPECT_EQ(debugLine, readLine(log, LOG_TO_SERIAL));
+}
+
+TEST(LogBuffer, OverwrittenLinesAreSkipped) {
+  LogStruct log;
+  // 40 records of 8 + 12 bytes do not fit in the ring, the oldest are dropped.
+  char line[16];
+  for (int i = 0; i < 40; ++i) {
+    snprintf(line, sizeof(line), "line %7d", i);
+    log.add(1, (1 << LOG_TO_SERIAL) | (1 << LOG_TO_SYSLOG), line);
+    if (i == 2) {
+      EXPECT_EQ("line       0", readLine(log, LOG_TO_SYSLOG));
+    }
+  }
+  // The reader continues at the oldest line still in the buffer, in order.
+  const int oldest = 40 - LOG_RING_SIZE / (LOG_RECORD_HEADER_SIZE + 12);
+  for (int i = oldest; i < 40; ++i) {
+    snprintf(line, sizeof(line), "line %7d", i);
+    EXPECT_EQ(line, readLine(log, LOG_TO_SERIAL));
+    EXPECT_EQ(line, readLine(log, LOG_TO_SYSLOG));
+  }
+  EXPECT_EQ("", readLine(log, LOG_TO_SERIAL));
+}
+
+TEST(LogBuffer, RandomLinesAcrossTheBufferEnd) {
+  LogStruct log;
+  srand(2);
+  for (int i = 0; i < 10000; ++i) {
+    const int length = rand() % LOG_LINE_MAX_SIZE;
+    std::string text;
+    for (int j = 0; j < length; ++j) text += static_cast<char>('a' + rand() % 26);
+    log.add(1, (1 << LOG_TO_SERIAL), text.c_str());
+    // Read right away, so nothing is dropped.
+    EXPECT_EQ(text, readLine(log, LOG_TO_SERIAL));
+  }
+}
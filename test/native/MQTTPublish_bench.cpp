@@ -0,0 +1,221 @@
+// Publish of the task values of an MQTT controller (C005, src/Controller.ino) against a broker
+// stand-in, compared with the String building publish it replaced.
+
+#include "Arduino.h"
+#include "PubSubClient.h"
+#include "bench.h"
+
+#define TASKS_MAX                  12
+#define VARS_PER_TASK               4
+#define CONTROLLER_MAX              3
+#define DEVICES_MAX                 2
+#define ESPEASY_WIFI_DISCONNECTED   0
+
+// Takes everything the client sends, like a broker on a fast network.
+class BrokerClient : public Client {
+public:
+  BrokerClient() : readPos(0), sentBytes(0), sentHash(0) {}
+
+  size_t write(uint8_t b) override {
+    ++sentBytes;
+    sentHash = (sentHash ^ b) * 16777619UL;
+    return 1;
+  }
+  size_t write(const uint8_t *buf, size_t size) override {
+    for (size_t i = 0; i < size; ++i) write(buf[i]);
+    return size;
+  }
+  int available() override { return sizeof(connack) - readPos; }
+  int read() override { return connack[readPos++]; }
+  int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+  int connect(const char *host, uint16_t port) override { readPos = 0; return 1; }
+  uint8_t connected() override { return 1; }
+  void stop() override {}
+
+  const uint8_t connack[4] = { 0x20, 0x02, 0x00, 0x00 };
+  size_t readPos;
+  unsigned long sentBytes;
+  uint32_t sentHash;      // To check that both publish the same
+};
+
+BrokerClient brokerClient;
+PubSubClient MQTTclient(brokerClient);
+
+// Used by the publish, not part of the benchmark.
+enum WiFiMode_t { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+
+class IPAddressStub {
+public:
+  uint8_t operator[](int index) const { return 192 - index; }
+  String toString() const { return F("192.168.1.189"); }
+};
+
+struct {
+  IPAddressStub localIP() { return IPAddressStub(); }
+  int RSSI() { return -67; }
+  String SSID() { return F("MyWiFi"); }
+  String BSSIDstr() { return F("01:23:45:67:89:AB"); }
+  int channel() { return 6; }
+  String macAddress() { return F("5C:CF:7F:01:02:03"); }
+} WiFi;
+
+struct {
+  uint32_t getFreeHeap() { return 20000; }
+} ESP;
+
+struct {
+  byte Unit;
+  char Name[26];
+  byte TaskDeviceNumber[TASKS_MAX];
+  boolean MQTTRetainFlag;
+} Settings = { 3, "ESP_Easy", { 1 }, false };
+
+struct {
+  byte TaskIndex;
+  char TaskDeviceName[41];
+  char TaskDeviceValueNames[VARS_PER_TASK][41];
+  byte TaskDeviceValueDecimals[VARS_PER_TASK];
+} ExtraTaskSettings = { 0, "Climate", { "Temperature", "Humidity", "Pressure", "" }, { 2, 1, 0, 0 } };
+
+struct DeviceStruct {
+  byte VType;
+  byte ValueCount;
+} Device[DEVICES_MAX] = { { 0, 0 }, { 3, 3 } };
+
+struct ControllerSettingsStruct {
+  char Publish[129];
+} ControllerSettings = { "%sysname%/%tskname%/%valname%" };
+
+struct TaskSettingsCacheStruct {
+  byte TaskDeviceValueDecimals[VARS_PER_TASK];
+};
+
+float UserVar[VARS_PER_TASK * TASKS_MAX] = { 21.37, 55.2, 1013.0 };
+byte wifiStatus = 3;
+unsigned long wdcounter = 1234;
+
+void addLog(byte logLevel, const String& line) {}
+void addLog(byte logLevel, const __FlashStringHelper *line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+void LoadTaskSettings(byte TaskIndex) {}
+byte getDeviceIndex(byte Number) { return Number; }
+bool isValidFloat(float f) { return !isnan(f) && !isinf(f); }
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex) {
+  static TaskSettingsCacheStruct cache;
+  return cache;
+}
+ControllerSettingsStruct& getControllerSettings(byte ControllerIndex) { return ControllerSettings; }
+#define TIMER_MQTT 1
+void setIntervalTimerOverride(unsigned long id, unsigned long msecFromNow) {}
+// Returns right away without a "%c_" conversion in the topic.
+void parseStandardConversions(String& s, boolean useURLencode) {}
+String URLEncode(const char* msg) { return msg; }
+float getCPUload() { return 12.5; }
+int year() { return 2018; }
+int month() { return 7; }
+int day() { return 14; }
+int hour() { return 9; }
+int minute() { return 5; }
+int second() { return 42; }
+int weekday() { return 7; }
+String weekday_str() { return F("Sat"); }
+String getTimeString(char delimiter, bool show_seconds = true) { return F("09:05:42"); }
+String getTimeString_ampm(char delimiter, bool show_seconds = true) { return F("9:05:42 AM"); }
+String getDateTimeString(char dateDelimiter, char timeDelimiter, char dateTimeDelimiter) { return F("2018-07-14 09:05:42"); }
+String getDateTimeString_ampm(char dateDelimiter, char timeDelimiter, char dateTimeDelimiter) { return F("2018-07-14 9:05:42 AM"); }
+unsigned long getUnixTime() { return 1531559142UL; }
+int getSecOffset(const String& format) { return 0; }
+String getSunriseTimeString(char delimiter, int secOffset) { return F("05:42"); }
+String getSunsetTimeString(char delimiter, int secOffset) { return F("21:58"); }
+#define strcmp_P(a, b)      strcmp(a, b)
+#define strncmp_P(a, b, n)  strncmp(a, b, n)
+#define sprintf_P           sprintf
+
+#include "MQTTPublish.h"
+
+namespace {
+
+// CPLUGIN_PROTOCOL_SEND of C005 as it was: topic parsed and value formatted into Strings for every publish.
+void publishBefore(struct EventStruct *event) {
+  String pubname = ControllerSettings.Publish;
+  parseControllerVariables(pubname, event, false);
+
+  String value = "";
+  for (byte x = 0; x < 3; x++)
+  {
+    String tmppubname = pubname;
+    tmppubname.replace(F("%valname%"), ExtraTaskSettings.TaskDeviceValueNames[x]);
+    value = formatUserVarNoCheck(event, x);
+
+    MQTTpublish(event->ControllerIndex, tmppubname.c_str(), value.c_str(), Settings.MQTTRetainFlag);
+    String log = F("MQTT : ");
+    log += tmppubname;
+    log += " ";
+    log += value;
+    addLog(LOG_LEVEL_DEBUG, log);
+  }
+}
+
+// CPLUGIN_PROTOCOL_SEND of C005 now.
+void publishCached(struct EventStruct *event) {
+  String topic;
+  char value[FORMAT_VALUE_BUFFER_SIZE];
+  for (byte x = 0; x < 3; x++)
+  {
+    const String& pubname = getMQTTTopic(event, x, topic);
+    formatUserVarNoCheck(event, x, value);
+    MQTTpublish(event->ControllerIndex, pubname.c_str(), value, Settings.MQTTRetainFlag);
+    if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+      String log = F("MQTT : ");
+      log += pubname;
+      log += ' ';
+      log += value;
+      addLog(LOG_LEVEL_DEBUG, log);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  MQTTclient.setServer("broker", 1883);
+  if (!MQTTclient.connect("bench")) return 1;
+
+  struct EventStruct event;
+  event.TaskIndex = 0;
+  event.ControllerIndex = 0;
+  event.idx = 1;
+
+  const char *topics[] = { "%sysname%/%tskname%/%valname%", "%sysname%/%tskname%/%valname%/%systime%" };
+  for (const char *publish : topics) {
+    strcpy(ControllerSettings.Publish, publish);
+    invalidateMQTTTopicCache();
+    brokerClient.sentHash = 0;
+    publishBefore(&event);
+    const uint32_t sentBefore = brokerClient.sentHash;
+    brokerClient.sentBytes = 0;
+    brokerClient.sentHash = 0;
+    publishCached(&event);
+    const unsigned long bytesPerCall = brokerClient.sentBytes;
+    if (brokerClient.sentHash != sentBefore) {
+      printf("%s: the publish differs\n", publish);
+      return 1;
+    }
+
+    char title[96];
+    snprintf(title, sizeof(title), "3 values published as %s", publish);
+    benchHeader(title);
+    bench("topic and value Strings (before)", [&event]() { publishBefore(&event); }, bytesPerCall);
+    bench("cached topic, value buffer", [&event]() { publishCached(&event); }, bytesPerCall);
+  }
+
+  // The topics are cached per controller, a task sent to two MQTT controllers is not parsed again.
+  strcpy(ControllerSettings.Publish, topics[0]);
+  invalidateMQTTTopicCache();
+  benchHeader("3 values published to 2 controllers in turn");
+  bench("cached topic, value buffer", [&event]() {
+    event.ControllerIndex = 1 - event.ControllerIndex;
+    publishCached(&event);
+  });
+  return 0;
+}
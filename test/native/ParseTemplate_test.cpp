@@ -0,0 +1,140 @@
+// parseTemplate() (src/Misc.ino) with the task value name index (src/ESPEasyStorage.ino).
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define TASKS_MAX      12
+#define VARS_PER_TASK   4
+
+// Used by parseTemplate(), not part of the test.
+struct {
+  byte TaskDeviceNumber[TASKS_MAX];
+  boolean TaskDeviceEnabled[TASKS_MAX];
+} Settings;
+
+struct {
+  byte TaskIndex;
+} ExtraTaskSettings;
+
+float UserVar[VARS_PER_TASK * TASKS_MAX];
+String pluginRequest;
+
+void addLog(byte logLevel, const String& line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+void checkRAM(const __FlashStringHelper* flashString) {}
+void LoadTaskSettings(byte TaskIndex) { ExtraTaskSettings.TaskIndex = TaskIndex; }
+void invalidateMQTTTopicCache() {}
+void parseSystemVariables(String& s, boolean useURLencode) {}
+void parseStandardConversions(String& s, boolean useURLencode) {}
+String toString(float value, byte decimals) {
+  String sValue = String(value, decimals);
+  sValue.trim();
+  return sValue;
+}
+struct EventStruct;
+boolean PluginCall(byte Function, struct EventStruct *event, String& str);
+struct TaskSettingsCacheStruct;
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex);
+String formatUserVar(byte TaskIndex, byte rel_index, bool& isvalid);
+
+#include "ParseTemplate.h"
+
+boolean PluginCall(byte Function, struct EventStruct *event, String& str) {
+  if (Function != PLUGIN_REQUEST) return false;
+  pluginRequest = str;
+  str = F("1");
+  return true;
+}
+
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex) { return TaskSettingsCache[TaskIndex]; }
+
+String formatUserVar(byte TaskIndex, byte rel_index, bool& isvalid) {
+  isvalid = true;
+  return toString(UserVar[TaskIndex * VARS_PER_TASK + rel_index], TaskSettingsCache[TaskIndex].TaskDeviceValueDecimals[rel_index]);
+}
+
+namespace {
+
+class ParseTemplate : public ::testing::Test {
+protected:
+  void SetUp() override {
+    memset(&Settings, 0, sizeof(Settings));
+    ExtraTaskSettings.TaskIndex = 255;
+    for (byte x = 0; x < TASKS_MAX; ++x) TaskSettingsCache[x].clear();
+    addTask(0, "Temp", { "Temperature", "Humidity" }, { 2, 0 });
+    addTask(3, "Switch", { "State" }, { 0 });
+    UserVar[0] = 21.5;
+    UserVar[1] = 55;
+    UserVar[3 * VARS_PER_TASK] = 1;
+    TaskValueIndex.valid = false;
+  }
+
+  void addTask(byte TaskIndex, const char *name, std::initializer_list<const char *> valueNames, std::initializer_list<byte> decimals) {
+    Settings.TaskDeviceNumber[TaskIndex] = 1;
+    Settings.TaskDeviceEnabled[TaskIndex] = true;
+    TaskSettingsCacheStruct& cache = TaskSettingsCache[TaskIndex];
+    cache.loaded = true;
+    cache.TaskDeviceName = name;
+    byte varNr = 0;
+    for (const char *valueName : valueNames) cache.TaskDeviceValueNames[varNr++] = valueName;
+    varNr = 0;
+    for (byte decimal : decimals) cache.TaskDeviceValueDecimals[varNr++] = decimal;
+  }
+
+  String parse(const char *text, byte lineSize = 0) {
+    String tmpString(text);
+    return parseTemplate(tmpString, lineSize);
+  }
+};
+
+}  // namespace
+
+TEST_F(ParseTemplate, TaskValues) {
+  EXPECT_EQ("T=21.50 H=55%", parse("T=[Temp#Temperature] H=[temp#HUMIDITY]%"));
+  EXPECT_EQ("no template", parse("no template"));
+  EXPECT_EQ("[open", parse("[open"));
+}
+
+TEST_F(ParseTemplate, UnknownNamesAreRemoved) {
+  EXPECT_EQ("a  b", parse("a [Nope#Value] b"));
+  EXPECT_EQ("a  b", parse("a [Temp#Nope] b"));
+  EXPECT_EQ("ab", parse("a[nohash]b"));
+  Settings.TaskDeviceEnabled[3] = false;
+  TaskValueIndex.valid = false;
+  EXPECT_EQ("", parse("[Switch#State]"));
+}
+
+TEST_F(ParseTemplate, Transformations) {
+  EXPECT_EQ(" ON", parse("[Switch#State#O]"));
+  EXPECT_EQ("OFF", parse("[Switch#State#!O]"));
+  EXPECT_EQ("YES", parse("[Switch#State#Y]"));
+  EXPECT_EQ("0021.50", parse("[Temp#Temperature#D4.2]"));
+  EXPECT_EQ("21.5", parse("[Temp#Temperature#D.1]"));
+  EXPECT_EQ("ERR", parse("[Temp#Temperature#Q]"));
+}
+
+TEST_F(ParseTemplate, Justification) {
+  EXPECT_EQ("21", parse("[Temp#Temperature#V#L2]"));
+  EXPECT_EQ(".50", parse("[Temp#Temperature#V#R3]"));
+  EXPECT_EQ("  ON|", parse("[Switch#State#O#P4]|"));
+  EXPECT_EQ("ON  |", parse("[Switch#State#O#S4]|"));
+  EXPECT_EQ(".5", parse("[Temp#Temperature#V#U3.2]"));
+}
+
+TEST_F(ParseTemplate, LineSize) {
+  EXPECT_EQ("T=21.50   ", parse("T=[Temp#Temperature]", 10));
+  EXPECT_EQ("T=   21.50", parse("T=[Temp#Temperature#VR]", 10));
+}
+
+TEST_F(ParseTemplate, PluginRequest) {
+  EXPECT_EQ("pin 1", parse("pin [Plugin#GPIO#Pinstate#12]"));
+  EXPECT_EQ("GPIO,Pinstate,12", pluginRequest);
+}
+
+TEST_F(ParseTemplate, TaskValueIndexFollowsTheSettings) {
+  EXPECT_EQ("21.50", parse("[Temp#Temperature]"));
+  TaskSettingsCache[0].TaskDeviceName = "Outside";
+  invalidateTaskValueIndex();
+  EXPECT_EQ("", parse("[Temp#Temperature]"));
+  EXPECT_EQ("21.50", parse("[Outside#Temperature]"));
+}
@@ -0,0 +1,86 @@
+// MQTT publish of lib/pubsubclient, beginPublish()/write()/endPublish() must send
+// the same packet as publish().
+
+#include <vector>
+
+#include "PubSubClient.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Records what is sent, answers a connect with CONNACK.
+class TestClient : public Client {
+public:
+  TestClient() : readPos(0) {}
+
+  size_t write(uint8_t b) override { sent.push_back(b); return 1; }
+  size_t write(const uint8_t *buf, size_t size) override {
+    sent.insert(sent.end(), buf, buf + size);
+    return size;
+  }
+  int available() override { return received.size() - readPos; }
+  int read() override { return received[readPos++]; }
+  int connect(IPAddress ip, uint16_t port) override { return connect("", port); }
+  int connect(const char *host, uint16_t port) override {
+    received = { 0x20, 0x02, 0x00, 0x00 };
+    readPos = 0;
+    return 1;
+  }
+  uint8_t connected() override { return 1; }
+  void stop() override {}
+
+  std::vector<uint8_t> sent;
+  std::vector<uint8_t> received;
+  size_t readPos;
+};
+
+}  // namespace
+
+TEST(PubSubClient, BeginPublishSendsSamePacketAsPublish) {
+  TestClient client;
+  PubSubClient mqtt(client);
+  mqtt.setServer("broker", 1883);
+  ASSERT_TRUE(mqtt.connect("test"));
+
+  for (int length : { 0, 5, 100, 127, 128, 200, 360 }) {
+    std::string payload(length, 'a');
+    for (int i = 0; i < length; ++i) payload[i] = 'a' + i % 26;
+
+    client.sent.clear();
+    EXPECT_TRUE(mqtt.publish("some/topic", payload.c_str(), true));
+    const std::vector<uint8_t> published = client.sent;
+
+    client.sent.clear();
+    ASSERT_TRUE(mqtt.beginPublish("some/topic", true));
+    mqtt.print(payload.substr(0, length / 2).c_str());
+    mqtt.print(payload.substr(length / 2).c_str());
+    EXPECT_TRUE(mqtt.endPublish());
+    EXPECT_EQ(published, client.sent) << "Payload length " << length;
+  }
+}
+
+TEST(PubSubClient, TooLongPayloadIsNotSent) {
+  TestClient client;
+  PubSubClient mqtt(client);
+  mqtt.setServer("broker", 1883);
+  ASSERT_TRUE(mqtt.connect("test"));
+  const std::string payload(MQTT_MAX_PACKET_SIZE, 'a');
+
+  client.sent.clear();
+  EXPECT_FALSE(mqtt.publish("some/topic", payload.c_str(), true));
+  ASSERT_TRUE(mqtt.beginPublish("some/topic", true));
+  mqtt.print(payload.c_str());
+  EXPECT_FALSE(mqtt.endPublish());
+  EXPECT_TRUE(client.sent.empty());
+}
+
+TEST(PubSubClient, WriteOutsidePublishIsIgnored) {
+  TestClient client;
+  PubSubClient mqtt(client);
+  mqtt.setServer("broker", 1883);
+  ASSERT_TRUE(mqtt.connect("test"));
+  client.sent.clear();
+  EXPECT_FALSE(mqtt.endPublish());
+  EXPECT_EQ(0U, mqtt.write(reinterpret_cast<const uint8_t *>("x"), 1));
+  EXPECT_TRUE(client.sent.empty());
+}
@@ -0,0 +1,62 @@
+// Rules processing of an event (src/Misc.ino), from the rules file and from the compiled rules set.
+
+#include <vector>
+
+#include "Arduino.h"
+#include "FS.h"
+#include "bench.h"
+
+#define ESP8266
+#define TASKS_MAX 12
+
+#define START_TIMER
+#define STOP_TIMER(L)
+
+long timePassedSince(unsigned long timestamp) { return static_cast<long>(millis() - timestamp); }
+
+// Used by the rules, not part of the benchmark.
+struct {
+  byte SerialLogLevel;
+} Settings;
+
+struct {
+  template <typename T> void print(const T& value) {}
+  template <typename T> void println(const T& value) {}
+} Serial;
+
+void addLog(byte logLevel, const String& line) {}
+void addLog(byte logLevel, const __FlashStringHelper *line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+void checkRAM(const __FlashStringHelper* flashString) {}
+unsigned long FreeMem() { return 40000; }
+String toString(bool value) { return value ? F("true") : F("false"); }
+unsigned long string2TimeLong(const String &str) { return 0; }
+boolean matchClockEvent(unsigned long clockEvent, unsigned long clockSet) { return false; }
+String parseTemplate(String &tmpString, byte lineSize) { return tmpString; }
+struct EventStruct;
+void parseCommandString(struct EventStruct *event, const String& string) {}
+boolean PluginCall(byte Function, struct EventStruct *event, String& str) { return false; }
+void ExecuteCommand(byte source, const char *Line) { benchKeep(Line[0]); }
+
+#include "Rules.h"
+
+int main() {
+  // 20 tasks with a block each, one of them handles the event.
+  std::string rules = "// Rules of a node with 20 tasks\n";
+  for (int i = 0; i < 20; ++i) {
+    const std::string name = "Task" + std::to_string(i);
+    rules += "on " + name + "#Value>20 do // Too warm\n";
+    rules += "  if 30>25\n    publish,warm," + name + ",%eventvalue%\n  else\n    gpio,12,0\n  endif\nendon\n\n";
+  }
+  const String fileName = getRulesFileName(0);
+  SPIFFS.files[fileName.c_str()] = std::vector<uint8_t>(rules.begin(), rules.end());
+  activeRuleSets[0] = true;
+
+  benchHeader("rulesProcessing(), 20 blocks");
+  String event("Task10#Value=30");
+  rulesSetCache[0].clear();
+  bench("rules file", [&event]() { rulesProcessing(event); });
+  compileRuleSet(0, fileName);
+  bench("compiled rules set", [&event]() { rulesProcessing(event); });
+  return 0;
+}
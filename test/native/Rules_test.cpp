@@ -0,0 +1,206 @@
+// Rules processing (src/Misc.ino), from the rules file and from the compiled rules set.
+
+#include <vector>
+
+#include "Arduino.h"
+#include "FS.h"
+#include "gtest/gtest.h"
+
+#define ESP8266
+#define TASKS_MAX 12
+
+#define START_TIMER
+#define STOP_TIMER(L)
+
+long timePassedSince(unsigned long timestamp) { return static_cast<long>(millis() - timestamp); }
+
+// Used by the rules, not part of the test.
+struct {
+  byte SerialLogLevel;
+} Settings;
+
+struct {
+  template <typename T> void print(const T& value) {}
+  template <typename T> void println(const T& value) {}
+} Serial;
+
+void addLog(byte logLevel, const String& line) {}
+void addLog(byte logLevel, const __FlashStringHelper *line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+void checkRAM(const __FlashStringHelper* flashString) {}
+unsigned long FreeMem() { return 40000; }
+String toString(bool value) { return value ? F("true") : F("false"); }
+unsigned long string2TimeLong(const String &str) { return 0; }
+boolean matchClockEvent(unsigned long clockEvent, unsigned long clockSet) { return false; }
+String parseTemplate(String &tmpString, byte lineSize) { return tmpString; }
+struct EventStruct;
+void parseCommandString(struct EventStruct *event, const String& string) {}
+boolean PluginCall(byte Function, struct EventStruct *event, String& str) { return false; }
+void ExecuteCommand(byte source, const char *Line);
+
+#include "Rules.h"
+
+namespace {
+
+std::vector<std::string> commands;
+
+const char rules[] =
+  "// Comment line\n"
+  "on System#Boot do\n"
+  "  gpio,12,1 // switch on\n"
+  "endon\n"
+  "Outside a block\n"
+  "\n"
+  "on Temp#Value>20 do\n"
+  "  publish,warm,%eventvalue%\n"
+  "  if 30>25\n"
+  "    event,Hot\n"
+  "  else\n"
+  "    event,NotCalled\n"
+  "  endif\n"
+  "endon\n"
+  "on Temp#Value<5 do publish,cold\n"
+  "on !Serial#hel* do\n"
+  "  publish,serial\n"
+  "endon\n"
+  "On Switch#State=1 Do\n"
+  "  if 1=1 and 2<1\n"
+  "    gpio,13,0\n"
+  "  else\n"
+  "    gpio,13,1\n"
+  "  endif\n"
+  "endon\n"
+  "on * do\n"
+  "  counter,1\n"
+  "endon\n"
+  "on Loop do\n"
+  "  event,Loop\n"
+  "endon\n";
+
+}  // namespace
+
+// Nested events are processed right away, like the "event" command does.
+void ExecuteCommand(byte source, const char *Line) {
+  commands.push_back(Line);
+  const String line(Line);
+  if (line.startsWith(F("event,Loop"))) {
+    String event = line.substring(6);
+    rulesProcessing(event);
+  }
+}
+
+namespace {
+
+class Rules : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SPIFFS.files.clear();
+    const String fileName = getRulesFileName(0);
+    SPIFFS.files[fileName.c_str()] = std::vector<uint8_t>(rules, rules + strlen(rules));
+    for (byte x = 0; x < RULESETS_MAX; ++x) {
+      activeRuleSets[x] = false;
+      rulesSetCache[x].clear();
+    }
+    activeRuleSets[0] = true;
+    rulesNestingLevel = 0;
+    commands.clear();
+  }
+
+  std::vector<std::string> process(const char *event, bool cached) {
+    rulesSetCache[0].clear();
+    if (cached) {
+      EXPECT_TRUE(compileRuleSet(0, getRulesFileName(0)));
+    }
+    commands.clear();
+    String tmpEvent(event);
+    rulesProcessing(tmpEvent);
+    return commands;
+  }
+};
+
+typedef std::vector<std::string> Commands;
+
+}  // namespace
+
+TEST_F(Rules, CompiledRulesSetHasOnlyBlocks) {
+  ASSERT_TRUE(compileRuleSet(0, getRulesFileName(0)));
+  EXPECT_TRUE(rulesSetCache[0].cached);
+  EXPECT_EQ(7U, rulesSetCache[0].blocks.size());
+  EXPECT_EQ(std::string::npos, rulesSetCache[0].lines.find("//"));
+  EXPECT_EQ(std::string::npos, rulesSetCache[0].lines.find("Outside"));
+}
+
+TEST_F(Rules, MatchingBlocksRunInOrder) {
+  for (bool cached : { false, true }) {
+    EXPECT_EQ(Commands({ "gpio,12,1", "counter,1" }), process("System#Boot", cached));
+    EXPECT_EQ(Commands({ "publish,warm,30", "event,Hot", "counter,1" }), process("Temp#Value=30", cached));
+    EXPECT_EQ(Commands({ "publish,cold", "counter,1" }), process("Temp#Value=2", cached));
+    EXPECT_EQ(Commands({ "counter,1" }), process("Temp#Value=10", cached));
+    EXPECT_EQ(Commands({ "publish,serial", "counter,1" }), process("!Serial#hello", cached));
+    EXPECT_EQ(Commands({ "gpio,13,1", "counter,1" }), process("Switch#State=1", cached));
+    EXPECT_EQ(Commands({ "counter,1" }), process("Switch#State=0", cached));
+  }
+}
+
+TEST_F(Rules, CachedRulesGiveTheSameCommandsAsTheFile) {
+  const char *events[] = {
+    "System#Boot", "system#boot", "Temp#Value=20", "Temp#Value=20.5", "temp#value=-1",
+    "Temp#Value", "!Serial#help", "!Serial#other", "Switch#State=1", "Other#Event=3",
+    "Clock#Time=Sun,12:00", ""
+  };
+  for (const char *event : events) {
+    EXPECT_EQ(process(event, false), process(event, true)) << event;
+  }
+}
+
+TEST_F(Rules, NestingLevelIsLimited) {
+  for (bool cached : { false, true }) {
+    const Commands executed = process("Loop", cached);
+    EXPECT_EQ(RULES_MAX_NESTING_LEVEL * 2, static_cast<int>(executed.size()));
+    EXPECT_EQ(0, rulesNestingLevel);
+  }
+}
+
+TEST(RulesCondition, Compare) {
+  EXPECT_TRUE(conditionMatch("5>3"));
+  EXPECT_FALSE(conditionMatch("5<3"));
+  EXPECT_TRUE(conditionMatch("5=5.0"));
+  EXPECT_TRUE(conditionMatch("5!=4"));
+  EXPECT_FALSE(conditionMatch("5<>5"));
+  EXPECT_TRUE(conditionMatch("5>=5"));
+  EXPECT_TRUE(conditionMatch("-2<=-2"));
+  EXPECT_TRUE(conditionMatch("12:30<13:00"));
+  EXPECT_FALSE(conditionMatch("5"));
+}
+
+TEST(RulesCondition, AndOr) {
+  String check("1=1 and 2=2");
+  EXPECT_TRUE(conditionMatchExtended(check));
+  check = "1=1 and 2=3";
+  EXPECT_FALSE(conditionMatchExtended(check));
+  check = "1=2 or 2=2";
+  EXPECT_TRUE(conditionMatchExtended(check));
+  check = "1=2 or 2=3 or 3=3";
+  EXPECT_TRUE(conditionMatchExtended(check));
+}
+
+TEST(RulesMatch, EventAgainstRule) {
+  String event("Temp#Value=30");
+  String rule("Temp#Value>20");
+  EXPECT_TRUE(ruleMatch(event, rule));
+  rule = "temp#value<20";
+  EXPECT_FALSE(ruleMatch(event, rule));
+  rule = "Temp#Value=30";
+  EXPECT_TRUE(ruleMatch(event, rule));
+  rule = "Temp#Other";
+  EXPECT_FALSE(ruleMatch(event, rule));
+  event = "!Serial#hello";
+  rule = "!Serial#hel*";
+  EXPECT_TRUE(ruleMatch(event, rule));
+}
+
+TEST(RulesMatch, EventNameHashIgnoresCaseAndValue) {
+  EXPECT_EQ(rulesEventNameHash("Temp#Value=30", false), rulesEventNameHash("temp#value>20", true));
+  EXPECT_EQ(rulesEventNameHash("Temp#Value=30", false), rulesEventNameHash("TEMP#VALUE<5", true));
+  EXPECT_NE(rulesEventNameHash("Temp#Value=30", false), rulesEventNameHash("Temp#Other", true));
+}
@@ -0,0 +1,194 @@
+// Queue of controller sends (src/Controller.ino), with the Domoticz HTTP controller (src/_C001.ino).
+
+#include <cmath>
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define TASKS_MAX      12
+#define VARS_PER_TASK   4
+#define CONTROLLER_MAX  3
+
+#define START_TIMER
+#define STOP_TIMER(L)
+
+long timeDiff(unsigned long prev, unsigned long next) {
+  return static_cast<long>(static_cast<int32_t>(next - prev));
+}
+long timePassedSince(unsigned long timestamp) { return timeDiff(timestamp, millis()); }
+boolean timeOutReached(unsigned long timer) { return timePassedSince(timer) >= 0; }
+
+// Used by the queue and the controller, not part of the test.
+struct {
+  boolean TaskDeviceSendData[CONTROLLER_MAX][TASKS_MAX];
+  boolean ControllerEnabled[CONTROLLER_MAX];
+  byte    Protocol[CONTROLLER_MAX];
+  unsigned int TaskDeviceID[CONTROLLER_MAX][TASKS_MAX];
+  unsigned long MessageDelay;
+} Settings;
+
+struct {
+  char ControllerUser[CONTROLLER_MAX][26];
+  char ControllerPassword[CONTROLLER_MAX][64];
+} SecuritySettings;
+
+float UserVar[VARS_PER_TASK * TASKS_MAX];
+String dummyString;
+unsigned long lastSend = 0;
+int protocolCount = -1;
+unsigned long connectionFailures = 0;
+bool wifiConnected = false;
+
+void addLog(byte logLevel, const String& line) {}
+void addLog(byte logLevel, const __FlashStringHelper *line) {}
+void LoadTaskSettings(byte TaskIndex) {}
+void schedule_send_data_timer(unsigned long runAt) {}
+void delayBackground(unsigned long delay) { shim_millis += delay; }
+void statusLED(bool traffic) {}
+bool WiFiConnected(uint32_t timeout_ms) { return wifiConnected; }
+int mapRSSItoDomoticz() { return 10; }
+String formatDomoticzSensorType(struct EventStruct *event) { return String(); }
+
+class WiFiClient {
+public:
+  size_t print(const String& str) { return str.length(); }
+  int available() { return 0; }
+  void flush() {}
+  void stop() {}
+};
+void safeReadStringUntil(WiFiClient& client, String& str, char character) {}
+
+struct ControllerSettingsStruct {
+  boolean connectToHost(WiFiClient& client) { return false; }
+  String getHost() const { return String(); }
+  String getHostPortString() const { return String(); }
+};
+ControllerSettingsStruct controllerSettings;
+ControllerSettingsStruct& getControllerSettings(byte ControllerIndex) { return controllerSettings; }
+
+class base64 {
+public:
+  String encode(const String& text) { return text; }
+};
+
+#define CPLUGIN_MAX 16
+boolean (*CPlugin_ptr[CPLUGIN_MAX])(byte, struct EventStruct*, String&);
+
+#include "SendDataQueue.h"
+
+namespace {
+
+class SendDataQueue : public ::testing::Test {
+protected:
+  void SetUp() override {
+    shim_millis = 1000;
+    memset(&Settings, 0, sizeof(Settings));
+    memset(UserVar, 0, sizeof(UserVar));
+    for (byte x = 0; x < CONTROLLER_MAX; ++x)
+      ControllerQueue[x] = ControllerQueueStruct();
+    sendDataQueueLength = 0;
+    protocolCount = -1;
+    wifiConnected = false;
+    String dummy;
+    CPlugin_ptr[0] = &CPlugin_001;
+    CPlugin_001(CPLUGIN_PROTOCOL_ADD, NULL, dummy);
+    Settings.ControllerEnabled[0] = true;
+    Settings.Protocol[0] = CPLUGIN_ID_001;
+  }
+
+  void queueTask(byte TaskIndex, unsigned int idx) {
+    Settings.TaskDeviceSendData[0][TaskIndex] = true;
+    Settings.TaskDeviceID[0][TaskIndex] = idx;
+    UserVar[TaskIndex * VARS_PER_TASK] = 21.5;
+    struct EventStruct event;
+    event.TaskIndex = TaskIndex;
+    event.sensorType = SENSOR_TYPE_SINGLE;
+    queueSendData(&event);
+  }
+};
+
+TEST_F(SendDataQueue, FailedSendIsRetriedWithBackoff) {
+  queueTask(0, 5);
+  processSendDataQueue(false);
+  EXPECT_EQ(1, sendDataQueueLength);
+  EXPECT_EQ(1, ControllerQueue[0].failures);
+  EXPECT_EQ(1UL, ControllerQueue[0].retries);
+  EXPECT_EQ(shim_millis + CONTROLLER_RETRY_DELAY_MSEC, ControllerQueue[0].retryAt);
+}
+
+TEST_F(SendDataQueue, IdxZeroIsNotAFailure) {
+  wifiConnected = true;
+  queueTask(0, 0);
+  queueTask(1, 0);
+  processSendDataQueue(false);
+  processSendDataQueue(false);
+  EXPECT_EQ(0, sendDataQueueLength);
+  EXPECT_EQ(0, ControllerQueue[0].failures);
+  EXPECT_EQ(0UL, ControllerQueue[0].retries);
+  EXPECT_EQ(0UL, ControllerQueue[0].dropped);
+  EXPECT_EQ(0UL, ControllerQueue[0].retryAt);
+}
+
+TEST_F(SendDataQueue, IdxZeroDoesNotDelayOtherTasks) {
+  queueTask(0, 0);
+  queueTask(1, 5);
+  processSendDataQueue(false);
+  // Task 0 is done, task 1 failed once.
+  ASSERT_EQ(1, sendDataQueueLength);
+  EXPECT_EQ(1, sendDataQueue[0].TaskIndex);
+  EXPECT_EQ(0, ControllerQueue[0].failures);
+  processSendDataQueue(false);
+  EXPECT_EQ(1, ControllerQueue[0].failures);
+}
+
+// A controller which, like one waiting in delayBackground(), runs rules that set and send task values.
+float sentValue = 0;
+int nestedSends = 0;
+boolean nestedController(byte function, struct EventStruct *event, String& string) {
+  if (function != CPLUGIN_PROTOCOL_SEND) return false;
+  sentValue = getEventValues(event)[0];
+  for (int i = 0; i < nestedSends; ++i) {
+    UserVar[event->BaseVarIndex] = 99;
+    struct EventStruct nested;
+    nested.TaskIndex = event->TaskIndex;
+    nested.sensorType = SENSOR_TYPE_SINGLE;
+    queueSendData(&nested);
+    processSendDataQueue(false);
+  }
+  return true;
+}
+
+TEST_F(SendDataQueue, ControllerGetsQueuedValues) {
+  CPlugin_ptr[0] = &nestedController;
+  queueTask(0, 5);
+  UserVar[0] = 30;
+  processSendDataQueue(false);
+  EXPECT_EQ(21.5, sentValue);
+  EXPECT_EQ(30, UserVar[0]);
+}
+
+TEST_F(SendDataQueue, NestedSendsWaitUntilDone) {
+  CPlugin_ptr[0] = &nestedController;
+  for (int i = 0; i < SEND_DATA_QUEUE_MAX; ++i)
+    queueTask(i % TASKS_MAX, 5);
+  nestedSends = SEND_DATA_DEFERRED_MAX + 2;
+  processSendDataQueue(false);
+  nestedSends = 0;
+  // The value set during the send is kept.
+  EXPECT_EQ(99, UserVar[0]);
+  // The first entry was sent and removed, the others are kept in order.
+  // The queue was full, so the oldest deferred entries dropped out of it.
+  ASSERT_EQ(SEND_DATA_QUEUE_MAX, sendDataQueueLength);
+  EXPECT_EQ(2 + SEND_DATA_DEFERRED_MAX - 1, ControllerQueue[0].dropped);
+  EXPECT_EQ(1UL, ControllerQueue[0].sent);
+  for (int i = 0; i < SEND_DATA_QUEUE_MAX - SEND_DATA_DEFERRED_MAX; ++i) {
+    EXPECT_EQ((i + SEND_DATA_DEFERRED_MAX) % TASKS_MAX, sendDataQueue[i].TaskIndex);
+    EXPECT_EQ(1, sendDataQueue[i].controllers);
+  }
+  for (int i = SEND_DATA_QUEUE_MAX - SEND_DATA_DEFERRED_MAX; i < SEND_DATA_QUEUE_MAX; ++i) {
+    EXPECT_EQ(0, sendDataQueue[i].TaskIndex);
+    EXPECT_EQ(99, sendDataQueue[i].values[0]);
+  }
+}
+
+}  // namespace
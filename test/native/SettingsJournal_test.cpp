@@ -0,0 +1,171 @@
+// Page wise writes of the settings files and the settings journal (src/ESPEasyStorage.ino),
+// including a simulated power loss at every write of a save.
+
+#include <vector>
+
+#include "Arduino.h"
+#include "FS.h"
+#include "esp_partition.h"
+#include "gtest/gtest.h"
+
+// Used by the storage code, not part of the test.
+void addLog(byte logLevel, const String& line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+String formatToHex(unsigned long value) { return String(); }
+int taskSettingsCacheCleared = 0;
+void clearTaskSettingsCache() { ++taskSettingsCacheCleared; }
+int taskFormulasCleared = 0;
+void clearTaskFormulas() { ++taskFormulasCleared; }
+void invalidateControllerSettingsCache() {}
+
+#include "SettingsJournal.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Data;
+
+Data pattern(size_t size, int seed) {
+  Data data(size);
+  for (size_t i = 0; i < size; ++i) data[i] = (i * seed + seed) & 0xff;
+  return data;
+}
+
+class SettingsJournal : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SPIFFS.files.clear();
+    SPIFFS.files[FILE_CONFIG] = Data(8192, 0);
+    SPIFFS.files[FILE_SECURITY] = Data(1024, 0);
+    settingsJournal = SettingsJournalStruct();
+    shim_fs_write_limit = -1;
+    taskSettingsCacheCleared = 0;
+    taskFormulasCleared = 0;
+  }
+
+  Data& config() { return SPIFFS.files[FILE_CONFIG]; }
+  Data& security() { return SPIFFS.files[FILE_SECURITY]; }
+};
+
+}  // namespace
+
+TEST_F(SettingsJournal, WritesOnlyChangedPages) {
+  SPIFFS.files["/other.dat"] = Data(4096, 0);
+  Data data = pattern(1000, 3);
+  int written = 0;
+  EXPECT_EQ("", writeToFile("/other.dat", 100, data.data(), data.size(), written));
+  EXPECT_EQ(1000, written);
+  EXPECT_EQ(0, memcmp(SPIFFS.files["/other.dat"].data() + 100, data.data(), data.size()));
+
+  EXPECT_EQ("", writeToFile("/other.dat", 100, data.data(), data.size(), written));
+  EXPECT_EQ(0, written);
+
+  // Only the page of the changed byte, pages are aligned to the file position.
+  data[500] ^= 0xff;
+  EXPECT_EQ("", writeToFile("/other.dat", 100, data.data(), data.size(), written));
+  EXPECT_EQ(DAT_FILE_PAGE_SIZE, written);
+
+  // nullptr clears.
+  EXPECT_EQ("", writeToFile("/other.dat", 100, nullptr, data.size(), written));
+  EXPECT_EQ(1000, written);
+  EXPECT_EQ(Data(4096, 0), SPIFFS.files["/other.dat"]);
+}
+
+TEST_F(SettingsJournal, SingleSaveIsAppliedAndJournalRemoved) {
+  const Data data = pattern(1000, 3);
+  int written = 0;
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 100, data.data(), data.size(), written));
+  EXPECT_EQ(1000, written);
+  EXPECT_EQ(0, memcmp(config().data() + 100, data.data(), data.size()));
+  EXPECT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 100, data.data(), data.size(), written));
+  EXPECT_EQ(0, written);
+}
+
+TEST_F(SettingsJournal, BatchIsReadBackBeforeCommit) {
+  const Data before = config();
+  const Data data = pattern(600, 7);
+  int written = 0;
+  beginSettingsBatch();
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 2000, data.data(), data.size(), written));
+  EXPECT_EQ(before, config());
+
+  // Loads during the batch see the saves not yet committed.
+  Data read(600);
+  ASSERT_TRUE(readFromFile(FILE_CONFIG, 2000, read.data(), read.size()));
+  EXPECT_EQ(data, read);
+
+  // Clearing part of it again within the batch must be journaled too.
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 2000, nullptr, 300, written));
+  EXPECT_GT(written, 0);
+  const Data secret = pattern(200, 11);
+  EXPECT_EQ("", writeToFile(FILE_SECURITY, 0, secret.data(), secret.size(), written));
+  EXPECT_EQ("", commitSettingsBatch());
+
+  Data expected = before;
+  memcpy(expected.data() + 2000, data.data(), data.size());
+  memset(expected.data() + 2000, 0, 300);
+  EXPECT_EQ(expected, config());
+  EXPECT_EQ(0, memcmp(security().data(), secret.data(), secret.size()));
+  EXPECT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+}
+
+TEST_F(SettingsJournal, FailedBatchIsDropped) {
+  const Data before = config();
+  const Data data = pattern(600, 7);
+  int written = 0;
+  beginSettingsBatch();
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 2000, data.data(), data.size(), written));
+  settingsJournal.failed = true;
+  EXPECT_NE("", commitSettingsBatch());
+  EXPECT_EQ(before, config());
+  EXPECT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+  EXPECT_EQ(1, taskSettingsCacheCleared);
+  EXPECT_EQ(1, taskFormulasCleared);
+}
+
+TEST_F(SettingsJournal, PowerLossAtEveryWriteKeepsOldOrNewSettings) {
+  const Data newConfigData = pattern(1500, 13);
+  const Data newSecurityData = pattern(100, 17);
+  const Data oldConfig = config();
+  const Data oldSecurity = security();
+  Data newConfig = oldConfig;
+  memcpy(newConfig.data() + 3000, newConfigData.data(), newConfigData.size());
+  Data newSecurity = oldSecurity;
+  memcpy(newSecurity.data() + 500, newSecurityData.data(), newSecurityData.size());
+
+  int oldResults = 0;
+  int newResults = 0;
+  for (long limit = 0; ; ++limit) {
+    config() = oldConfig;
+    security() = oldSecurity;
+    SPIFFS.remove(FILE_SETTINGS_JOURNAL);
+    settingsJournal = SettingsJournalStruct();
+
+    shim_fs_write_limit = limit;
+    bool powerLoss = false;
+    try {
+      int written = 0;
+      beginSettingsBatch();
+      writeToFile(FILE_CONFIG, 3000, newConfigData.data(), newConfigData.size(), written);
+      writeToFile(FILE_SECURITY, 500, newSecurityData.data(), newSecurityData.size(), written);
+      commitSettingsBatch();
+    } catch (const ShimPowerLoss&) {
+      powerLoss = true;
+    }
+
+    // Boot
+    shim_fs_write_limit = -1;
+    settingsJournal = SettingsJournalStruct();
+    ASSERT_GE(replaySettingsJournal(), 0);
+    const bool isOld = config() == oldConfig && security() == oldSecurity;
+    const bool isNew = config() == newConfig && security() == newSecurity;
+    ASSERT_TRUE(isOld || isNew) << "Power loss after " << limit << " bytes";
+    ASSERT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+    if (isOld) ++oldResults;
+    else ++newResults;
+    if (!powerLoss) break;
+  }
+  EXPECT_GT(oldResults, 0);
+  EXPECT_GT(newResults, 0);
+}
@@ -0,0 +1,108 @@
+// Loads and saves of config.dat in a memory mapped ESP32 partition (src/ESPEasyStorage.ino),
+// compared with config.dat on SPIFFS.  Both go through the settings journal.
+// The host time only covers the code path, the flash of the ESP is not timed.  The bytes
+// programmed and sectors erased per save are counted by the shims and printed with the save.
+// The SPIFFS shim has no garbage collection, the sectors SPIFFS erases for it are not counted.
+
+#define ESP32
+#define USE_SETTINGS_PARTITION
+
+#include <climits>
+#include <vector>
+
+#include "Arduino.h"
+#include "FS.h"
+#include "esp_partition.h"
+#include "bench.h"
+
+// Used by the storage code, not part of the benchmark.
+void addLog(byte logLevel, const String& line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+String formatToHex(unsigned long value) { return String(); }
+void clearTaskSettingsCache() {}
+void clearTaskFormulas() {}
+void invalidateControllerSettingsCache() {}
+
+#include "SettingsJournal.h"
+
+namespace {
+
+#define TASK_SETTINGS_OFFSET 34816  // Task 1 on ESP32, DAT_OFFSET_TASKS + 2048
+
+typedef std::vector<uint8_t> Data;
+
+Data pattern(size_t size, int seed) {
+  Data data(size);
+  for (size_t i = 0; i < size; ++i) data[i] = (i * seed + seed) & 0xff;
+  return data;
+}
+
+// config.dat with the same content on SPIFFS and in the partition.
+void setupFiles() {
+  const Data config = pattern(CONFIG_FILE_SIZE, 3);
+  SPIFFS.files.clear();
+  SPIFFS.files[FILE_CONFIG] = config;
+  SPIFFS.files[FILE_SECURITY] = Data(1024, 0);
+  shim_partition_create(CONFIG_FILE_SIZE);
+  settingsPartition = SettingsPartitionStruct();
+  settingsPartitionInit();
+  settingsPartitionWrite(0, config.data(), config.size());
+}
+
+// Switches config.dat between SPIFFS and the partition, as useSettingsPartition() sees it.
+SettingsPartitionStruct mappedPartition;
+
+void useSpiffs(bool spiffs) {
+  if (settingsPartition.data != nullptr) mappedPartition = settingsPartition;
+  settingsPartition = spiffs ? SettingsPartitionStruct() : mappedPartition;
+}
+
+void benchLoad(const char *name, bool spiffs) {
+  useSpiffs(spiffs);
+  byte data[DAT_TASKS_SIZE];
+  bench(name, [&data]() {
+    readFromFile(FILE_CONFIG, TASK_SETTINGS_OFFSET, data, sizeof(data));
+    benchKeep(data[0]);
+  }, DAT_TASKS_SIZE);
+}
+
+// Every save changes the first 100 bytes of the task settings, like a changed task name.
+void benchSave(const char *name, bool spiffs) {
+  useSpiffs(spiffs);
+  Data data[2] = { pattern(DAT_TASKS_SIZE, 5), pattern(DAT_TASKS_SIZE, 5) };
+  data[1][10] ^= 0x55;
+  data[1][99] ^= 0x55;
+  int i = 0;
+  auto save = [&]() {
+    int written = 0;
+    writeToFile(FILE_CONFIG, TASK_SETTINGS_OFFSET, data[++i & 1].data(), DAT_TASKS_SIZE, written);
+  };
+  save();
+
+  // Both shims count every programmed byte and erased sector against the write limit.
+  const long limit = LONG_MAX;
+  shim_fs_write_limit = limit;
+  const unsigned long erases = shim_partition_erases;
+  save();
+  const unsigned long sectors = shim_partition_erases - erases;
+  const unsigned long bytes = limit - shim_fs_write_limit - sectors;
+  shim_fs_write_limit = -1;
+
+  bench(name, save);
+  printf("  %-52s %12lu bytes programmed, %lu sectors erased\n", "", bytes, sectors);
+}
+
+}  // namespace
+
+int main() {
+  setupFiles();
+
+  benchHeader("Load of task settings, 1024 bytes of config.dat");
+  benchLoad("SPIFFS open, seek and read (before)", true);
+  benchLoad("memcpy from the mapped partition", false);
+
+  benchHeader("Save of task settings with 2 changed bytes, through the journal");
+  benchSave("SPIFFS changed pages (before)", true);
+  benchSave("partition changed sector", false);
+  return 0;
+}
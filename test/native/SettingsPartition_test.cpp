@@ -0,0 +1,120 @@
+// config.dat in a memory mapped ESP32 partition (src/ESPEasyStorage.ino), written through the
+// settings journal, including a simulated power loss at every erase and write of a save.
+
+#define ESP32
+#define USE_SETTINGS_PARTITION
+
+#include <vector>
+
+#include "Arduino.h"
+#include "FS.h"
+#include "esp_partition.h"
+#include "gtest/gtest.h"
+
+// Used by the storage code, not part of the test.
+void addLog(byte logLevel, const String& line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+String formatToHex(unsigned long value) { return String(); }
+void clearTaskSettingsCache() {}
+void clearTaskFormulas() {}
+void invalidateControllerSettingsCache() {}
+
+#include "SettingsJournal.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Data;
+
+Data pattern(size_t size, int seed) {
+  Data data(size);
+  for (size_t i = 0; i < size; ++i) data[i] = (i * seed + seed) & 0xff;
+  return data;
+}
+
+class SettingsPartition : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SPIFFS.files.clear();
+    SPIFFS.files[FILE_SECURITY] = Data(1024, 0);
+    shim_partition_create(CONFIG_FILE_SIZE);
+    shim_fs_write_limit = -1;
+    boot();
+  }
+
+  void boot() {
+    settingsJournal = SettingsJournalStruct();
+    settingsPartition = SettingsPartitionStruct();
+    ASSERT_TRUE(settingsPartitionInit());
+  }
+
+  Data config() { return Data(settingsPartition.data, settingsPartition.data + CONFIG_FILE_SIZE); }
+};
+
+TEST_F(SettingsPartition, SaveWritesOnlyChangedSectors) {
+  const Data stored = pattern(CONFIG_FILE_SIZE, 3);
+  ASSERT_EQ(CONFIG_FILE_SIZE, settingsPartitionWrite(0, stored.data(), stored.size()));
+  shim_partition_erases = 0;
+
+  const Data data = pattern(300, 7);
+  int written = 0;
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 8000, data.data(), data.size(), written));
+  // 8000..8299 spans the second and third sector.
+  EXPECT_EQ(2 * SPI_FLASH_SEC_SIZE, written);
+  EXPECT_EQ(2UL, shim_partition_erases);
+  Data expected = stored;
+  memcpy(expected.data() + 8000, data.data(), data.size());
+  EXPECT_EQ(expected, config());
+  EXPECT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+
+  // Saving the same again does not touch the flash.
+  EXPECT_EQ("", writeToFile(FILE_CONFIG, 8000, data.data(), data.size(), written));
+  EXPECT_EQ(0, written);
+  EXPECT_EQ(2UL, shim_partition_erases);
+}
+
+TEST_F(SettingsPartition, PowerLossAtEveryWriteKeepsOldOrNewSettings) {
+  const Data oldConfig = pattern(CONFIG_FILE_SIZE, 3);
+  const Data newData = pattern(300, 7);
+  const Data newSecurityData = pattern(100, 17);
+  Data newConfig = oldConfig;
+  memcpy(newConfig.data() + 8000, newData.data(), newData.size());
+  const Data oldSecurity = SPIFFS.files[FILE_SECURITY];
+  Data newSecurity = oldSecurity;
+  memcpy(newSecurity.data() + 500, newSecurityData.data(), newSecurityData.size());
+
+  int oldResults = 0;
+  int newResults = 0;
+  for (long limit = 0; ; ++limit) {
+    shim_partition_flash = oldConfig;
+    SPIFFS.files[FILE_SECURITY] = oldSecurity;
+    SPIFFS.remove(FILE_SETTINGS_JOURNAL);
+    settingsJournal = SettingsJournalStruct();
+
+    shim_fs_write_limit = limit;
+    bool powerLoss = false;
+    try {
+      int written = 0;
+      beginSettingsBatch();
+      writeToFile(FILE_CONFIG, 8000, newData.data(), newData.size(), written);
+      writeToFile(FILE_SECURITY, 500, newSecurityData.data(), newSecurityData.size(), written);
+      commitSettingsBatch();
+    } catch (const ShimPowerLoss&) {
+      powerLoss = true;
+    }
+
+    shim_fs_write_limit = -1;
+    boot();
+    ASSERT_GE(replaySettingsJournal(), 0);
+    const bool isOld = config() == oldConfig && SPIFFS.files[FILE_SECURITY] == oldSecurity;
+    const bool isNew = config() == newConfig && SPIFFS.files[FILE_SECURITY] == newSecurity;
+    ASSERT_TRUE(isOld || isNew) << "Power loss after " << limit << " writes";
+    ASSERT_FALSE(SPIFFS.exists(FILE_SETTINGS_JOURNAL));
+    if (isOld) ++oldResults;
+    else ++newResults;
+    if (!powerLoss) break;
+  }
+  EXPECT_GT(oldResults, 0);
+  EXPECT_GT(newResults, 0);
+}
+
+}  // namespace
@@ -0,0 +1,162 @@
+// StreamingBuffer (src/WebServer.ino) rendering a /json like page, compared with the per character
+// String version it replaced.
+
+#include "Arduino.h"
+#include "bench.h"
+
+#define LOG_LEVEL_DEBUG 3
+
+// Used by StreamingBuffer, not part of the benchmark.  The client takes every chunk right away.
+void addLog(byte logLevel, const String& line) {}
+void sendContentBlocking(const char* data, unsigned int length) { benchKeep(length); }
+void sendHeaderBlocking(const __FlashStringHelper* contentType, bool allowCORS) {}
+
+struct {
+  uint32_t getFreeHeap() { return 20000; }
+} ESP;
+
+class WebServerClient {
+public:
+  void setTimeout(unsigned long timeout) {}
+  void stop() {}
+};
+
+struct {
+  WebServerClient client() { return WebServerClient(); }
+  void send(int code, const char *contentType, const char *content) {}
+} WebServer;
+
+#include "StreamingBuffer.h"
+
+namespace {
+
+// The buffer as it was before the chunk, without the memory statistics.
+// Every character is appended to a String, every += returns a copy of the buffer.
+class oldStreamingBuffer {
+public:
+  String buf;
+
+  oldStreamingBuffer() {
+    buf.reserve(CHUNKED_BUFFER_SIZE + 50);
+  }
+  oldStreamingBuffer operator+= (char a)                   { return addString(String(a)); }
+  oldStreamingBuffer operator+= (long unsigned int  a)     { return addString(String(a)); }
+  oldStreamingBuffer operator+= (float a)                  { return addString(String(a)); }
+  oldStreamingBuffer operator+= (int a)                    { return addString(String(a)); }
+  oldStreamingBuffer operator+= (const String& a)          { return addString(a); }
+
+  oldStreamingBuffer operator+= (PGM_P str) {
+    if (!str) return *this;
+    int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
+    if (flush_step < 1) flush_step = 0;
+    unsigned int pos = 0;
+    const unsigned int length = strlen_P((PGM_P)str);
+    if (length == 0) return *this;
+    while (pos < length) {
+      if (flush_step == 0) {
+        send();
+        flush_step = CHUNKED_BUFFER_SIZE;
+      }
+      this->buf += (char)pgm_read_byte(&str[pos]);
+      ++pos;
+      --flush_step;
+    }
+    checkFull();
+    return *this;
+  }
+
+  oldStreamingBuffer addString(const String& a) {
+    int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
+    if (flush_step < 1) flush_step = 0;
+    int pos = 0;
+    const int length = a.length();
+    while (pos < length) {
+      if (flush_step == 0) {
+        send();
+        flush_step = CHUNKED_BUFFER_SIZE;
+      }
+      this->buf += a[pos];
+      ++pos;
+      --flush_step;
+    }
+    checkFull();
+    return *this;
+  }
+
+  void checkFull() {
+    if (this->buf.length() > CHUNKED_BUFFER_SIZE) send();
+  }
+
+  void startJsonStream() {}
+
+  void endStream() {
+    if (buf.length() > 0) send();
+    send();
+  }
+
+private:
+  void send() {
+    sendContentBlocking(buf.c_str(), buf.length());
+    buf = "";
+  }
+};
+
+const char *valueNames[] = { "Temperature", "Humidity", "Pressure", "Dewpoint" };
+
+// Like handle_json() with the sensors of all tasks.
+template <typename Buffer>
+void renderJsonPage(Buffer& buffer) {
+  buffer.startJsonStream();
+  buffer += F("{\"System\":{\n\"Build\":20100,\n\"Unit\":1,\n\"Uptime\":1234\n},\n\"Sensors\":[\n");
+  for (int task = 0; task < 12; ++task) {
+    buffer += F("{\n\"TaskValues\": [\n");
+    for (int varNr = 0; varNr < 4; ++varNr) {
+      buffer += F("{\"ValueNumber\":");
+      buffer += varNr + 1;
+      buffer += ',';
+      buffer += F("\"Name\":\"");
+      buffer += String(valueNames[varNr]);
+      buffer += F("\",\n\"NrDecimals\":2,\n\"Value\":");
+      buffer += 21.5f + task + varNr;
+      buffer += F("\n}");
+      if (varNr < 3) buffer += ',';
+      buffer += '\n';
+    }
+    buffer += F("],\n\"DataAcquisition\": [\n{\"Controller\":1,\"IDX\":0,\"Enabled\":\"true\"}\n],\n");
+    buffer += F("\"TaskInterval\":60,\n\"Type\":\"Environment - BME280\",\n\"TaskName\":\"");
+    buffer += String(F("Task")) + task;
+    buffer += F("\",\n\"TaskEnabled\":\"true\",\n\"TaskNumber\":");
+    buffer += task + 1;
+    buffer += F("\n}");
+    if (task < 11) buffer += ',';
+    buffer += '\n';
+  }
+  buffer += F("],\n\"TTL\":60000\n}\n");
+  buffer.endStream();
+}
+
+// Size of the page, as counted by sendContentBlocking().
+unsigned long pageSize() {
+  bench_sink = 0;
+  StreamingBuffer buffer;
+  renderJsonPage(buffer);
+  return bench_sink;
+}
+
+}  // namespace
+
+int main() {
+  const unsigned long size = pageSize();
+  char title[64];
+  snprintf(title, sizeof(title), "/json page of 12 tasks, %lu bytes", size);
+  benchHeader(title);
+  bench("per character String (before)", []() {
+    oldStreamingBuffer buffer;
+    renderJsonPage(buffer);
+  }, size);
+  bench("StreamingBuffer chunk", []() {
+    StreamingBuffer buffer;
+    renderJsonPage(buffer);
+  }, size);
+  return 0;
+}
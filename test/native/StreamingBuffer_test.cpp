@@ -0,0 +1,130 @@
+// StreamingBuffer (src/WebServer.ino), the chunked transfer of the web pages.
+
+#include <vector>
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define LOG_LEVEL_DEBUG 3
+
+// Used by StreamingBuffer, not part of the test.
+std::string sentContent;
+std::vector<unsigned int> sentChunks;
+std::string sentHeader;
+int lowMemoryPages = 0;
+bool clientStopped = false;
+
+void addLog(byte logLevel, const String& line) {}
+void sendContentBlocking(const char* data, unsigned int length) {
+  sentContent.append(data, length);
+  sentChunks.push_back(length);
+}
+void sendHeaderBlocking(const __FlashStringHelper* contentType, bool allowCORS) {
+  sentHeader = reinterpret_cast<const char *>(contentType);
+}
+
+struct {
+  uint32_t freeHeap;
+  uint32_t getFreeHeap() { return freeHeap; }
+} ESP;
+
+class WebServerClient {
+public:
+  void setTimeout(unsigned long timeout) {}
+  void stop() { clientStopped = true; }
+};
+
+struct {
+  WebServerClient client() { return WebServerClient(); }
+  void send(int code, const char *contentType, const char *content) { ++lowMemoryPages; }
+} WebServer;
+
+#include "StreamingBuffer.h"
+
+namespace {
+
+class StreamingBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    sentContent.clear();
+    sentChunks.clear();
+    sentHeader.clear();
+    lowMemoryPages = 0;
+    clientStopped = false;
+    ESP.freeHeap = 20000;
+  }
+};
+
+}  // namespace
+
+TEST_F(StreamingBufferTest, ChunksAreFullAndInOrder) {
+  StreamingBuffer buffer;
+  buffer.startJsonStream();
+  EXPECT_EQ("application/json", sentHeader);
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    const String line = String(F("{\"line\":")) + i + F("},\n");
+    buffer += line;
+    buffer += F("flash ");
+    buffer += 'c';
+    buffer += 12345UL;
+    buffer.addChars("chars", 3);
+    expected += line + "flash c12345cha";
+  }
+  buffer.endStream();
+  EXPECT_EQ(expected, sentContent);
+  ASSERT_GE(sentChunks.size(), 3U);
+  for (size_t i = 0; i + 2 < sentChunks.size(); ++i) {
+    EXPECT_EQ(static_cast<unsigned int>(CHUNKED_BUFFER_SIZE), sentChunks[i]);
+  }
+  // An empty chunk ends the transfer.
+  EXPECT_EQ(0U, sentChunks.back());
+}
+
+TEST_F(StreamingBufferTest, PluginStringIsAddedFirst) {
+  StreamingBuffer buffer;
+  buffer.startStream();
+  EXPECT_EQ("text/html", sentHeader);
+  buffer += F("<a>");
+  buffer.buf += F("plugin");
+  buffer += F("</a>");
+  buffer.buf += F(" end");
+  buffer.endStream();
+  EXPECT_EQ("<a>plugin</a> end", sentContent);
+}
+
+TEST_F(StreamingBufferTest, LongStringsAreSplit) {
+  StreamingBuffer buffer;
+  buffer.startStream();
+  const std::string longText(CHUNKED_BUFFER_SIZE * 3 + 17, 'x');
+  buffer += String(longText);
+  buffer.endStream();
+  EXPECT_EQ(longText, sentContent);
+  EXPECT_EQ(std::vector<unsigned int>({ CHUNKED_BUFFER_SIZE, CHUNKED_BUFFER_SIZE, CHUNKED_BUFFER_SIZE, 17, 0 }), sentChunks);
+}
+
+TEST_F(StreamingBufferTest, LowMemorySkipsThePage) {
+  StreamingBuffer buffer;
+  ESP.freeHeap = 2000;
+  buffer.startStream();
+  EXPECT_TRUE(buffer.isAborted());
+  buffer += F("not sent");
+  buffer.endStream();
+  EXPECT_EQ(1, lowMemoryPages);
+  EXPECT_EQ("", sentContent);
+  EXPECT_TRUE(sentChunks.empty());
+}
+
+TEST_F(StreamingBufferTest, AbortedStreamDiscardsTheRest) {
+  StreamingBuffer buffer;
+  buffer.startStream();
+  buffer += F("sent");
+  buffer.flush();
+  buffer.abortStream();
+  EXPECT_TRUE(clientStopped);
+  EXPECT_TRUE(buffer.isAborted());
+  buffer += F("discarded");
+  buffer.endStream();
+  EXPECT_EQ("sent", sentContent);
+  EXPECT_FALSE(buffer.isAborted());
+}
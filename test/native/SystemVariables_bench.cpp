@@ -0,0 +1,172 @@
+// parseSystemVariables() (src/StringConverter.ino) on typical MQTT topics and messages, compared with
+// the replace pass per variable it replaced.
+
+#include "Arduino.h"
+#include "bench.h"
+
+#define ESPEASY_WIFI_DISCONNECTED 0
+
+// Used by the system variables, not part of the benchmark.
+class IPAddress {
+public:
+  uint8_t operator[](int index) const { return 192 - index; }
+  String toString() const { return F("192.168.1.189"); }
+};
+
+struct {
+  IPAddress localIP() { return IPAddress(); }
+  int RSSI() { return -67; }
+  String SSID() { return F("MyWiFi"); }
+  String BSSIDstr() { return F("01:23:45:67:89:AB"); }
+  int channel() { return 6; }
+  String macAddress() { return F("5C:CF:7F:01:02:03"); }
+} WiFi;
+
+struct {
+  uint32_t getFreeHeap() { return 20000; }
+} ESP;
+
+struct {
+  byte Unit;
+  char Name[26];
+} Settings = { 3, "ESP_Easy" };
+
+byte wifiStatus = 3;
+unsigned long wdcounter = 1234;
+
+String URLEncode(const char* msg) { return msg; }
+float getCPUload() { return 12.5; }
+int year() { return 2018; }
+int month() { return 7; }
+int day() { return 14; }
+int hour() { return 9; }
+int minute() { return 5; }
+int second() { return 42; }
+int weekday() { return 7; }
+String weekday_str() { return F("Sat"); }
+String getTimeString(char delimiter, bool show_seconds = true) { return show_seconds ? F("09:05:42") : F("09:05"); }
+String getTimeString_ampm(char delimiter, bool show_seconds = true) { return show_seconds ? F("9:05:42 AM") : F("9:05 AM"); }
+String getDateTimeString(char dateDelimiter, char timeDelimiter, char dateTimeDelimiter) { return F("2018-07-14 09:05:42"); }
+String getDateTimeString_ampm(char dateDelimiter, char timeDelimiter, char dateTimeDelimiter) { return F("2018-07-14 9:05:42 AM"); }
+unsigned long getUnixTime() { return 1531559142UL; }
+int getSecOffset(const String& format) { return 0; }
+String getSunriseTimeString(char delimiter, int secOffset) { return F("05:42"); }
+String getSunsetTimeString(char delimiter, int secOffset) { return F("21:58"); }
+#define strcmp_P(a, b)      strcmp(a, b)
+#define strncmp_P(a, b, n)  strncmp(a, b, n)
+#define sprintf_P           sprintf
+
+#include "SystemVariables.h"
+
+namespace {
+
+// The parse as it was before the single pass, one indexOf() and replace() per variable.
+#define SMART_REPL(T,S) if (s.indexOf(T) != -1) { repl((T), (S), s, useURLencode);}
+#define SMART_REPL_T(T,S) if (s.indexOf(T) != -1) { (S((T), s, useURLencode));}
+
+String getReplacementString(const String& format, String& s) {
+  int startpos = s.indexOf(format);
+  int endpos = s.indexOf('%', startpos + 1);
+  String R = s.substring(startpos, endpos + 1);
+  return R;
+}
+
+void replSunRiseTimeString(const String& format, String& s, boolean useURLencode) {
+  String R = getReplacementString(format, s);
+  repl(R, getSunriseTimeString(':', getSecOffset(R)), s, useURLencode);
+}
+
+void replSunSetTimeString(const String& format, String& s, boolean useURLencode) {
+  String R = getReplacementString(format, s);
+  repl(R, getSunsetTimeString(':', getSecOffset(R)), s, useURLencode);
+}
+
+void parseSystemVariablesBefore(String& s, boolean useURLencode)
+{
+  parseSpecialCharacters(s, useURLencode);
+  if (s.indexOf('%') == -1)
+    return; // Nothing to replace
+
+  repl(F("%CR%"), F("\r"), s, useURLencode);
+  repl(F("%LF%"), F("\n"), s, useURLencode);
+  repl(F("%SP%"), F(" "), s, useURLencode); //space
+  repl(F("%R%"), F("\\r"), s, useURLencode);
+  repl(F("%N%"), F("\\n"), s, useURLencode);
+  SMART_REPL(F("%ip4%"),WiFi.localIP().toString().substring(WiFi.localIP().toString().lastIndexOf('.')+1)) //4th IP octet
+  SMART_REPL(F("%ip%"),WiFi.localIP().toString())
+  SMART_REPL(F("%rssi%"), String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.RSSI()))
+  SMART_REPL(F("%ssid%"), (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("--") : WiFi.SSID())
+  SMART_REPL(F("%bssid%"), (wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? F("00:00:00:00:00:00") : WiFi.BSSIDstr())
+  SMART_REPL(F("%wi_ch%"), String((wifiStatus == ESPEASY_WIFI_DISCONNECTED) ? 0 : WiFi.channel()))
+  SMART_REPL(F("%unit%"), String(Settings.Unit))
+  SMART_REPL(F("%mac%"), String(WiFi.macAddress()))
+
+  if (s.indexOf(F("%sys")) != -1) {
+    SMART_REPL(F("%sysload%"), String(getCPUload()))
+    SMART_REPL(F("%sysheap%"), String(ESP.getFreeHeap()));
+    SMART_REPL(F("%systm_hm%"), getTimeString(':', false))
+    SMART_REPL(F("%systm_hm_am%"), getTimeString_ampm(':', false))
+    SMART_REPL(F("%systime%"), getTimeString(':'))
+    SMART_REPL(F("%systime_am%"), getTimeString_ampm(':'))
+    repl(F("%sysname%"), Settings.Name, s, useURLencode);
+
+    // valueString is being used by the macro.
+    // Was 5 bytes, too small for %syssec_d%.
+    char valueString[6];
+    #define SMART_REPL_TIME(T,F,V) if (s.indexOf(T) != -1) { sprintf_P(valueString, (F), (V)); repl((T),valueString, s, useURLencode);}
+    SMART_REPL_TIME(F("%sysyear%"), PSTR("%d"), year())
+    SMART_REPL_TIME(F("%sysmonth%"),PSTR("%d"), month())
+    SMART_REPL_TIME(F("%sysday%"), PSTR("%d"), day())
+    SMART_REPL_TIME(F("%syshour%"), PSTR("%d"), hour())
+    SMART_REPL_TIME(F("%sysmin%"), PSTR("%d"), minute())
+    SMART_REPL_TIME(F("%syssec%"),PSTR("%d"), second())
+    SMART_REPL_TIME(F("%syssec_d%"),PSTR("%d"), ((hour()*60) + minute())*60 + second());
+    SMART_REPL(F("%sysweekday%"), String(weekday()))
+    SMART_REPL(F("%sysweekday_s%"), weekday_str())
+
+    // With leading zero
+    SMART_REPL_TIME(F("%sysyears%"),PSTR("%02d"), year()%100)
+    SMART_REPL_TIME(F("%sysyear_0%"), PSTR("%04d"), year())
+    SMART_REPL_TIME(F("%syshour_0%"), PSTR("%02d"), hour())
+    SMART_REPL_TIME(F("%sysday_0%"), PSTR("%02d"), day())
+    SMART_REPL_TIME(F("%sysmin_0%"), PSTR("%02d"), minute())
+    SMART_REPL_TIME(F("%syssec_0%"),PSTR("%02d"), second())
+    SMART_REPL_TIME(F("%sysmonth_0%"),PSTR("%02d"), month())
+
+    #undef SMART_REPL_TIME
+  }
+  SMART_REPL(F("%lcltime%"), getDateTimeString('-',':',' '))
+  SMART_REPL(F("%lcltime_am%"), getDateTimeString_ampm('-',':',' '))
+  SMART_REPL(F("%uptime%"), String(wdcounter / 2))
+  SMART_REPL(F("%unixtime%"), String(getUnixTime()))
+  SMART_REPL_T(F("%sunset"), replSunSetTimeString)
+  SMART_REPL_T(F("%sunrise"), replSunRiseTimeString)
+}
+
+#undef SMART_REPL
+#undef SMART_REPL_T
+
+}  // namespace
+
+int main() {
+  const char *texts[] = {
+    "/%sysname%/Temp/Temperature",
+    "%sysname% up %uptime% min, %sysheap% bytes free at %systime%",
+    "%eventvalue%,%val1%",
+    "No variables at all",
+  };
+  for (const char *text : texts) {
+    benchHeader(text);
+    bench("indexOf() and replace() per variable (before)", [text]() {
+      String s(text);
+      parseSystemVariablesBefore(s, false);
+      benchKeep(s.length());
+    });
+    bench("parseSystemVariables() single pass", [text]() {
+      String s(text);
+      parseSystemVariables(s, false);
+      benchKeep(s.length());
+    });
+  }
+  return 0;
+}
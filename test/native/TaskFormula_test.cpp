@@ -0,0 +1,167 @@
+// Compiled task value formulas, calculateTaskFormula() (src/Misc.ino), against Calculate() on the text
+// with %value% and %pvalue% replaced, as SensorSendTask() used to do it.
+
+#include <random>
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define TASKS_MAX      12
+#define VARS_PER_TASK   4
+
+void checkRAM(const __FlashStringHelper* flashString) {}
+
+#include "Calculate.h"
+#include "TaskFormula.h"
+
+namespace {
+
+struct Outcome {
+  int error;
+  float result;
+};
+
+Outcome calculateText(const char *formula, float value, float pvalue) {
+  String text(formula);
+  text.replace(F("%pvalue%"), String(pvalue));
+  text.replace(F("%value%"), String(value));
+  Outcome outcome = { 0, 0.0 };
+  outcome.error = Calculate(text.c_str(), &outcome.result);
+  return outcome;
+}
+
+Outcome calculateCompiled(const char *formula, float value, float pvalue) {
+  Outcome outcome = { 0, 0.0 };
+  outcome.error = calculateTaskFormula(0, 0, formula, value, pvalue, &outcome.result);
+  return outcome;
+}
+
+// Compare both paths for all values, with the formula compiled once like in SensorSendTask().
+void expectSameOutcome(const char *formula, const std::vector<float>& values) {
+  clearTaskFormulas();
+  for (size_t i = 0; i < values.size(); ++i) {
+    const float value = values[i];
+    const float pvalue = values[(i * 7 + 3) % values.size()];
+    const Outcome expected = calculateText(formula, value, pvalue);
+    const Outcome actual = calculateCompiled(formula, value, pvalue);
+    ASSERT_EQ(expected.error, actual.error) << formula << " value " << value << " pvalue " << pvalue;
+    if (expected.error == CALCULATE_OK) {
+      ASSERT_EQ(0, memcmp(&expected.result, &actual.result, sizeof(float)))
+        << formula << " value " << value << " pvalue " << pvalue
+        << " expected " << expected.result << " actual " << actual.result;
+    }
+  }
+}
+
+const std::vector<float> specialValues = {
+  0.0, -0.0, 1.0, -1.0, 21.5, -21.5, 0.004, -0.004, 0.005, 99.999, -99.999,
+  1234.5678, -40.0, 100000.0, 3.0e9, -3.0e9, NAN, INFINITY, -INFINITY
+};
+
+// Random formulas of terms, operators and parentheses, with spaces here and there.
+class FormulaGenerator {
+public:
+  explicit FormulaGenerator(unsigned int seed) : rng(seed) {}
+
+  std::string formula() {
+    std::string text;
+    do {
+      text = expression(0);
+    } while (text.size() > NAME_FORMULA_LENGTH_MAX);
+    return text;
+  }
+
+  // Break the formula, to compare the error handling.
+  std::string broken(std::string text) {
+    const char inserts[] = { '(', ')', 'a', '%', ',', '!' };
+    const size_t pos = pick(text.size() + 1);
+    text.insert(pos, 1, inserts[pick(sizeof(inserts))]);
+    return text.substr(0, NAME_FORMULA_LENGTH_MAX);
+  }
+
+  float value() {
+    if (pick(4) == 0) return specialValues[pick(specialValues.size())];
+    return std::uniform_real_distribution<float>(-1000.0, 1000.0)(rng);
+  }
+
+private:
+  size_t pick(size_t count) { return std::uniform_int_distribution<size_t>(0, count - 1)(rng); }
+
+  std::string space() { return pick(5) == 0 ? " " : ""; }
+
+  std::string term(int depth) {
+    switch (pick(depth < 3 ? 7 : 6)) {
+      case 0: case 1: return "%value%";
+      case 2:         return "%pvalue%";
+      case 3:         return std::to_string(pick(100));
+      case 4:         return std::to_string(pick(1000)) + "." + std::to_string(pick(100));
+      case 5:         return "-" + std::to_string(pick(10) + 1);
+      default:        return "(" + expression(depth + 1) + ")";
+    }
+  }
+
+  std::string expression(int depth) {
+    const char operators[] = { '+', '-', '*', '/', '^' };
+    std::string text = term(depth);
+    const size_t count = pick(4);
+    for (size_t i = 0; i < count; ++i) {
+      text += space() + operators[pick(sizeof(operators))] + space() + term(depth);
+    }
+    return text;
+  }
+
+  std::mt19937 rng;
+};
+
+}  // namespace
+
+TEST(TaskFormula, FixedFormulas) {
+  const char *formulas[] = {
+    "%value%", "%value%*1.8+32", "(%value%-32)/1.8", "%value%-%pvalue%", "%value%/10",
+    "%value%^2", "2^%value%", "3*-%value%", "-%value%", "10-%value%", "%value%*%value%",
+    "%pvalue%", "1+2*3", "(1+2)*3", "2^3^2", "8/4/2", "%value% + 0.5 * %pvalue%",
+    "1%value%", "%value%0", "%value%.5", " %value% ", "%value%%pvalue%"
+  };
+  for (const char *formula : formulas) {
+    expectSameOutcome(formula, specialValues);
+  }
+}
+
+TEST(TaskFormula, Errors) {
+  const char *formulas[] = {
+    "(%value%", "%value%)", "%value%+a", "%value%%", "%value%,1", "%val%", "%value%+(", "%VALUE%",
+    "1+(2+(3+(4+(5+(6+(7+(8+(9+(10+(11+12",
+    "1+(2+(3+(4+(5+(6+(7+(8+(9+(%value%+1)))",
+    "1+(2+(3+(4+(5+(6+(7+(8+(9+(%value%+1))))))))))"
+  };
+  for (const char *formula : formulas) {
+    expectSameOutcome(formula, specialValues);
+  }
+}
+
+TEST(TaskFormula, RandomFormulas) {
+  FormulaGenerator generator(42);
+  for (int i = 0; i < 2000; ++i) {
+    std::string formula = generator.formula();
+    if (i % 4 == 3) formula = generator.broken(formula);
+    std::vector<float> values;
+    for (int v = 0; v < 16; ++v) values.push_back(generator.value());
+    expectSameOutcome(formula.c_str(), values);
+    if (HasFatalFailure()) return;
+  }
+}
+
+TEST(TaskFormula, CompiledOnce) {
+  clearTaskFormulas();
+  float result = 0;
+  EXPECT_EQ(CALCULATE_OK, calculateTaskFormula(0, 1, "%value%*2", 4.0, 0.0, &result));
+  EXPECT_EQ(8, result);
+  EXPECT_EQ(FORMULA_COMPILED, TaskFormula[0][1].state);
+  // The formula text is only used to compile, until the formulas are cleared.
+  EXPECT_EQ(CALCULATE_OK, calculateTaskFormula(0, 1, "%value%*3", 4.0, 0.0, &result));
+  EXPECT_EQ(8, result);
+  clearTaskFormulas(0);
+  EXPECT_EQ(CALCULATE_OK, calculateTaskFormula(0, 1, "%value%*3", 4.0, 0.0, &result));
+  EXPECT_EQ(12, result);
+  EXPECT_EQ(CALCULATE_ERROR_UNKNOWN_TOKEN, calculateTaskFormula(TASKS_MAX, 0, "1", 0.0, 0.0, &result));
+}
@@ -0,0 +1,117 @@
+// Task value lookup by name, findTaskValueByName() (src/ESPEasyStorage.ino), compared with a scan of all tasks.
+
+#include "Arduino.h"
+#include "bench.h"
+
+#define TASKS_MAX      32  // As on ESP32
+#define VARS_PER_TASK   4
+
+// Used by parseTemplate(), not part of the benchmark.
+struct {
+  byte TaskDeviceNumber[TASKS_MAX];
+  boolean TaskDeviceEnabled[TASKS_MAX];
+} Settings;
+
+struct {
+  byte TaskIndex;
+} ExtraTaskSettings;
+
+float UserVar[VARS_PER_TASK * TASKS_MAX];
+
+void addLog(byte logLevel, const String& line) {}
+bool loglevelActiveFor(byte logLevel) { return false; }
+void checkRAM(const __FlashStringHelper* flashString) {}
+void LoadTaskSettings(byte TaskIndex) { ExtraTaskSettings.TaskIndex = TaskIndex; }
+void invalidateMQTTTopicCache() {}
+void parseSystemVariables(String& s, boolean useURLencode) {}
+void parseStandardConversions(String& s, boolean useURLencode) {}
+String toString(float value, byte decimals) {
+  String sValue = String(value, decimals);
+  sValue.trim();
+  return sValue;
+}
+struct EventStruct;
+boolean PluginCall(byte Function, struct EventStruct *event, String& str) { return false; }
+struct TaskSettingsCacheStruct;
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex);
+String formatUserVar(byte TaskIndex, byte rel_index, bool& isvalid);
+
+#include "ParseTemplate.h"
+
+const TaskSettingsCacheStruct& getTaskSettingsCache(byte TaskIndex) { return TaskSettingsCache[TaskIndex]; }
+
+String formatUserVar(byte TaskIndex, byte rel_index, bool& isvalid) {
+  isvalid = true;
+  return toString(UserVar[TaskIndex * VARS_PER_TASK + rel_index], TaskSettingsCache[TaskIndex].TaskDeviceValueDecimals[rel_index]);
+}
+
+namespace {
+
+const char *valueNames[] = { "Temperature", "Humidity", "Pressure", "Dewpoint" };
+
+void setupTasks() {
+  for (byte x = 0; x < TASKS_MAX; ++x) {
+    Settings.TaskDeviceNumber[x] = 1;
+    Settings.TaskDeviceEnabled[x] = true;
+    TaskSettingsCacheStruct& cache = TaskSettingsCache[x];
+    cache.loaded = true;
+    cache.TaskDeviceName = String(F("Task")) + x;
+    for (byte z = 0; z < VARS_PER_TASK; ++z) {
+      cache.TaskDeviceValueNames[z] = valueNames[z];
+      cache.TaskDeviceValueDecimals[z] = 2;
+      UserVar[x * VARS_PER_TASK + z] = 20.0 + x + z;
+    }
+  }
+  invalidateTaskValueIndex();
+}
+
+// The lookup as parseTemplate() did it before the index, on the cached settings.
+// The firmware also did a LoadTaskSettings() of every task on the way, which is not measured here.
+bool findTaskValueByScan(const String& taskName, const String& valueName, byte& TaskIndex, byte& varNr) {
+  for (byte y = 0; y < TASKS_MAX; y++) {
+    if (!Settings.TaskDeviceEnabled[y]) continue;
+    const TaskSettingsCacheStruct& cache = getTaskSettingsCache(y);
+    if (cache.TaskDeviceName.length() == 0 || !taskName.equalsIgnoreCase(cache.TaskDeviceName)) continue;
+    for (byte z = 0; z < VARS_PER_TASK; z++) {
+      if (valueName.equalsIgnoreCase(cache.TaskDeviceValueNames[z])) {
+        TaskIndex = y;
+        varNr = z;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+int main() {
+  setupTasks();
+  const char *lookups[][2] = {
+    { "Task0", "Temperature" },
+    { "Task31", "Dewpoint" },
+    { "task31", "nope" },
+  };
+  for (const auto& lookup : lookups) {
+    const String taskName(lookup[0]);
+    const String valueName(lookup[1]);
+    char title[64];
+    snprintf(title, sizeof(title), "[%s#%s] of %d tasks", lookup[0], lookup[1], TASKS_MAX);
+    benchHeader(title);
+    bench("scan of all tasks (before)", [&]() {
+      byte TaskIndex = 0, varNr = 0;
+      benchKeep(findTaskValueByScan(taskName, valueName, TaskIndex, varNr) + TaskIndex + varNr);
+    });
+    bench("findTaskValueByName() index", [&]() {
+      byte TaskIndex = 0, varNr = 0;
+      benchKeep(findTaskValueByName(taskName, valueName, TaskIndex, varNr) + TaskIndex + varNr);
+    });
+  }
+
+  benchHeader("parseTemplate() of a display line with 3 task values");
+  bench("parseTemplate()", []() {
+    String line(F("[Task3#Temperature]C [Task7#Humidity#D2.0]% [Task11#Pressure#V#R6]"));
+    benchKeep(parseTemplate(line, 0).length());
+  });
+  return 0;
+}
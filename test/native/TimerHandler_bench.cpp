@@ -0,0 +1,100 @@
+// The scheduler timer heap of src/ESPEasyTimeTypes.h, compared with the sorted std::list it replaced.
+
+#include <list>
+#include <vector>
+
+#include "Arduino.h"
+#include "bench.h"
+
+#define TASKS_MAX 12
+
+long timeDiff(unsigned long prev, unsigned long next) {
+  return static_cast<long>(static_cast<int32_t>(next - prev));
+}
+long timePassedSince(unsigned long timestamp) { return timeDiff(timestamp, millis()); }
+boolean timeOutReached(unsigned long timer) { return timePassedSince(timer) >= 0; }
+long usecPassedSince(unsigned long timestamp) { return timeDiff(timestamp, micros()); }
+
+#include "ESPEasyTimeTypes.h"
+
+namespace {
+
+// The timer list as it was before the heap, without the statistics.
+class listTimerHandler {
+public:
+  void registerAt(unsigned long id, unsigned long timer) {
+    if (id == 0) return;
+    _timer_ids.remove_if([id](const couple& item) { return item._id == id; });
+    const bool mustSort = !_timer_ids.empty();
+    _timer_ids.push_front(couple(id, timer));
+    if (mustSort)
+      _timer_ids.sort();
+  }
+
+  unsigned long getNextId(unsigned long& timer) {
+    if (_timer_ids.empty()) return 0;
+    const couple item = _timer_ids.front();
+    if (!timeOutReached(item._timer)) return 0;
+    _timer_ids.pop_front();
+    timer = item._timer;
+    return item._id;
+  }
+
+private:
+  struct couple {
+    couple(unsigned long id, unsigned long newtimer) : _id(id), _timer(newtimer) {}
+
+    bool operator<(const couple& other) const {
+      const unsigned long now(millis());
+      return timeDiff(_timer, now) > timeDiff(other._timer, now);
+    }
+
+    unsigned long _id;
+    unsigned long _timer;
+  };
+
+  std::list<couple> _timer_ids;
+};
+
+// Like the scheduler loop: every due timer is handled and set again,
+// with intervals of tasks, plugin timers and system timers mixed.
+template <typename Handler>
+void runScheduler(Handler& handler, const std::vector<unsigned long>& intervals, unsigned long loops) {
+  for (unsigned long i = 0; i < loops; ++i) {
+    ++shim_millis;
+    unsigned long timer = 0;
+    unsigned long id;
+    while ((id = handler.getNextId(timer)) != 0) {
+      handler.registerAt(id, timer + intervals[id - 1]);
+      benchKeep(id);
+    }
+  }
+}
+
+template <typename Handler>
+void benchHandler(const char *name, int timerCount) {
+  std::vector<unsigned long> intervals;
+  for (int i = 0; i < timerCount; ++i) {
+    intervals.push_back(10 + (i * 37) % 990);
+  }
+  shim_millis = 0;
+  Handler handler;
+  for (int i = 0; i < timerCount; ++i) {
+    handler.registerAt(i + 1, intervals[i]);
+  }
+  // 1000 msec of scheduler loops per call.
+  bench(name, [&]() { runScheduler(handler, intervals, 1000); });
+}
+
+}  // namespace
+
+int main() {
+  char name[64];
+  for (int timerCount : { 8, 24, MSEC_TIMER_HANDLER_MAX }) {
+    snprintf(name, sizeof(name), "%d timers, 1 sec of scheduling", timerCount);
+    benchHeader(name);
+    benchHandler<listTimerHandler>("sorted std::list (before)", timerCount);
+    benchHandler<msecTimerHandlerStruct>("msecTimerHandlerStruct heap", timerCount);
+  }
+  return 0;
+}
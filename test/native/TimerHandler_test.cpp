@@ -0,0 +1,99 @@
+// The scheduler timer heap of src/ESPEasyTimeTypes.h, compared with a std::map.
+
+#include <map>
+
+#include "Arduino.h"
+#include "gtest/gtest.h"
+
+#define TASKS_MAX 12
+
+long timeDiff(unsigned long prev, unsigned long next) {
+  return static_cast<long>(static_cast<int32_t>(next - prev));
+}
+long timePassedSince(unsigned long timestamp) { return timeDiff(timestamp, millis()); }
+boolean timeOutReached(unsigned long timer) { return timePassedSince(timer) >= 0; }
+long usecPassedSince(unsigned long timestamp) { return timeDiff(timestamp, micros()); }
+
+#include "ESPEasyTimeTypes.h"
+
+TEST(TimerHandler, RunsTimersInOrder) {
+  shim_millis = 1000;
+  msecTimerHandlerStruct timers;
+  timers.registerAt(1, 1300);
+  timers.registerAt(2, 1100);
+  timers.registerAt(3, 1200);
+  unsigned long timer = 0;
+  EXPECT_EQ(0UL, timers.getNextId(timer));
+  EXPECT_EQ(100, timers.msecUntilNextTimer());
+  shim_millis = 1300;
+  EXPECT_EQ(2UL, timers.getNextId(timer));
+  EXPECT_EQ(1100UL, timer);
+  EXPECT_EQ(3UL, timers.getNextId(timer));
+  EXPECT_EQ(1UL, timers.getNextId(timer));
+  EXPECT_EQ(0UL, timers.getNextId(timer));
+  EXPECT_EQ(-1, timers.msecUntilNextTimer());
+}
+
+TEST(TimerHandler, RescheduleAndRemove) {
+  shim_millis = 0;
+  msecTimerHandlerStruct timers;
+  timers.registerAt(1, 100);
+  timers.registerAt(2, 200);
+  timers.registerAt(1, 300);  // Same id is moved, not added
+  EXPECT_TRUE(timers.remove(2));
+  EXPECT_FALSE(timers.remove(2));
+  shim_millis = 300;
+  unsigned long timer = 0;
+  EXPECT_EQ(1UL, timers.getNextId(timer));
+  EXPECT_EQ(300UL, timer);
+  EXPECT_EQ(0UL, timers.getNextId(timer));
+}
+
+TEST(TimerHandler, FullHeapDropsNewTimers) {
+  shim_millis = 0;
+  msecTimerHandlerStruct timers;
+  for (unsigned long id = 1; id <= MSEC_TIMER_HANDLER_MAX; ++id)
+    EXPECT_TRUE(timers.registerAt(id, 100 + id));
+  EXPECT_FALSE(timers.registerAt(MSEC_TIMER_HANDLER_MAX + 1, 50));
+  // Rescheduling a timer already set still works.
+  EXPECT_TRUE(timers.registerAt(1, 50));
+  EXPECT_FALSE(timers.registerAt(0, 50));
+  shim_millis = 50;
+  unsigned long timer = 0;
+  EXPECT_EQ(1UL, timers.getNextId(timer));
+  EXPECT_EQ(0UL, timers.getNextId(timer));
+}
+
+TEST(TimerHandler, RandomOperationsAcrossMillisWrap) {
+  shim_millis = 0xFFFFF000UL;
+  msecTimerHandlerStruct timers;
+  std::map<unsigned long, unsigned long> expected;
+  srand(1);
+  for (int i = 0; i < 200000; ++i) {
+    const int operation = rand() % 4;
+    const unsigned long id = 1 + rand() % 11 + (static_cast<unsigned long>(rand() % 4) << 28);
+    if (operation < 2) {
+      const unsigned long at = shim_millis + rand() % 5000;
+      timers.registerAt(id, at);
+      expected[id] = at;
+    } else if (operation == 2) {
+      shim_millis += rand() % 50;
+      unsigned long timer = 0;
+      unsigned long next;
+      while ((next = timers.getNextId(timer)) != 0) {
+        ASSERT_EQ(1U, expected.count(next));
+        ASSERT_EQ(expected[next], timer);
+        // No timer left which should have run before it.
+        for (const auto& other : expected)
+          ASSERT_LE(timeDiff(other.second, timer), 0);
+        expected.erase(next);
+      }
+      // All due timers were returned.
+      for (const auto& other : expected)
+        ASSERT_LT(timeDiff(other.second, shim_millis), 0);
+    } else {
+      ASSERT_EQ(expected.count(id) != 0, timers.remove(id));
+      expected.erase(id);
+    }
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef NATIVE_BENCH_H_
+#define NATIVE_BENCH_H_
+
+// Timing of the host benchmarks, run them with 'make bench'.
+// A benchmark repeats its body until BENCH_MIN_TIME_SEC has passed and prints the time per call.
+// The numbers are only meant to compare implementations on the same PC, not to predict the ESP.
+
+#include <chrono>
+#include <cstdio>
+
+#define BENCH_MIN_TIME_SEC 0.3
+
+// Results passed here are not optimized away.
+inline volatile unsigned long bench_sink = 0;
+inline void benchKeep(unsigned long value) { bench_sink += value; }
+
+inline void benchHeader(const char *title) {
+  printf("\n%s\n", title);
+}
+
+// bytesPerCall adds a throughput column.
+template <typename F>
+double bench(const char *name, F body, double bytesPerCall = 0) {
+  typedef std::chrono::steady_clock clock;
+  unsigned long calls = 1;
+  double elapsed = 0;
+  while (true) {
+    const clock::time_point start = clock::now();
+    for (unsigned long i = 0; i < calls; ++i) body();
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    if (elapsed >= BENCH_MIN_TIME_SEC) break;
+    calls *= (elapsed < BENCH_MIN_TIME_SEC / 10) ? 10 : 2;
+  }
+  const double nsPerCall = elapsed * 1e9 / calls;
+  printf("  %-52s %12.1f ns/call", name, nsPerCall);
+  if (bytesPerCall > 0) printf(" %10.1f MB/s", bytesPerCall * calls / elapsed / 1e6);
+  printf("\n");
+  return nsPerCall;
+}
+
+#endif // NATIVE_BENCH_H_
@@ -0,0 +1,154 @@
+#!/usr/bin/env python
+"""Copy definitions from the firmware sources into a header for the host tests.
+
+The .ino files cannot be compiled on the host as a whole, so a test only takes
+the definitions it needs. They are copied, not rewritten, so the tests run the
+code as it is in src/.
+
+usage: extract_ino.py OUTPUT FILE:NAME[,NAME...] [FILE:NAME[,NAME...] ...]
+
+  NAME   all top level functions, structs, classes, enums or variables with that name
+  #NAME  the first '#define NAME' in the file
+
+The header holds the defines, the structs, classes and variables, prototypes
+of the functions and then the functions, each group in the order of the
+arguments.
+"""
+
+import re
+import sys
+
+
+def mask_code(text):
+    """Replace comments and the contents of string and char literals by spaces."""
+    out = list(text)
+    i = 0
+    length = len(text)
+    while i < length:
+        c = text[i]
+        if text.startswith('//', i):
+            end = text.find('\n', i)
+            end = length if end < 0 else end
+            for j in range(i, end):
+                out[j] = ' '
+            i = end
+        elif text.startswith('/*', i):
+            end = text.find('*/', i + 2)
+            end = length if end < 0 else end + 2
+            for j in range(i, end):
+                if text[j] != '\n':
+                    out[j] = ' '
+            i = end
+        elif c == '"' or c == "'":
+            j = i + 1
+            while j < length and text[j] != c:
+                if text[j] == '\\':
+                    out[j] = ' '
+                    j += 1
+                out[j] = ' '
+                j += 1
+            i = j + 1
+        else:
+            i += 1
+    return ''.join(out)
+
+
+def brace_depths(masked):
+    depths = []
+    depth = 0
+    for c in masked:
+        depths.append(depth)
+        if c == '{':
+            depth += 1
+        elif c == '}':
+            depth -= 1
+    return depths
+
+
+def find_define(text, name):
+    match = re.search(r'^[ \t]*#define[ \t]+' + re.escape(name) + r'\b.*?(?<!\\)$',
+                      text, re.M | re.S)
+    if not match:
+        raise ValueError('#define %s not found' % name)
+    return match.group(0).strip() + '\n'
+
+
+def find_definitions(text, masked, depths, name):
+    """Returns (kind, source, prototype) of each top level definition of name."""
+    found = []
+    variable = re.compile(r'^[A-Za-z_][^\n#;{}()=]*?[\s\*&]' + re.escape(name) +
+                          r'[ \t]*(?:\[[^\]\n]*\][ \t]*)*(?:=[^;{}\n]*)?;', re.M)
+    for match in variable.finditer(masked):
+        if depths[match.start()] == 0:
+            found.append(('type', text[match.start():match.end()] + '\n', None))
+    pattern = re.compile(r'^(?:(struct|class|enum)[ \t]+' + re.escape(name) + r'\b'
+                         r'|(?P<table>[A-Za-z_][^\n#;{}()=]*?[\s\*&]' + re.escape(name) +
+                         r'[ \t]*(?:\[[^\]\n]*\][ \t]*)*(?:[A-Z_]+[ \t]*)*=[ \t]*\{)'
+                         r'|[A-Za-z_][^\n#;{}]*?[\s\*&]' + re.escape(name) + r'[ \t]*\()',
+                         re.M)
+    for match in pattern.finditer(masked):
+        start = match.start()
+        if depths[start] != 0:
+            continue
+        pos = start
+        while pos < len(masked) and masked[pos] not in '{;':
+            pos += 1
+        if pos >= len(masked) or masked[pos] == ';':
+            continue  # Declaration only
+        body = pos
+        depth = 0
+        while True:
+            if masked[pos] == '{':
+                depth += 1
+            elif masked[pos] == '}':
+                depth -= 1
+                if depth == 0:
+                    break
+            pos += 1
+        kind = 'type' if match.group(1) or match.group('table') else 'function'
+        if kind == 'type':
+            pos = masked.index(';', pos)
+        source = text[start:pos + 1] + '\n'
+        prototype = text[start:body].rstrip() + ';\n'
+        found.append((kind, source, prototype))
+    if not found:
+        raise ValueError('%s not found' % name)
+    return found
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 2
+    defines = []
+    types = []
+    prototypes = []
+    functions = []
+    for arg in argv[2:]:
+        fname, names = arg.rsplit(':', 1)
+        with open(fname) as f:
+            text = f.read()
+        masked = mask_code(text)
+        depths = brace_depths(masked)
+        for name in names.split(','):
+            if name.startswith('#'):
+                defines.append(find_define(text, name[1:]))
+                continue
+            for kind, source, prototype in find_definitions(text, masked, depths, name):
+                if kind == 'type':
+                    types.append(source)
+                else:
+                    prototypes.append(prototype)
+                    functions.append(source)
+    with open(argv[1], 'w') as out:
+        out.write('// Generated by extract_ino.py from: %s\n' % ' '.join(argv[2:]))
+        out.write('// Do not edit, changes are overwritten by the next build.\n\n')
+        out.write(''.join(defines) + '\n')
+        out.write('\n'.join(types) + '\n')
+        out.write(''.join(prototypes) + '\n')
+        out.write('\n'.join(functions))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
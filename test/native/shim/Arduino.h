@@ -0,0 +1,167 @@
+#ifndef NATIVE_SHIM_ARDUINO_H_
+#define NATIVE_SHIM_ARDUINO_H_
+
+// The part of the Arduino core used by the code under test, on top of the C++ library.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <utility>
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// Flash strings are plain strings on the host.
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define PSTR(s)           (s)
+#define PROGMEM
+typedef const char *PGM_P;
+#define strlen_P(s)             strlen(s)
+#define strcpy_P(d, s)          strcpy(d, s)
+#define memcpy_P(d, s, n)       memcpy(d, s, n)
+#define pgm_read_byte(addr)     (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+
+using std::isinf;
+using std::isnan;
+
+#define _min(a, b) ((a) < (b) ? (a) : (b))
+#define _max(a, b) ((a) > (b) ? (a) : (b))
+
+// Time only moves when a test changes shim_millis.
+inline unsigned long shim_millis = 0;
+inline unsigned long millis() { return shim_millis; }
+inline unsigned long micros() { return shim_millis * 1000; }
+inline void delay(unsigned long ms) { shim_millis += ms; }
+inline void yield() {}
+
+inline char *ultoa(unsigned long value, char *s, int radix) {
+  char digits[33];
+  int n = 0;
+  do {
+    const int digit = value % radix;
+    digits[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= radix;
+  } while (value != 0);
+  for (int i = 0; i < n; ++i) s[i] = digits[n - 1 - i];
+  s[n] = 0;
+  return s;
+}
+
+inline char *dtostrf(double number, signed char width, unsigned char prec, char *s) {
+  sprintf(s, "%*.*f", width, prec, number);
+  return s;
+}
+
+class String : public std::string {
+public:
+  String() {}
+  String(const char *s) : std::string(s == NULL ? "" : s) {}
+  String(const std::string& s) : std::string(s) {}
+  String(const __FlashStringHelper *s) : std::string(reinterpret_cast<const char *>(s)) {}
+  explicit String(char c) : std::string(1, c) {}
+  explicit String(int value) : std::string(std::to_string(value)) {}
+  explicit String(unsigned int value) : std::string(std::to_string(value)) {}
+  explicit String(long value) : std::string(std::to_string(value)) {}
+  explicit String(unsigned long value) : std::string(std::to_string(value)) {}
+  // Same conversion as the Arduino String.
+  explicit String(float value, unsigned char decimals = 2) {
+    char buf[33];
+    assign(dtostrf(value, decimals + 2, decimals, buf));
+  }
+
+  using std::string::operator=;
+  String& operator=(int value) { assign(std::to_string(value)); return *this; }
+
+  using std::string::operator+=;
+  String& operator+=(const __FlashStringHelper *s) { append(reinterpret_cast<const char *>(s)); return *this; }
+  String& operator+=(int value)           { append(std::to_string(value)); return *this; }
+  String& operator+=(unsigned int value)  { append(std::to_string(value)); return *this; }
+  String& operator+=(long value)          { append(std::to_string(value)); return *this; }
+  String& operator+=(unsigned long value) { append(std::to_string(value)); return *this; }
+  String& operator+=(float value)         { *this += String(value); return *this; }
+
+  unsigned int length() const { return size(); }
+  char charAt(unsigned int index) const { return index < size() ? (*this)[index] : 0; }
+  void setCharAt(unsigned int index, char c) { if (index < size()) (*this)[index] = c; }
+  bool equals(const String& other) const { return compare(other) == 0; }
+  bool startsWith(const String& prefix) const { return compare(0, prefix.size(), prefix) == 0; }
+  bool endsWith(const String& suffix) const {
+    return size() >= suffix.size() && compare(size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+  bool equalsIgnoreCase(const String& other) const {
+    return size() == other.size() && strcasecmp(c_str(), other.c_str()) == 0;
+  }
+  bool concat(const String& str) { append(str); return true; }
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return atof(c_str()); }
+
+  int indexOf(char c, unsigned int from = 0) const { return toIndex(find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return toIndex(find(str, from)); }
+  int lastIndexOf(char c) const { return toIndex(rfind(c)); }
+  int lastIndexOf(const String& str) const { return toIndex(rfind(str)); }
+  // Same bounds handling as the Arduino String.
+  String substring(unsigned int left, unsigned int right) const {
+    if (left > right) std::swap(left, right);
+    if (left >= size()) return String();
+    if (right > size()) right = size();
+    return String(substr(left, right - left));
+  }
+  String substring(unsigned int left) const { return substring(left, size()); }
+
+  void replace(char find, char replace) {
+    for (char& c : *this) if (c == find) c = replace;
+  }
+  void replace(const String& find, const String& replace) {
+    if (find.empty()) return;
+    for (size_t pos = std::string::find(find); pos != npos; pos = std::string::find(find, pos + replace.size()))
+      std::string::replace(pos, find.size(), replace);
+  }
+  void remove(unsigned int index) { if (index < size()) erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < size()) erase(index, count); }
+  void trim() {
+    const size_t first = find_first_not_of(" \t\r\n\f\v");
+    if (first == npos) { clear(); return; }
+    erase(find_last_not_of(" \t\r\n\f\v") + 1);
+    erase(0, first);
+  }
+  void toLowerCase() { for (char& c : *this) c = tolower(c); }
+  void toUpperCase() { for (char& c : *this) c = toupper(c); }
+
+private:
+  static int toIndex(size_t pos) { return pos == npos ? -1 : static_cast<int>(pos); }
+};
+
+inline String operator+(const String& lhs, const __FlashStringHelper *rhs) { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, int rhs)           { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, unsigned int rhs)  { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, long rhs)          { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, unsigned long rhs) { String result(lhs); result += rhs; return result; }
+
+inline bool operator==(const String& lhs, const __FlashStringHelper *rhs) { return lhs.compare(reinterpret_cast<const char *>(rhs)) == 0; }
+inline bool operator!=(const String& lhs, const __FlashStringHelper *rhs) { return !(lhs == rhs); }
+
+inline bool isDigit(int c) { return isdigit(c); }
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char *str) { return str == NULL ? 0 : write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+  size_t write(const char *buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+  size_t print(const char *str) { return write(str); }
+  size_t print(const String& str) { return write(str.c_str(), str.length()); }
+};
+
+#endif // NATIVE_SHIM_ARDUINO_H_
@@ -0,0 +1,17 @@
+#ifndef NATIVE_SHIM_CLIENT_H_
+#define NATIVE_SHIM_CLIENT_H_
+
+#include "IPAddress.h"
+#include "Stream.h"
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char *host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+  virtual void flush() {}
+  using Print::write;
+};
+
+#endif // NATIVE_SHIM_CLIENT_H_
@@ -0,0 +1,94 @@
+#ifndef NATIVE_SHIM_FS_H_
+#define NATIVE_SHIM_FS_H_
+
+// SPIFFS kept in memory. A power loss can be simulated after a number of written bytes.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+struct ShimPowerLoss {};
+
+// Bytes that can still be written before ShimPowerLoss is thrown, -1 for no limit.
+inline long shim_fs_write_limit = -1;
+
+namespace fs {
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+typedef std::map<std::string, std::vector<uint8_t> > FileMap;
+
+class File {
+public:
+  File() : _files(NULL), _pos(0) {}
+  File(FileMap *files, const std::string& name, size_t pos) : _files(files), _name(name), _pos(pos) {}
+
+  explicit operator bool() const { return _files != NULL; }
+
+  size_t size() const { return data().size(); }
+  size_t position() const { return _pos; }
+  int available() const { return size() - _pos; }
+
+  bool seek(size_t pos, SeekMode mode = SeekSet) {
+    if (mode == SeekCur) pos += _pos;
+    if (mode == SeekEnd) pos += size();
+    if (pos > size()) return false;
+    _pos = pos;
+    return true;
+  }
+
+  size_t read(uint8_t *buf, size_t size) {
+    const std::vector<uint8_t>& content = data();
+    const size_t length = std::min(size, content.size() - _pos);
+    memcpy(buf, content.data() + _pos, length);
+    _pos += length;
+    return length;
+  }
+
+  size_t write(const uint8_t *buf, size_t size) {
+    std::vector<uint8_t>& content = (*_files)[_name];
+    for (size_t i = 0; i < size; ++i) {
+      if (shim_fs_write_limit == 0) throw ShimPowerLoss();
+      if (shim_fs_write_limit > 0) --shim_fs_write_limit;
+      if (_pos >= content.size()) content.push_back(buf[i]);
+      else content[_pos] = buf[i];
+      ++_pos;
+    }
+    return size;
+  }
+
+  void flush() {}
+  void close() { _files = NULL; }
+
+private:
+  const std::vector<uint8_t>& data() const { return _files->at(_name); }
+
+  FileMap    *_files;
+  std::string _name;
+  size_t      _pos;
+};
+
+class FS {
+public:
+  File open(const char *path, const char *mode) {
+    const bool exists = files.count(path) != 0;
+    if (mode[0] == 'r' && !exists) return File();
+    if (mode[0] == 'w') files[path].clear();
+    std::vector<uint8_t>& content = files[path];
+    return File(&files, path, (mode[0] == 'a') ? content.size() : 0);
+  }
+
+  File open(const String& path, const char *mode) { return open(path.c_str(), mode); }
+
+  bool exists(const char *path) const { return files.count(path) != 0; }
+  bool exists(const String& path) const { return exists(path.c_str()); }
+  bool remove(const char *path) { return files.erase(path) != 0; }
+
+  FileMap files;
+};
+} // namespace fs
+
+inline fs::FS SPIFFS;
+
+#endif // NATIVE_SHIM_FS_H_
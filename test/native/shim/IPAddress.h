@@ -0,0 +1,18 @@
+#ifndef NATIVE_SHIM_IPADDRESS_H_
+#define NATIVE_SHIM_IPADDRESS_H_
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress() { memset(_address, 0, sizeof(_address)); }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    _address[0] = a; _address[1] = b; _address[2] = c; _address[3] = d;
+  }
+  uint8_t operator[](int index) const { return _address[index]; }
+
+private:
+  uint8_t _address[4];
+};
+
+#endif // NATIVE_SHIM_IPADDRESS_H_
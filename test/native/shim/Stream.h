@@ -0,0 +1,12 @@
+#ifndef NATIVE_SHIM_STREAM_H_
+#define NATIVE_SHIM_STREAM_H_
+
+#include "Arduino.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+#endif // NATIVE_SHIM_STREAM_H_
@@ -0,0 +1,76 @@
+#ifndef NATIVE_SHIM_ESP_PARTITION_H_
+#define NATIVE_SHIM_ESP_PARTITION_H_
+
+// One ESP32 data partition kept in memory, mapped reads see the flash content directly.
+// Erase sets a range to 0xFF, write can only clear bits, as on NOR flash.
+// Erased sectors and written bytes count for the power loss of FS.h.
+
+#include <vector>
+
+#include "FS.h"
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0x00, ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+typedef enum { SPI_FLASH_MMAP_DATA, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+
+struct esp_partition_t {
+  esp_partition_type_t type;
+  uint32_t address;
+  uint32_t size;
+  const char *label;
+};
+
+inline std::vector<uint8_t> shim_partition_flash;
+inline esp_partition_t      shim_partition = { ESP_PARTITION_TYPE_DATA, 0x310000, 0, "espeasy_cfg" };
+inline unsigned long        shim_partition_erases = 0;
+
+// Create the partition, erased.
+inline void shim_partition_create(uint32_t size) {
+  shim_partition_flash.assign(size, 0xFF);
+  shim_partition.size = size;
+  shim_partition_erases = 0;
+}
+
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label) {
+  if (shim_partition_flash.empty() || type != shim_partition.type || strcmp(label, shim_partition.label) != 0) return NULL;
+  return &shim_partition;
+}
+
+inline esp_err_t esp_partition_mmap(const esp_partition_t *partition, uint32_t offset, uint32_t size,
+                                    spi_flash_mmap_memory_t memory, const void **out_ptr, spi_flash_mmap_handle_t *out_handle) {
+  if (offset + size > partition->size) return ESP_FAIL;
+  *out_ptr = shim_partition_flash.data() + offset;
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_partition_erase_range(const esp_partition_t *partition, uint32_t start, uint32_t size) {
+  if (start % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0 || start + size > partition->size) return ESP_FAIL;
+  for (uint32_t sector = start; sector < start + size; sector += SPI_FLASH_SEC_SIZE) {
+    if (shim_fs_write_limit == 0) throw ShimPowerLoss();
+    if (shim_fs_write_limit > 0) --shim_fs_write_limit;
+    memset(shim_partition_flash.data() + sector, 0xFF, SPI_FLASH_SEC_SIZE);
+    ++shim_partition_erases;
+  }
+  return ESP_OK;
+}
+
+inline esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size) {
+  if (offset + size > partition->size) return ESP_FAIL;
+  const uint8_t *data = static_cast<const uint8_t *>(src);
+  for (size_t i = 0; i < size; ++i) {
+    if (shim_fs_write_limit == 0) throw ShimPowerLoss();
+    if (shim_fs_write_limit > 0) --shim_fs_write_limit;
+    shim_partition_flash[offset + i] &= data[i];
+  }
+  return ESP_OK;
+}
+
+#endif // NATIVE_SHIM_ESP_PARTITION_H_